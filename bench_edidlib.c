@@ -0,0 +1,421 @@
+/*
+ * Copyright (c) 2022 Shashank Sharma (contactshashanksharma@gmail.com)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sub license,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the
+ * next paragraph) shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Parser benchmarks. Every EDID file found in the corpus directories is
+ * measured, and each result is printed as one JSON object per line:
+ *
+ * {"bench":"parse","edid":"lg-hdr-4k.bin","mode":"copy","ns_per_op":812.4,"allocs_per_op":3.00}
+ *
+ * Usage: bench_edidlib [-i iterations] [-t max_threads] corpus_dir...
+ */
+
+#include <sys/types.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <limits.h>
+#include <dirent.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "libedid.h"
+#include "libedid-api.h"
+
+#define BENCH_MAX_EDIDS 4096
+#define BENCH_MAX_EDID_SIZE (256 * 128)
+
+struct bench_edid {
+        /* d_name, which is up to NAME_MAX long */
+        char name[NAME_MAX + 1];
+        u_int8_t *raw;
+        size_t len;
+};
+
+static struct bench_edid corpus[BENCH_MAX_EDIDS];
+static int n_corpus;
+static long iterations = 20000;
+
+/*
+ * Count the allocations done by the library, by wrapping the glibc
+ * allocator entry points. The library resolves malloc() & co to these.
+ * The count is per thread, so that the batch workers don't contend on it;
+ * only the single threaded benchmarks read it.
+ */
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t n, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void *__libc_memalign(size_t align, size_t size);
+
+static __thread unsigned long n_allocs;
+
+void *malloc(size_t size)
+{
+        n_allocs++;
+        return __libc_malloc(size);
+}
+
+void *calloc(size_t n, size_t size)
+{
+        n_allocs++;
+        return __libc_calloc(n, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+        n_allocs++;
+        return __libc_realloc(ptr, size);
+}
+
+void *aligned_alloc(size_t align, size_t size)
+{
+        n_allocs++;
+        return __libc_memalign(align, size);
+}
+
+static double now_ns(void)
+{
+        struct timespec ts;
+
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static int load_corpus_dir(const char *dir)
+{
+        struct dirent *de;
+        DIR *d = opendir(dir);
+
+        if (!d) {
+                printf("Error: Could not open corpus dir %s\n", dir);
+                return -1;
+        }
+
+        while ((de = readdir(d)) && n_corpus < BENCH_MAX_EDIDS) {
+                struct bench_edid *e = &corpus[n_corpus];
+                char path[512];
+                FILE *f;
+
+                if (de->d_name[0] == '.')
+                        continue;
+
+                snprintf(path, sizeof(path), "%s/%s", dir, de->d_name);
+                f = fopen(path, "rb");
+                if (!f)
+                        continue;
+
+                e->raw = __libc_malloc(BENCH_MAX_EDID_SIZE);
+                e->len = fread(e->raw, 1, BENCH_MAX_EDID_SIZE, f);
+                fclose(f);
+
+                /* Only benchmark EDIDs which the parser accepts */
+                if (libedid_validate_edid(e->raw, e->len)) {
+                        free(e->raw);
+                        continue;
+                }
+
+                snprintf(e->name, sizeof(e->name), "%s", de->d_name);
+                n_corpus++;
+        }
+
+        closedir(d);
+        return 0;
+}
+
+static void print_result(const char *bench, const char *edid, const char *what,
+                double ns, double allocs)
+{
+        printf("{\"bench\":\"%s\",\"edid\":\"%s\",\"mode\":\"%s\",\"ns_per_op\":%.1f",
+                bench, edid, what, ns);
+        if (allocs >= 0)
+                printf(",\"allocs_per_op\":%.2f", allocs);
+        printf("}\n");
+}
+
+static void bench_parse(struct bench_edid *e)
+{
+        static const struct {
+                const char *name;
+                u_int32_t flags;
+        } modes[] = {
+                { "copy", 0 },
+                { "arena", EDID_PARSE_ARENA },
+                { "borrow", EDID_PARSE_BORROW_RAW },
+                { "lazy", EDID_PARSE_LAZY | EDID_PARSE_BORROW_RAW },
+        };
+        unsigned int m;
+        long i;
+
+        for (m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+                unsigned long allocs = n_allocs;
+                double start = now_ns();
+
+                for (i = 0; i < iterations; i++)
+                        libedid_destroy_edid_info(
+                                libedid_process_edid_info_flags(e->raw, modes[m].flags));
+
+                print_result("parse", e->name, modes[m].name,
+                        (now_ns() - start) / iterations,
+                        (double)(n_allocs - allocs) / iterations);
+        }
+}
+
+static void bench_stages(struct bench_edid *e)
+{
+        static const struct {
+                const char *name;
+                u_int32_t groups;
+        } stages[] = {
+                { "base_block", EDID_DECODE_BASE },
+                { "cea_data_blocks", EDID_DECODE_CEA_HDR | EDID_DECODE_VIDEO |
+                        EDID_DECODE_VSDB | EDID_DECODE_COLORIMETRY |
+                        EDID_DECODE_HDR | EDID_DECODE_MISC },
+                { "dtds", EDID_DECODE_DTD },
+        };
+        double ns[sizeof(stages) / sizeof(stages[0])] = { 0 };
+        double index_ns = 0;
+        unsigned int s;
+        double start;
+        long i;
+
+        /* Header, checksums and data block bounds only */
+        start = now_ns();
+        for (i = 0; i < iterations; i++)
+                libedid_validate_edid(e->raw, e->len);
+        print_result("stage", e->name, "validate", (now_ns() - start) / iterations, -1);
+
+        /* Validate + index first, then each stage on its own */
+        for (i = 0; i < iterations; i++) {
+                double t = now_ns();
+                struct edid_info *info = libedid_process_edid_info_flags(e->raw,
+                                EDID_PARSE_LAZY | EDID_PARSE_ARENA);
+
+                index_ns += now_ns() - t;
+                for (s = 0; s < sizeof(stages) / sizeof(stages[0]); s++) {
+                        t = now_ns();
+                        libedid_decode_groups(info, stages[s].groups);
+                        ns[s] += now_ns() - t;
+                }
+                libedid_destroy_edid_info(info);
+        }
+
+        print_result("stage", e->name, "validate_index", index_ns / iterations, -1);
+        for (s = 0; s < sizeof(stages) / sizeof(stages[0]); s++)
+                print_result("stage", e->name, stages[s].name, ns[s] / iterations, -1);
+}
+
+/*
+ * Accessors return different types, wrap each one so that the return
+ * value is converted, and can be summed up into a sink.
+ */
+#define BENCH_ACCESSOR(fn) \
+static unsigned long bench_##fn(void *h) \
+{ \
+        return (unsigned long)fn(h); \
+}
+
+BENCH_ACCESSOR(libedid_get_display_vendor)
+BENCH_ACCESSOR(libedid_get_display_productid)
+BENCH_ACCESSOR(libedid_get_display_sno)
+BENCH_ACCESSOR(libedid_get_preferred_mode)
+BENCH_ACCESSOR(libedid_display_supports_ycbcr)
+BENCH_ACCESSOR(libedid_display_supports_ycbcr444)
+BENCH_ACCESSOR(libedid_display_supports_ycbcr422)
+BENCH_ACCESSOR(libedid_display_supports_ycbcr420)
+BENCH_ACCESSOR(libedid_display_supports_dcip3)
+BENCH_ACCESSOR(libedid_display_supports_bt2020)
+BENCH_ACCESSOR(libedid_display_supports_dc)
+BENCH_ACCESSOR(libedid_display_supports_dc_10bpc)
+BENCH_ACCESSOR(libedid_display_supports_dc_12bpc)
+BENCH_ACCESSOR(libedid_display_supports_dc_16bpc)
+BENCH_ACCESSOR(libedid_display_supports_dc420)
+BENCH_ACCESSOR(libedid_display_deepest_420_color_depth)
+BENCH_ACCESSOR(libedid_display_supports_dc420_10bpc)
+BENCH_ACCESSOR(libedid_display_supports_dc420_12bpc)
+BENCH_ACCESSOR(libedid_display_supports_dc420_16bpc)
+BENCH_ACCESSOR(libedid_display_max_tmds_clk_mhz)
+BENCH_ACCESSOR(libedid_display_supports_audio)
+BENCH_ACCESSOR(libedid_display_hdr_max_lum)
+BENCH_ACCESSOR(libedid_display_hdr_min_lum)
+BENCH_ACCESSOR(libedid_display_supports_hdr_gamma)
+BENCH_ACCESSOR(libedid_display_supports_hdr_st2084)
+BENCH_ACCESSOR(libedid_display_supports_hdr_hlg)
+BENCH_ACCESSOR(libedid_display_supports_hdr_output)
+
+static unsigned long bench_libedid_get_mode_list(void *h)
+{
+        struct libedid_detailed_mode modes[64];
+
+        return libedid_get_mode_list(h, LIBEDID_MODES_ALL | LIBEDID_MODES_FRACTIONAL,
+                        modes, 64);
+}
+
+static unsigned long bench_libedid_find_nearest_mode(void *h)
+{
+        return libedid_find_nearest_mode(h, 3840, 2160, 60000);
+}
+
+#define BENCH_ACCESSOR_ENTRY(fn) { #fn, bench_##fn }
+
+static void bench_accessors(struct bench_edid *e)
+{
+        /* Everything in libedid-api.h which only takes the handle */
+        static const struct {
+                const char *name;
+                unsigned long (*fn)(void *h);
+        } accessors[] = {
+                BENCH_ACCESSOR_ENTRY(libedid_get_display_vendor),
+                BENCH_ACCESSOR_ENTRY(libedid_get_display_productid),
+                BENCH_ACCESSOR_ENTRY(libedid_get_display_sno),
+                BENCH_ACCESSOR_ENTRY(libedid_get_preferred_mode),
+                BENCH_ACCESSOR_ENTRY(libedid_display_supports_ycbcr),
+                BENCH_ACCESSOR_ENTRY(libedid_display_supports_ycbcr444),
+                BENCH_ACCESSOR_ENTRY(libedid_display_supports_ycbcr422),
+                BENCH_ACCESSOR_ENTRY(libedid_display_supports_ycbcr420),
+                BENCH_ACCESSOR_ENTRY(libedid_display_supports_dcip3),
+                BENCH_ACCESSOR_ENTRY(libedid_display_supports_bt2020),
+                BENCH_ACCESSOR_ENTRY(libedid_display_supports_dc),
+                BENCH_ACCESSOR_ENTRY(libedid_display_supports_dc_10bpc),
+                BENCH_ACCESSOR_ENTRY(libedid_display_supports_dc_12bpc),
+                BENCH_ACCESSOR_ENTRY(libedid_display_supports_dc_16bpc),
+                BENCH_ACCESSOR_ENTRY(libedid_display_supports_dc420),
+                BENCH_ACCESSOR_ENTRY(libedid_display_deepest_420_color_depth),
+                BENCH_ACCESSOR_ENTRY(libedid_display_supports_dc420_10bpc),
+                BENCH_ACCESSOR_ENTRY(libedid_display_supports_dc420_12bpc),
+                BENCH_ACCESSOR_ENTRY(libedid_display_supports_dc420_16bpc),
+                BENCH_ACCESSOR_ENTRY(libedid_display_max_tmds_clk_mhz),
+                BENCH_ACCESSOR_ENTRY(libedid_display_supports_audio),
+                BENCH_ACCESSOR_ENTRY(libedid_display_hdr_max_lum),
+                BENCH_ACCESSOR_ENTRY(libedid_display_hdr_min_lum),
+                BENCH_ACCESSOR_ENTRY(libedid_display_supports_hdr_gamma),
+                BENCH_ACCESSOR_ENTRY(libedid_display_supports_hdr_st2084),
+                BENCH_ACCESSOR_ENTRY(libedid_display_supports_hdr_hlg),
+                BENCH_ACCESSOR_ENTRY(libedid_display_supports_hdr_output),
+                BENCH_ACCESSOR_ENTRY(libedid_get_mode_list),
+                BENCH_ACCESSOR_ENTRY(libedid_find_nearest_mode),
+        };
+        void *handle = libedid_init(e->raw);
+        long calls = iterations * 10;
+        unsigned int a;
+        long i;
+
+        if (!handle)
+                return;
+
+        for (a = 0; a < sizeof(accessors) / sizeof(accessors[0]); a++) {
+                unsigned long (*fn)(void *) = accessors[a].fn;
+                volatile unsigned long sink = 0;
+                double start = now_ns();
+
+                for (i = 0; i < calls; i++)
+                        sink += fn(handle);
+
+                (void)sink;
+                print_result("accessor", e->name, accessors[a].name,
+                        (now_ns() - start) / calls, -1);
+        }
+
+        libedid_destroy(handle);
+}
+
+static void bench_scaling(int max_threads)
+{
+        size_t n = (size_t)n_corpus * (iterations / 10 + 1);
+        struct libedid_blob *blobs = __libc_malloc(n * sizeof(*blobs));
+        void **handles = __libc_malloc(n * sizeof(*handles));
+        int *status = __libc_malloc(n * sizeof(*status));
+        int threads;
+        size_t i;
+
+        if (!blobs || !handles || !status)
+                return;
+
+        for (i = 0; i < n; i++) {
+                blobs[i].data = corpus[i % n_corpus].raw;
+                blobs[i].len = corpus[i % n_corpus].len;
+        }
+
+        /* Powers of two, and max_threads itself */
+        for (threads = 1;; threads = threads * 2 < max_threads ? threads * 2 : max_threads) {
+                double start = now_ns();
+                char mode[32];
+
+                libedid_process_batch(blobs, n, handles, status, threads);
+                snprintf(mode, sizeof(mode), "threads_%d", threads);
+                print_result("batch", "corpus", mode, (now_ns() - start) / n, -1);
+
+                for (i = 0; i < n; i++)
+                        libedid_destroy(handles[i]);
+
+                if (threads == max_threads)
+                        break;
+        }
+
+        free(blobs);
+        free(handles);
+        free(status);
+}
+
+int main(int argc, char **argv)
+{
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        int max_threads = cpus > 0 ? cpus : 1;
+        int opt, i;
+
+        while ((opt = getopt(argc, argv, "i:t:")) != -1) {
+                switch (opt) {
+                case 'i':
+                        iterations = atol(optarg);
+                        break;
+                case 't':
+                        max_threads = atoi(optarg);
+                        break;
+                default:
+                        printf("Usage: %s [-i iterations] [-t max_threads] corpus_dir...\n", argv[0]);
+                        return -1;
+                }
+        }
+
+        if (optind >= argc || iterations <= 0 || max_threads <= 0) {
+                printf("Usage: %s [-i iterations] [-t max_threads] corpus_dir...\n", argv[0]);
+                return -1;
+        }
+
+        for (i = optind; i < argc; i++)
+                load_corpus_dir(argv[i]);
+
+        if (!n_corpus) {
+                printf("Error: No EDIDs found in corpus\n");
+                return -1;
+        }
+
+        for (i = 0; i < n_corpus; i++) {
+                bench_parse(&corpus[i]);
+                bench_stages(&corpus[i]);
+                bench_accessors(&corpus[i]);
+        }
+
+        bench_scaling(max_threads);
+        return 0;
+}
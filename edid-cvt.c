@@ -0,0 +1,386 @@
+/*
+ * Copyright (c) 2022 Shashank Sharma (contactshashanksharma@gmail.com)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sub license,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the
+ * next paragraph) shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * VESA CVT (standard and reduced blanking v1, v2, v3) and GTF timing
+ * formulas, computed with integer math only.
+ *
+ * Periods are kept in ps, frequencies in mHz and percentages in
+ * thousandths, which is as precise as the VESA spreadsheets once their
+ * results are rounded. The same few modes are asked for over and over
+ * (standard timings of every EDID), so results are memoized, per thread
+ * so that the parse path takes no lock.
+ */
+
+#include <string.h>
+#include <sys/types.h>
+
+#include "libedid.h"
+
+#define CVT_H_GRANULARITY 8
+#define CVT_MIN_V_PORCH 3
+#define CVT_MIN_V_BPORCH 6
+/* Minimum vsync + back porch time, in us */
+#define CVT_MIN_VSYNC_BP 550
+#define CVT_HSYNC_PERCENT 8
+#define CVT_CLOCK_STEP_KHZ 250
+/* Blanking formula: C' = 30%, M' = 300%/kHz */
+#define CVT_C_PRIME 30
+#define CVT_M_PRIME 300
+
+/* Reduced blanking: minimum vertical blanking time, in us */
+#define CVT_RB_MIN_V_BLANK 460
+#define CVT_RB_HSYNC 32
+/* v1: fixed blanking, sync in the middle of it */
+#define CVT_RB1_HBLANK 160
+#define CVT_RB1_V_FPORCH 3
+/* v2 and v3: 8 pixel front porch, 8 line vsync */
+#define CVT_RB2_HBLANK 80
+#define CVT_RB2_H_FPORCH 8
+#define CVT_RB2_VSYNC 8
+#define CVT_RB2_MIN_V_FPORCH 1
+
+#define GTF_CELL_GRAN 8
+#define GTF_MIN_V_PORCH 1
+#define GTF_VSYNC 3
+#define GTF_MIN_VSYNC_BP 550
+#define GTF_HSYNC_PERCENT 8
+
+/* Vsync width tells the aspect ratio to the sink */
+static u_int16_t
+cvt_vsync(u_int16_t hactive, u_int16_t vactive)
+{
+        if (vactive * 4 / 3 == hactive)
+                return 4;
+        if (vactive * 16 / 9 == hactive)
+                return 5;
+        if (vactive * 16 / 10 == hactive)
+                return 6;
+        if (vactive * 5 / 4 == hactive || vactive * 15 / 9 == hactive)
+                return 7;
+        return 10;
+}
+
+static int
+cvt_mode(const struct edid_timing_req *req, struct detailed_mode *mode)
+{
+        bool interlaced = req->flags & EDID_TIMING_INTERLACED;
+        u_int16_t hactive = req->hactive - req->hactive % CVT_H_GRANULARITY;
+        u_int16_t vlines = interlaced ? req->vactive / 2 : req->vactive;
+        u_int64_t field_mhz = (u_int64_t)req->refresh_mhz * (interlaced ? 2 : 1);
+        u_int64_t hperiod_ps, clock_khz;
+        u_int32_t vsync_bp, vsync, hblank, htotal, hsync;
+        int64_t hblank_pct;
+
+        if (!hactive || !vlines ||
+                        field_mhz * CVT_MIN_VSYNC_BP * 1000000 >= 1000000000000000ULL)
+                return -1;
+
+        /* Estimated line period, a field minus the minimum vertical blanking,
+         * interlaced fields are half a line longer
+         */
+        hperiod_ps = (1000000000000000ULL - field_mhz * CVT_MIN_VSYNC_BP * 1000000) * 2 /
+                (field_mhz * ((vlines + CVT_MIN_V_PORCH) * 2 + interlaced));
+        if (!hperiod_ps)
+                return -1;
+
+        vsync = cvt_vsync(hactive, req->vactive);
+        vsync_bp = (u_int64_t)CVT_MIN_VSYNC_BP * 1000000 / hperiod_ps + 1;
+        if (vsync_bp < vsync + CVT_MIN_V_BPORCH)
+                vsync_bp = vsync + CVT_MIN_V_BPORCH;
+
+        /* Ideal blanking duty cycle, never under 20% */
+        hblank_pct = CVT_C_PRIME * 1000 - (int64_t)(CVT_M_PRIME * hperiod_ps / 1000000);
+        if (hblank_pct < 20 * 1000)
+                hblank_pct = 20 * 1000;
+        hblank = (u_int64_t)hactive * hblank_pct / (100 * 1000 - hblank_pct);
+        hblank -= hblank % (2 * CVT_H_GRANULARITY);
+        htotal = hactive + hblank;
+
+        hsync = htotal * CVT_HSYNC_PERCENT / 100;
+        hsync -= hsync % CVT_H_GRANULARITY;
+        if (hsync > hblank / 2)
+                return -1;
+
+        clock_khz = (u_int64_t)htotal * 1000000000 / hperiod_ps;
+        clock_khz -= clock_khz % CVT_CLOCK_STEP_KHZ;
+
+        mode->pixel_clock_khz = clock_khz;
+        mode->hactive = hactive;
+        mode->hblank = hblank;
+        /* Sync ends in the middle of the blanking */
+        mode->hsync = hsync;
+        mode->hfrontp = hblank / 2 - hsync;
+        mode->vactive = vlines;
+        mode->vblank = vsync_bp + CVT_MIN_V_PORCH;
+        mode->vfrontp = CVT_MIN_V_PORCH;
+        mode->vsync = vsync;
+        mode->interlaced = interlaced;
+        return 0;
+}
+
+static int
+cvt_rb_mode(const struct edid_timing_req *req, struct detailed_mode *mode)
+{
+        u_int64_t refresh_mhz = req->refresh_mhz;
+        u_int16_t hactive = req->hactive;
+        u_int16_t vactive = req->vactive;
+        u_int32_t vbi, min_vbi, vsync, vfrontp, hblank, htotal;
+        u_int64_t hperiod_ps, clock_khz;
+
+        if (req->flags & EDID_TIMING_INTERLACED ||
+                        refresh_mhz * CVT_RB_MIN_V_BLANK * 1000000 >= 1000000000000000ULL)
+                return -1;
+
+        switch (req->formula) {
+        case EDID_TIMING_CVT_RB:
+                hactive -= hactive % CVT_H_GRANULARITY;
+                hblank = CVT_RB1_HBLANK;
+                vsync = cvt_vsync(hactive, vactive);
+                vfrontp = CVT_RB1_V_FPORCH;
+                break;
+        case EDID_TIMING_CVT_RB3:
+                if (req->rb3_hblank_extra > 120 || req->rb3_hblank_extra % 8)
+                        return -1;
+                hactive -= hactive % CVT_H_GRANULARITY;
+                hblank = CVT_RB2_HBLANK + req->rb3_hblank_extra;
+                vsync = CVT_RB2_VSYNC;
+                vfrontp = CVT_RB2_MIN_V_FPORCH;
+                break;
+        default:
+                hblank = CVT_RB2_HBLANK;
+                vsync = CVT_RB2_VSYNC;
+                vfrontp = CVT_RB2_MIN_V_FPORCH;
+                break;
+        }
+
+        if (!hactive || !vactive)
+                return -1;
+
+        /* Lines which fit in the minimum vertical blanking time */
+        hperiod_ps = (1000000000000000ULL - refresh_mhz * CVT_RB_MIN_V_BLANK * 1000000) /
+                (refresh_mhz * vactive);
+        if (!hperiod_ps)
+                return -1;
+        vbi = (u_int64_t)CVT_RB_MIN_V_BLANK * 1000000 / hperiod_ps + 1;
+        min_vbi = vfrontp + vsync + CVT_MIN_V_BPORCH;
+        if (vbi < min_vbi)
+                vbi = min_vbi;
+
+        htotal = hactive + hblank;
+        clock_khz = refresh_mhz * (vactive + vbi) * htotal / 1000000;
+        if (req->formula == EDID_TIMING_CVT_RB) {
+                clock_khz -= clock_khz % CVT_CLOCK_STEP_KHZ;
+        } else if (req->flags & EDID_TIMING_VIDEO_OPTIMIZED) {
+                clock_khz = refresh_mhz * (vactive + vbi) * htotal / 1001000;
+        }
+
+        mode->pixel_clock_khz = clock_khz;
+        mode->hactive = hactive;
+        mode->hblank = hblank;
+        mode->hsync = CVT_RB_HSYNC;
+        mode->vactive = vactive;
+        mode->vblank = vbi;
+        mode->vsync = vsync;
+        if (req->formula == EDID_TIMING_CVT_RB) {
+                /* Sync ends in the middle of the blanking */
+                mode->hfrontp = hblank / 2 - CVT_RB_HSYNC;
+                mode->vfrontp = vfrontp;
+        } else {
+                mode->hfrontp = CVT_RB2_H_FPORCH;
+                /* Extra lines go to the front porch, the back porch is fixed */
+                if (req->formula == EDID_TIMING_CVT_RB3 &&
+                                (req->flags & EDID_TIMING_EARLY_VSYNC))
+                        mode->vfrontp = vfrontp;
+                else
+                        mode->vfrontp = vbi - vsync - CVT_MIN_V_BPORCH;
+        }
+        return 0;
+}
+
+static int
+gtf_mode(const struct edid_timing_req *req, struct detailed_mode *mode)
+{
+        bool interlaced = req->flags & EDID_TIMING_INTERLACED;
+        u_int16_t hactive = (req->hactive + GTF_CELL_GRAN / 2) / GTF_CELL_GRAN * GTF_CELL_GRAN;
+        u_int16_t vlines = interlaced ? req->vactive / 2 : req->vactive;
+        u_int64_t field_mhz = (u_int64_t)req->refresh_mhz * (interlaced ? 2 : 1);
+        /* Default curve: C = 40%, M = 600%/kHz, K = 128, J = 20% */
+        u_int32_t c_x2 = 80, m = 600, k = 128, j_x2 = 40;
+        u_int64_t hfreq_mhz, num, den;
+        u_int32_t vsync_bp, vtotal_x2, hblank, htotal, hsync;
+        int64_t c_prime, duty;
+
+        if (!hactive || !vlines || field_mhz * GTF_MIN_VSYNC_BP >= 1000000000ULL)
+                return -1;
+
+        /* Estimated line frequency, a field minus the minimum vsync + back
+         * porch time, interlaced fields are half a line longer
+         */
+        hfreq_mhz = field_mhz * ((vlines + GTF_MIN_V_PORCH) * 2 + interlaced) * 1000000000 /
+                (2 * (1000000000 - field_mhz * GTF_MIN_VSYNC_BP));
+        vsync_bp = (hfreq_mhz * GTF_MIN_VSYNC_BP + 500000000) / 1000000000;
+        if (vsync_bp <= GTF_VSYNC)
+                vsync_bp = GTF_VSYNC + 1;
+
+        /* Actual line frequency, for the refresh rate asked for */
+        vtotal_x2 = (vlines + vsync_bp + GTF_MIN_V_PORCH) * 2 + interlaced;
+        hfreq_mhz = field_mhz * vtotal_x2 / 2;
+        if (!hfreq_mhz)
+                return -1;
+
+        if (req->formula == EDID_TIMING_GTF2 &&
+                        hfreq_mhz >= (u_int64_t)req->gtf.start_khz * 1000000) {
+                c_x2 = req->gtf.c_x2;
+                m = req->gtf.m;
+                k = req->gtf.k;
+                j_x2 = req->gtf.j_x2;
+        }
+
+        /* C' = (C - J) * K / 256 + J, and the duty cycle C' - M' * H_PERIOD,
+         * with M' = K * M / 256, in thousandths of a percent
+         */
+        c_prime = ((int64_t)c_x2 - j_x2) * 500 * k / 256 + j_x2 * 500;
+        duty = c_prime - (int64_t)((u_int64_t)k * m * 1000000000 / 256 / hfreq_mhz);
+        if (duty <= 0 || duty >= 100 * 1000)
+                return -1;
+
+        /* Rounded to twice the cell granularity */
+        num = (u_int64_t)hactive * duty;
+        den = (u_int64_t)(100 * 1000 - duty) * 2 * GTF_CELL_GRAN;
+        hblank = (num + den / 2) / den * 2 * GTF_CELL_GRAN;
+        htotal = hactive + hblank;
+
+        hsync = (htotal * GTF_HSYNC_PERCENT + 50 * GTF_CELL_GRAN) /
+                (100 * GTF_CELL_GRAN) * GTF_CELL_GRAN;
+        if (hsync > hblank / 2)
+                return -1;
+
+        mode->pixel_clock_khz = ((u_int64_t)htotal * hfreq_mhz + 500000) / 1000000;
+        mode->hactive = hactive;
+        mode->hblank = hblank;
+        /* Sync ends in the middle of the blanking */
+        mode->hsync = hsync;
+        mode->hfrontp = hblank / 2 - hsync;
+        mode->vactive = vlines;
+        mode->vblank = vsync_bp + GTF_MIN_V_PORCH;
+        mode->vfrontp = GTF_MIN_V_PORCH;
+        mode->vsync = GTF_VSYNC;
+        mode->interlaced = interlaced;
+        return 0;
+}
+
+static int
+edid_timing_compute(const struct edid_timing_req *req, struct detailed_mode *mode)
+{
+        memset(mode, 0, sizeof(*mode));
+        if (!req->hactive || !req->vactive || !req->refresh_mhz)
+                return -1;
+
+        switch (req->formula) {
+        case EDID_TIMING_CVT:
+                return cvt_mode(req, mode);
+        case EDID_TIMING_CVT_RB:
+        case EDID_TIMING_CVT_RB2:
+        case EDID_TIMING_CVT_RB3:
+                return cvt_rb_mode(req, mode);
+        case EDID_TIMING_GTF:
+        case EDID_TIMING_GTF2:
+                return gtf_mode(req, mode);
+        default:
+                return -1;
+        }
+}
+
+/* Direct mapped, a collision just recomputes. Per thread, 128 entries
+ * are about 8 KB.
+ */
+#define EDID_TIMING_MEMO_SIZE 128
+
+struct edid_timing_memo_entry {
+        bool valid;
+        int ret;
+        struct edid_timing_req key;
+        struct detailed_mode mode;
+};
+
+static __thread struct edid_timing_memo_entry edid_timing_memo[EDID_TIMING_MEMO_SIZE];
+
+/* Copy of req with only the fields its formula uses, and no padding
+ * garbage, so that keys compare with memcmp()
+ */
+static void
+edid_timing_key(const struct edid_timing_req *req, struct edid_timing_req *key)
+{
+        memset(key, 0, sizeof(*key));
+        key->formula = req->formula;
+        key->flags = req->flags;
+        key->hactive = req->hactive;
+        key->vactive = req->vactive;
+        key->refresh_mhz = req->refresh_mhz;
+        if (req->formula == EDID_TIMING_CVT_RB3)
+                key->rb3_hblank_extra = req->rb3_hblank_extra;
+        if (req->formula == EDID_TIMING_GTF2) {
+                key->gtf.start_khz = req->gtf.start_khz;
+                key->gtf.m = req->gtf.m;
+                key->gtf.c_x2 = req->gtf.c_x2;
+                key->gtf.k = req->gtf.k;
+                key->gtf.j_x2 = req->gtf.j_x2;
+        }
+}
+
+static unsigned int
+edid_timing_hash(const struct edid_timing_req *key)
+{
+        u_int64_t h = (u_int64_t)key->hactive << 48 | (u_int64_t)key->vactive << 32 |
+                key->refresh_mhz;
+
+        h ^= (u_int64_t)(key->formula | key->flags << 4) << 56;
+        h ^= (u_int64_t)key->rb3_hblank_extra << 40;
+        h ^= (u_int64_t)key->gtf.start_khz << 20 ^ key->gtf.m ^
+                (u_int64_t)(key->gtf.c_x2 ^ key->gtf.k << 8 ^ key->gtf.j_x2 << 16) << 28;
+        h *= 0x9E3779B97F4A7C15ULL;
+        return h >> 57;
+}
+
+int libedid_timing_mode(const struct edid_timing_req *req, struct detailed_mode *mode)
+{
+        struct edid_timing_memo_entry *entry;
+        struct edid_timing_req key;
+        int ret;
+
+        edid_timing_key(req, &key);
+        entry = &edid_timing_memo[edid_timing_hash(&key)];
+
+        if (entry->valid && !memcmp(&entry->key, &key, sizeof(key))) {
+                memcpy(mode, &entry->mode, sizeof(*mode));
+                return entry->ret;
+        }
+
+        ret = edid_timing_compute(&key, mode);
+        entry->valid = true;
+        entry->ret = ret;
+        entry->key = key;
+        memcpy(&entry->mode, mode, sizeof(*mode));
+        return ret;
+}
@@ -0,0 +1,365 @@
+/*
+ * Copyright (c) 2022 Shashank Sharma (contactshashanksharma@gmail.com)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sub license,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the
+ * next paragraph) shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * VESA DMT timings, and the established timings of the base block.
+ *
+ * The DMT table is indexed by the DMT ID, like the VIC table, and written
+ * as modelines which EDID_DMT() turns into porches and blanking at build
+ * time. Established timings map to it through a table of pointers, except
+ * for the few old IBM and Apple modes which DMT never listed.
+ */
+
+#include <stddef.h>
+#include <sys/types.h>
+
+#include "libedid.h"
+
+#define DMT_FIELDS(fl) (((fl) & EDID_DMT_INTERLACED) ? 2 : 1)
+
+#define EDID_DMT(dmt_id, hz, clk, ha, hss, hse, ht, va, vss, vse, vt, fl) { \
+        .id = (dmt_id), \
+        .refresh_hz = (hz), \
+        .flags = (fl), \
+        .pixel_clock_khz = (clk), \
+        .refresh_mhz = (u_int32_t)(((u_int64_t)(clk) * 1000000 * DMT_FIELDS(fl) + \
+                (u_int64_t)(ht) * (vt) / 2) / ((u_int64_t)(ht) * (vt))), \
+        .hactive = (ha), \
+        .hfrontp = (hss) - (ha), \
+        .hsync = (hse) - (hss), \
+        .hblank = (ht) - (ha), \
+        .vactive = (va) / DMT_FIELDS(fl), \
+        .vfrontp = ((vss) - (va)) / DMT_FIELDS(fl), \
+        .vsync = ((vse) - (vss)) / DMT_FIELDS(fl), \
+        .vblank = ((vt) - (va)) / DMT_FIELDS(fl), \
+}
+
+/* Short names for the tables below: sync polarities (+hsync+vsync,
+ * +hsync-vsync, -hsync+vsync, -hsync-vsync), interlaced, reduced blanking
+ */
+#define PP (EDID_DMT_HSYNC_POS | EDID_DMT_VSYNC_POS)
+#define PN EDID_DMT_HSYNC_POS
+#define NP EDID_DMT_VSYNC_POS
+#define NN 0
+#define IL EDID_DMT_INTERLACED
+#define RB EDID_DMT_REDUCED_BLANKING
+
+#define EDID_DMT_MAX_ID 0x58
+
+/* DMT 1.0 rev 13, ID 0 is unused and left zeroed */
+static const struct edid_dmt_timing edid_dmt_timings[EDID_DMT_MAX_ID + 1] = {
+        [0x01] = EDID_DMT(0x01, 85, 31500, 640, 672, 736, 832, 350, 382, 385, 445,
+                        PN),
+        [0x02] = EDID_DMT(0x02, 85, 31500, 640, 672, 736, 832, 400, 401, 404, 445,
+                        NP),
+        [0x03] = EDID_DMT(0x03, 85, 35500, 720, 756, 828, 936, 400, 401, 404, 446,
+                        NP),
+        [0x04] = EDID_DMT(0x04, 60, 25175, 640, 656, 752, 800, 480, 490, 492, 525,
+                        NN),
+        [0x05] = EDID_DMT(0x05, 72, 31500, 640, 664, 704, 832, 480, 489, 492, 520,
+                        NN),
+        [0x06] = EDID_DMT(0x06, 75, 31500, 640, 656, 720, 840, 480, 481, 484, 500,
+                        NN),
+        [0x07] = EDID_DMT(0x07, 85, 36000, 640, 696, 752, 832, 480, 481, 484, 509,
+                        NN),
+        [0x08] = EDID_DMT(0x08, 56, 36000, 800, 824, 896, 1024, 600, 601, 603, 625,
+                        PP),
+        [0x09] = EDID_DMT(0x09, 60, 40000, 800, 840, 968, 1056, 600, 601, 605, 628,
+                        PP),
+        [0x0a] = EDID_DMT(0x0a, 72, 50000, 800, 856, 976, 1040, 600, 637, 643, 666,
+                        PP),
+        [0x0b] = EDID_DMT(0x0b, 75, 49500, 800, 816, 896, 1056, 600, 601, 604, 625,
+                        PP),
+        [0x0c] = EDID_DMT(0x0c, 85, 56250, 800, 832, 896, 1048, 600, 601, 604, 631,
+                        PP),
+        [0x0d] = EDID_DMT(0x0d, 120, 73250, 800, 848, 880, 960, 600, 603, 607, 636,
+                        PN | RB),
+        [0x0e] = EDID_DMT(0x0e, 60, 33750, 848, 864, 976, 1088, 480, 486, 494, 517,
+                        PP),
+        [0x0f] = EDID_DMT(0x0f, 43, 44900, 1024, 1032, 1208, 1264, 768, 768, 776, 817,
+                        IL | PP),
+        [0x10] = EDID_DMT(0x10, 60, 65000, 1024, 1048, 1184, 1344, 768, 771, 777, 806,
+                        NN),
+        [0x11] = EDID_DMT(0x11, 70, 75000, 1024, 1048, 1184, 1328, 768, 771, 777, 806,
+                        NN),
+        [0x12] = EDID_DMT(0x12, 75, 78750, 1024, 1040, 1136, 1312, 768, 769, 772, 800,
+                        PP),
+        [0x13] = EDID_DMT(0x13, 85, 94500, 1024, 1072, 1168, 1376, 768, 769, 772, 808,
+                        PP),
+        [0x14] = EDID_DMT(0x14, 120, 115500, 1024, 1072, 1104, 1184, 768, 771, 775, 813,
+                        PN | RB),
+        [0x15] = EDID_DMT(0x15, 75, 108000, 1152, 1216, 1344, 1600, 864, 865, 868, 900,
+                        PP),
+        [0x16] = EDID_DMT(0x16, 60, 68250, 1280, 1328, 1360, 1440, 768, 771, 778, 790,
+                        PN | RB),
+        [0x17] = EDID_DMT(0x17, 60, 79500, 1280, 1344, 1472, 1664, 768, 771, 778, 798,
+                        NP),
+        [0x18] = EDID_DMT(0x18, 75, 102250, 1280, 1360, 1488, 1696, 768, 771, 778, 805,
+                        NP),
+        [0x19] = EDID_DMT(0x19, 85, 117500, 1280, 1360, 1496, 1712, 768, 771, 778, 809,
+                        NP),
+        [0x1a] = EDID_DMT(0x1a, 120, 140250, 1280, 1328, 1360, 1440, 768, 771, 778, 813,
+                        PN | RB),
+        [0x1b] = EDID_DMT(0x1b, 60, 71000, 1280, 1328, 1360, 1440, 800, 803, 809, 823,
+                        PN | RB),
+        [0x1c] = EDID_DMT(0x1c, 60, 83500, 1280, 1352, 1480, 1680, 800, 803, 809, 831,
+                        NP),
+        [0x1d] = EDID_DMT(0x1d, 75, 106500, 1280, 1360, 1488, 1696, 800, 803, 809, 838,
+                        NP),
+        [0x1e] = EDID_DMT(0x1e, 85, 122500, 1280, 1360, 1496, 1712, 800, 803, 809, 843,
+                        NP),
+        [0x1f] = EDID_DMT(0x1f, 120, 146250, 1280, 1328, 1360, 1440, 800, 803, 809, 847,
+                        PN | RB),
+        [0x20] = EDID_DMT(0x20, 60, 108000, 1280, 1376, 1488, 1800, 960, 961, 964, 1000,
+                        PP),
+        [0x21] = EDID_DMT(0x21, 85, 148500, 1280, 1344, 1504, 1728, 960, 961, 964, 1011,
+                        PP),
+        [0x22] = EDID_DMT(0x22, 120, 175500, 1280, 1328, 1360, 1440, 960, 963, 967, 1017,
+                        PN | RB),
+        [0x23] = EDID_DMT(0x23, 60, 108000, 1280, 1328, 1440, 1688, 1024, 1025, 1028, 1066,
+                        PP),
+        [0x24] = EDID_DMT(0x24, 75, 135000, 1280, 1296, 1440, 1688, 1024, 1025, 1028, 1066,
+                        PP),
+        [0x25] = EDID_DMT(0x25, 85, 157500, 1280, 1344, 1504, 1728, 1024, 1025, 1028, 1072,
+                        PP),
+        [0x26] = EDID_DMT(0x26, 120, 187250, 1280, 1328, 1360, 1440, 1024, 1027, 1034, 1084,
+                        PN | RB),
+        [0x27] = EDID_DMT(0x27, 60, 85500, 1360, 1424, 1536, 1792, 768, 771, 777, 795,
+                        PP),
+        [0x28] = EDID_DMT(0x28, 120, 148250, 1360, 1408, 1440, 1520, 768, 771, 776, 813,
+                        PN | RB),
+        [0x29] = EDID_DMT(0x29, 60, 101000, 1400, 1448, 1480, 1560, 1050, 1053, 1057, 1080,
+                        PN | RB),
+        [0x2a] = EDID_DMT(0x2a, 60, 121750, 1400, 1488, 1632, 1864, 1050, 1053, 1057, 1089,
+                        NP),
+        [0x2b] = EDID_DMT(0x2b, 75, 156000, 1400, 1504, 1648, 1896, 1050, 1053, 1057, 1099,
+                        NP),
+        [0x2c] = EDID_DMT(0x2c, 85, 179500, 1400, 1504, 1656, 1912, 1050, 1053, 1057, 1105,
+                        NP),
+        [0x2d] = EDID_DMT(0x2d, 120, 208000, 1400, 1448, 1480, 1560, 1050, 1053, 1057, 1112,
+                        PN | RB),
+        [0x2e] = EDID_DMT(0x2e, 60, 88750, 1440, 1488, 1520, 1600, 900, 903, 909, 926,
+                        PN | RB),
+        [0x2f] = EDID_DMT(0x2f, 60, 106500, 1440, 1520, 1672, 1904, 900, 903, 909, 934,
+                        NP),
+        [0x30] = EDID_DMT(0x30, 75, 136750, 1440, 1536, 1688, 1936, 900, 903, 909, 942,
+                        NP),
+        [0x31] = EDID_DMT(0x31, 85, 157000, 1440, 1544, 1696, 1952, 900, 903, 909, 948,
+                        NP),
+        [0x32] = EDID_DMT(0x32, 120, 182750, 1440, 1488, 1520, 1600, 900, 903, 909, 953,
+                        PN | RB),
+        [0x33] = EDID_DMT(0x33, 60, 162000, 1600, 1664, 1856, 2160, 1200, 1201, 1204, 1250,
+                        PP),
+        [0x34] = EDID_DMT(0x34, 65, 175500, 1600, 1664, 1856, 2160, 1200, 1201, 1204, 1250,
+                        PP),
+        [0x35] = EDID_DMT(0x35, 70, 189000, 1600, 1664, 1856, 2160, 1200, 1201, 1204, 1250,
+                        PP),
+        [0x36] = EDID_DMT(0x36, 75, 202500, 1600, 1664, 1856, 2160, 1200, 1201, 1204, 1250,
+                        PP),
+        [0x37] = EDID_DMT(0x37, 85, 229500, 1600, 1664, 1856, 2160, 1200, 1201, 1204, 1250,
+                        PP),
+        [0x38] = EDID_DMT(0x38, 120, 268250, 1600, 1648, 1680, 1760, 1200, 1203, 1207, 1271,
+                        PN | RB),
+        [0x39] = EDID_DMT(0x39, 60, 119000, 1680, 1728, 1760, 1840, 1050, 1053, 1059, 1080,
+                        PN | RB),
+        [0x3a] = EDID_DMT(0x3a, 60, 146250, 1680, 1784, 1960, 2240, 1050, 1053, 1059, 1089,
+                        NP),
+        [0x3b] = EDID_DMT(0x3b, 75, 187000, 1680, 1800, 1976, 2272, 1050, 1053, 1059, 1099,
+                        NP),
+        [0x3c] = EDID_DMT(0x3c, 85, 214750, 1680, 1808, 1984, 2288, 1050, 1053, 1059, 1105,
+                        NP),
+        [0x3d] = EDID_DMT(0x3d, 120, 245500, 1680, 1728, 1760, 1840, 1050, 1053, 1059, 1112,
+                        PN | RB),
+        [0x3e] = EDID_DMT(0x3e, 60, 204750, 1792, 1920, 2120, 2448, 1344, 1345, 1348, 1394,
+                        NP),
+        [0x3f] = EDID_DMT(0x3f, 75, 261000, 1792, 1888, 2104, 2456, 1344, 1345, 1348, 1417,
+                        NP),
+        [0x40] = EDID_DMT(0x40, 120, 333250, 1792, 1840, 1872, 1952, 1344, 1347, 1351, 1423,
+                        PN | RB),
+        [0x41] = EDID_DMT(0x41, 60, 218250, 1856, 1952, 2176, 2528, 1392, 1393, 1396, 1439,
+                        NP),
+        [0x42] = EDID_DMT(0x42, 75, 288000, 1856, 1984, 2208, 2560, 1392, 1393, 1396, 1500,
+                        NP),
+        [0x43] = EDID_DMT(0x43, 120, 356500, 1856, 1904, 1936, 2016, 1392, 1395, 1399, 1474,
+                        PN | RB),
+        [0x44] = EDID_DMT(0x44, 60, 154000, 1920, 1968, 2000, 2080, 1200, 1203, 1209, 1235,
+                        PN | RB),
+        [0x45] = EDID_DMT(0x45, 60, 193250, 1920, 2056, 2256, 2592, 1200, 1203, 1209, 1245,
+                        NP),
+        [0x46] = EDID_DMT(0x46, 75, 245250, 1920, 2056, 2264, 2608, 1200, 1203, 1209, 1255,
+                        NP),
+        [0x47] = EDID_DMT(0x47, 85, 281250, 1920, 2064, 2272, 2624, 1200, 1203, 1209, 1262,
+                        NP),
+        [0x48] = EDID_DMT(0x48, 120, 317000, 1920, 1968, 2000, 2080, 1200, 1203, 1209, 1271,
+                        PN | RB),
+        [0x49] = EDID_DMT(0x49, 60, 234000, 1920, 2048, 2256, 2600, 1440, 1441, 1444, 1500,
+                        NP),
+        [0x4a] = EDID_DMT(0x4a, 75, 297000, 1920, 2064, 2288, 2640, 1440, 1441, 1444, 1500,
+                        NP),
+        [0x4b] = EDID_DMT(0x4b, 120, 380500, 1920, 1968, 2000, 2080, 1440, 1443, 1447, 1525,
+                        PN | RB),
+        [0x4c] = EDID_DMT(0x4c, 60, 268500, 2560, 2608, 2640, 2720, 1600, 1603, 1609, 1646,
+                        PN | RB),
+        [0x4d] = EDID_DMT(0x4d, 60, 348500, 2560, 2752, 3032, 3504, 1600, 1603, 1609, 1658,
+                        NP),
+        [0x4e] = EDID_DMT(0x4e, 75, 443250, 2560, 2768, 3048, 3536, 1600, 1603, 1609, 1672,
+                        NP),
+        [0x4f] = EDID_DMT(0x4f, 85, 505250, 2560, 2768, 3048, 3536, 1600, 1603, 1609, 1682,
+                        NP),
+        [0x50] = EDID_DMT(0x50, 120, 552750, 2560, 2608, 2640, 2720, 1600, 1603, 1609, 1694,
+                        PN | RB),
+        [0x51] = EDID_DMT(0x51, 60, 85500, 1366, 1436, 1579, 1792, 768, 771, 774, 798,
+                        PP),
+        [0x52] = EDID_DMT(0x52, 60, 148500, 1920, 2008, 2052, 2200, 1080, 1084, 1089, 1125,
+                        PP),
+        [0x53] = EDID_DMT(0x53, 60, 108000, 1600, 1624, 1704, 1800, 900, 901, 904, 1000,
+                        PP | RB),
+        [0x54] = EDID_DMT(0x54, 60, 162000, 2048, 2074, 2154, 2250, 1152, 1153, 1156, 1200,
+                        PP | RB),
+        [0x55] = EDID_DMT(0x55, 60, 74250, 1280, 1390, 1430, 1650, 720, 725, 730, 750,
+                        PP),
+        [0x56] = EDID_DMT(0x56, 60, 72000, 1366, 1380, 1436, 1500, 768, 769, 772, 800,
+                        PP | RB),
+        [0x57] = EDID_DMT(0x57, 60, 556744, 4096, 4104, 4136, 4176, 2160, 2208, 2216, 2222,
+                        PN | RB),
+        [0x58] = EDID_DMT(0x58, 59, 556188, 4096, 4104, 4136, 4176, 2160, 2208, 2216, 2222,
+                        PN | RB),
+};
+
+/* Established timings which are not DMT timings */
+static const struct edid_dmt_timing edid_est_legacy[] = {
+        /* 720x400@70 and @88 (IBM VGA text modes) */
+        EDID_DMT(0, 70, 28320, 720, 738, 846, 900, 400, 412, 414, 449, NP),
+        EDID_DMT(0, 88, 35500, 720, 738, 846, 900, 400, 421, 423, 449, NN),
+        /* 640x480@67, 832x624@75 and 1152x870@75 (Apple Macintosh II) */
+        EDID_DMT(0, 67, 30240, 640, 704, 768, 864, 480, 483, 486, 525, NN),
+        EDID_DMT(0, 75, 57284, 832, 864, 928, 1152, 624, 625, 628, 667, NN),
+        EDID_DMT(0, 75, 100000, 1152, 1184, 1312, 1456, 870, 873, 876, 915, NN),
+};
+
+/* Established timings I and II (bytes 0x23 and 0x24, bit 7 first), and
+ * the manufacturer timing (byte 0x25 bit 7)
+ */
+static const struct edid_dmt_timing *const edid_est_timings[17] = {
+        &edid_est_legacy[0],
+        &edid_est_legacy[1],
+        &edid_dmt_timings[0x04],
+        &edid_est_legacy[2],
+        &edid_dmt_timings[0x05],
+        &edid_dmt_timings[0x06],
+        &edid_dmt_timings[0x08],
+        &edid_dmt_timings[0x09],
+
+        &edid_dmt_timings[0x0a],
+        &edid_dmt_timings[0x0b],
+        &edid_est_legacy[3],
+        &edid_dmt_timings[0x0f],
+        &edid_dmt_timings[0x10],
+        &edid_dmt_timings[0x11],
+        &edid_dmt_timings[0x12],
+        &edid_dmt_timings[0x24],
+
+        &edid_est_legacy[4],
+};
+
+/* Progressive DMT IDs sorted by hactive, vactive and refresh rate, the
+ * reduced blanking timing after the other one of the same mode, for the
+ * binary search of libedid_find_dmt(). Keep it in sync with the table above.
+ */
+static const u_int8_t edid_dmt_by_mode[] = {
+        /* 640x350 */ 0x01,
+        /* 640x400 */ 0x02,
+        /* 640x480 */ 0x04, 0x05, 0x06, 0x07,
+        /* 720x400 */ 0x03,
+        /* 800x600 */ 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d,
+        /* 848x480 */ 0x0e,
+        /* 1024x768 */ 0x10, 0x11, 0x12, 0x13, 0x14,
+        /* 1152x864 */ 0x15,
+        /* 1280x720 */ 0x55,
+        /* 1280x768 */ 0x17, 0x16, 0x18, 0x19, 0x1a,
+        /* 1280x800 */ 0x1c, 0x1b, 0x1d, 0x1e, 0x1f,
+        /* 1280x960 */ 0x20, 0x21, 0x22,
+        /* 1280x1024 */ 0x23, 0x24, 0x25, 0x26,
+        /* 1360x768 */ 0x27, 0x28,
+        /* 1366x768 */ 0x51, 0x56,
+        /* 1400x1050 */ 0x2a, 0x29, 0x2b, 0x2c, 0x2d,
+        /* 1440x900 */ 0x2f, 0x2e, 0x30, 0x31, 0x32,
+        /* 1600x900 */ 0x53,
+        /* 1600x1200 */ 0x33, 0x34, 0x35, 0x36, 0x37, 0x38,
+        /* 1680x1050 */ 0x3a, 0x39, 0x3b, 0x3c, 0x3d,
+        /* 1792x1344 */ 0x3e, 0x3f, 0x40,
+        /* 1856x1392 */ 0x41, 0x42, 0x43,
+        /* 1920x1080 */ 0x52,
+        /* 1920x1200 */ 0x45, 0x44, 0x46, 0x47, 0x48,
+        /* 1920x1440 */ 0x49, 0x4a, 0x4b,
+        /* 2048x1152 */ 0x54,
+        /* 2560x1600 */ 0x4d, 0x4c, 0x4e, 0x4f, 0x50,
+        /* 4096x2160 */ 0x58, 0x57,
+};
+
+static inline u_int64_t
+edid_dmt_key(u_int16_t hactive, u_int16_t vactive, u_int8_t refresh_hz)
+{
+        return (u_int64_t)hactive << 24 | (u_int64_t)vactive << 8 | refresh_hz;
+}
+
+const struct edid_dmt_timing *libedid_dmt_timing(u_int8_t id)
+{
+        if (id > EDID_DMT_MAX_ID || !edid_dmt_timings[id].hactive)
+                return NULL;
+
+        return &edid_dmt_timings[id];
+}
+
+const struct edid_dmt_timing *libedid_find_dmt(u_int16_t hactive, u_int16_t vactive,
+                u_int8_t refresh_hz)
+{
+        u_int64_t key = edid_dmt_key(hactive, vactive, refresh_hz);
+        unsigned int lo = 0, hi = sizeof(edid_dmt_by_mode);
+        const struct edid_dmt_timing *t;
+
+        /* First entry not below key, which is the standard blanking one */
+        while (lo < hi) {
+                unsigned int mid = (lo + hi) / 2;
+
+                t = &edid_dmt_timings[edid_dmt_by_mode[mid]];
+                if (edid_dmt_key(t->hactive, t->vactive, t->refresh_hz) < key)
+                        lo = mid + 1;
+                else
+                        hi = mid;
+        }
+
+        if (lo == sizeof(edid_dmt_by_mode))
+                return NULL;
+
+        t = &edid_dmt_timings[edid_dmt_by_mode[lo]];
+        return edid_dmt_key(t->hactive, t->vactive, t->refresh_hz) == key ? t : NULL;
+}
+
+const struct edid_dmt_timing *libedid_est_timing(unsigned int n)
+{
+        if (n >= sizeof(edid_est_timings) / sizeof(edid_est_timings[0]))
+                return NULL;
+
+        return edid_est_timings[n];
+}
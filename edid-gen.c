@@ -0,0 +1,986 @@
+/*
+ * Copyright (c) 2022 Shashank Sharma (contactshashanksharma@gmail.com)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sub license,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the
+ * next paragraph) shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <sys/types.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "edid-gen.h"
+
+#define GEN_BLK_SIZE 128
+#define GEN_DTD_SIZE 18
+
+/* Data block tags, see enum cea_data_block_tags in libedid.h */
+#define GEN_DB_AUDIO 1
+#define GEN_DB_VIDEO 2
+#define GEN_DB_VENDOR 3
+#define GEN_DB_SPEAKER 4
+#define GEN_DB_EXTENDED 7
+#define GEN_DB_HDR(tag, len) ((u_int8_t)(((tag) << 5) | (len)))
+
+struct gen_timing {
+        u_int32_t clock_khz;
+        u_int16_t hactive, hblank, hfrontp, hsync;
+        u_int16_t vactive, vblank, vfrontp, vsync;
+};
+
+/* A few common CEA/DMT/CVT-RB timings, so that the DTDs look real */
+static const struct gen_timing gen_timings[] = {
+        { 25175, 640, 160, 16, 96, 480, 45, 10, 2 },
+        { 74250, 1280, 370, 110, 40, 720, 30, 5, 5 },
+        { 85500, 1366, 426, 70, 143, 768, 30, 3, 3 },
+        { 148500, 1920, 280, 88, 44, 1080, 45, 4, 5 },
+        { 154000, 1920, 160, 48, 32, 1200, 35, 3, 6 },
+        { 241500, 2560, 160, 48, 32, 1440, 41, 3, 5 },
+        { 297000, 3840, 560, 176, 88, 2160, 90, 8, 10 },
+        { 533250, 3840, 160, 48, 32, 2160, 62, 3, 5 },
+        { 594000, 3840, 560, 176, 88, 2160, 90, 8, 10 },
+};
+
+/* Vendor OUIs, as they appear in the EDID (LSB first) */
+static const u_int8_t gen_oui_hdmi[3] = { 0x03, 0x0C, 0x00 };
+static const u_int8_t gen_oui_hdmi_forum[3] = { 0xD8, 0x5D, 0xC4 };
+static const u_int8_t gen_oui_dolby[3] = { 0x46, 0xD0, 0x00 };
+static const u_int8_t gen_oui_hdr10plus[3] = { 0x8B, 0x84, 0x90 };
+
+/* splitmix64 */
+static u_int64_t gen_next(struct edid_gen *gen)
+{
+        u_int64_t z = (gen->state += 0x9E3779B97F4A7C15ULL);
+
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+}
+
+/* Random number in [lo, hi] */
+static unsigned int gen_range(struct edid_gen *gen, unsigned int lo, unsigned int hi)
+{
+        if (hi <= lo)
+                return lo;
+
+        return lo + gen_next(gen) % (hi - lo + 1);
+}
+
+static bool gen_chance(struct edid_gen *gen, unsigned int percent)
+{
+        return gen_next(gen) % 100 < percent;
+}
+
+static unsigned int gen_min(unsigned int a, unsigned int b)
+{
+        return a < b ? a : b;
+}
+
+static void gen_checksum(u_int8_t *blk)
+{
+        u_int8_t sum = 0;
+        int i;
+
+        for (i = 0; i < GEN_BLK_SIZE - 1; i++)
+                sum += blk[i];
+
+        blk[GEN_BLK_SIZE - 1] = (u_int8_t)(0x100 - sum);
+}
+
+static u_int8_t gen_vic(struct edid_gen *gen)
+{
+        /* Mostly VIC 1-127, and some from the 193-219 range */
+        if (gen_chance(gen, 15))
+                return gen_range(gen, 193, 219);
+
+        return gen_range(gen, 1, 127);
+}
+
+static void gen_dtd(struct edid_gen *gen, u_int8_t *p)
+{
+        const struct gen_timing *t =
+                &gen_timings[gen_range(gen, 0, sizeof(gen_timings) / sizeof(gen_timings[0]) - 1)];
+        u_int16_t clock = t->clock_khz / 10;
+        u_int16_t hmm = gen_range(gen, 300, 1600);
+        u_int16_t vmm = hmm * t->vactive / t->hactive;
+
+        p[0] = clock & 0xFF;
+        p[1] = clock >> 8;
+        p[2] = t->hactive & 0xFF;
+        p[3] = t->hblank & 0xFF;
+        p[4] = (t->hactive >> 8) << 4 | ((t->hblank >> 8) & 0xF);
+        p[5] = t->vactive & 0xFF;
+        p[6] = t->vblank & 0xFF;
+        p[7] = (t->vactive >> 8) << 4 | ((t->vblank >> 8) & 0xF);
+        p[8] = t->hfrontp & 0xFF;
+        p[9] = t->hsync & 0xFF;
+        p[10] = (t->vfrontp & 0xF) << 4 | (t->vsync & 0xF);
+        p[11] = ((t->hfrontp >> 8) & 0x3) << 6 | ((t->hsync >> 8) & 0x3) << 4 |
+                ((t->vfrontp >> 4) & 0x3) << 2 | ((t->vsync >> 4) & 0x3);
+        p[12] = hmm & 0xFF;
+        p[13] = vmm & 0xFF;
+        p[14] = (hmm >> 8) << 4 | ((vmm >> 8) & 0xF);
+        p[15] = 0;
+        p[16] = 0;
+        /* Digital separate sync, +hsync +vsync, sometimes interlaced */
+        p[17] = gen_chance(gen, 5) ? 0x9E : 0x1E;
+}
+
+static void gen_string_descriptor(u_int8_t *p, u_int8_t type, const char *str)
+{
+        int i = 0;
+
+        memset(p, 0, 5);
+        p[3] = type;
+        for (; str[i] && i < 13; i++)
+                p[5 + i] = str[i];
+        if (i < 13)
+                p[5 + i++] = '\n';
+        for (; i < 13; i++)
+                p[5 + i] = ' ';
+}
+
+static void gen_range_descriptor(struct edid_gen *gen, u_int8_t *p)
+{
+        memset(p, 0, GEN_DTD_SIZE);
+        p[3] = 0xFD;
+        p[5] = gen_range(gen, 23, 50);
+        p[6] = gen_range(gen, 60, 240);
+        p[7] = gen_range(gen, 15, 30);
+        p[8] = gen_range(gen, 80, 255);
+        p[9] = gen_range(gen, 15, 60);
+        /* Range limits only, no secondary timing formula */
+        p[10] = 0x01;
+        p[11] = '\n';
+        memset(&p[12], ' ', 6);
+}
+
+static void gen_descriptor(struct edid_gen *gen, u_int8_t *p)
+{
+        char str[14];
+        int i;
+
+        switch (gen_range(gen, 0, 4)) {
+        case 0:
+                gen_dtd(gen, p);
+                break;
+
+        case 1:
+                memcpy(str, "GEN-", 4);
+                str[4] = 'A' + gen_range(gen, 0, 25);
+                str[5] = '0' + gen_range(gen, 0, 9);
+                str[6] = '0' + gen_range(gen, 0, 9);
+                str[7] = 0;
+                gen_string_descriptor(p, 0xFC, str);
+                break;
+
+        case 2:
+                gen_range_descriptor(gen, p);
+                break;
+
+        case 3:
+                memcpy(str, "SN", 2);
+                for (i = 2; i < 12; i++)
+                        str[i] = '0' + gen_range(gen, 0, 9);
+                str[12] = 0;
+                gen_string_descriptor(p, 0xFF, str);
+                break;
+
+        default:
+                /* Dummy descriptor */
+                memset(p, 0, GEN_DTD_SIZE);
+                p[3] = 0x10;
+                break;
+        }
+}
+
+static void gen_base_block(struct edid_gen *gen, u_int8_t *blk, u_int8_t n_ext)
+{
+        static const u_int8_t header[8] = { 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00 };
+        u_int16_t mfg_id = gen_range(gen, 1, 26) << 10 | gen_range(gen, 1, 26) << 5 |
+                gen_range(gen, 1, 26);
+        u_int64_t r = gen_next(gen);
+        int i;
+
+        memset(blk, 0, GEN_BLK_SIZE);
+        memcpy(blk, header, sizeof(header));
+
+        /* Manufacturer id is big endian, product code is little endian */
+        blk[8] = mfg_id >> 8;
+        blk[9] = mfg_id & 0xFF;
+        memcpy(&blk[10], &r, 6);
+        blk[16] = gen_range(gen, 1, 52);
+        blk[17] = gen_range(gen, 15, 32);
+        blk[18] = 1;
+        blk[19] = gen_range(gen, 3, 4);
+
+        /* Digital input, 6-16 bpc, random interface */
+        blk[20] = 0x80 | gen_range(gen, 1, 6) << 4 | gen_range(gen, 0, 5);
+        blk[21] = gen_range(gen, 30, 160);
+        blk[22] = blk[21] * 9 / 16;
+        blk[23] = gen_range(gen, 100, 140);
+        /* Preferred timing, continuous frequency, random color formats */
+        blk[24] = 0x02 | gen_range(gen, 0, 3) << 3 | gen_range(gen, 0, 1);
+
+        /* Chromaticity, established timings and standard timings */
+        for (i = 25; i < 38; i++)
+                blk[i] = gen_next(gen) & 0xFF;
+        for (i = 38; i < 54; i += 2) {
+                if (gen_chance(gen, 50)) {
+                        blk[i] = gen_range(gen, 0x31, 0xD1);
+                        blk[i + 1] = gen_range(gen, 0, 3) << 6 | gen_range(gen, 0, 15);
+                } else {
+                        blk[i] = 0x01;
+                        blk[i + 1] = 0x01;
+                }
+        }
+
+        /* First descriptor is always the preferred DTD */
+        gen_dtd(gen, &blk[54]);
+        for (i = 72; i < 126; i += GEN_DTD_SIZE)
+                gen_descriptor(gen, &blk[i]);
+
+        blk[126] = n_ext;
+        gen_checksum(blk);
+}
+
+/*
+ * Data block writers: each one writes a complete data block at p, if it
+ * fits in room bytes, and returns the bytes written (0 if it didn't fit).
+ */
+static int gen_db_audio(struct edid_gen *gen, u_int8_t *p, int room)
+{
+        int n, i;
+
+        if (room < 4)
+                return 0;
+
+        n = gen_range(gen, 1, gen_min(10, (room - 1) / 3));
+        p[0] = GEN_DB_HDR(GEN_DB_AUDIO, n * 3);
+        for (i = 0; i < n; i++) {
+                u_int8_t *sad = &p[1 + i * 3];
+                u_int8_t fmt = gen_chance(gen, 60) ? 1 : gen_range(gen, 2, 14);
+
+                sad[0] = fmt << 3 | gen_range(gen, 1, 7);
+                sad[1] = gen_range(gen, 1, 0x7F);
+                sad[2] = fmt == 1 ? 0x07 : gen_range(gen, 1, 0xFF);
+        }
+
+        return n * 3 + 1;
+}
+
+static int gen_db_video(struct edid_gen *gen, u_int8_t *p, int room)
+{
+        int n, i;
+
+        if (room < 2)
+                return 0;
+
+        n = gen_range(gen, 1, gen_min(31, room - 1));
+        p[0] = GEN_DB_HDR(GEN_DB_VIDEO, n);
+        for (i = 0; i < n; i++)
+                p[1 + i] = gen_vic(gen);
+
+        /* Some VDBs mark a native mode */
+        if (gen_chance(gen, 20)) {
+                i = gen_range(gen, 1, n);
+                p[i] = gen_range(gen, 1, 64) | 0x80;
+        }
+
+        return n + 1;
+}
+
+static int gen_db_hdmi_vsdb(struct edid_gen *gen, u_int8_t *p, int room)
+{
+        int len, i;
+
+        if (room < 6)
+                return 0;
+
+        len = gen_range(gen, 5, gen_min(31, room - 1));
+        p[0] = GEN_DB_HDR(GEN_DB_VENDOR, len);
+        memcpy(&p[1], gen_oui_hdmi, 3);
+        p[4] = 0x10;
+        p[5] = 0x00;
+        for (i = 6; i <= len; i++)
+                p[i] = gen_next(gen) & 0xFF;
+
+        /* Max TMDS clock in 5MHz units */
+        if (len >= 7)
+                p[7] = gen_range(gen, 0x1E, 0x3C);
+
+        return len + 1;
+}
+
+static int gen_db_hf_vsdb(struct edid_gen *gen, u_int8_t *p, int room)
+{
+        int len, i;
+
+        if (room < 8)
+                return 0;
+
+        len = gen_range(gen, 7, gen_min(31, room - 1));
+        p[0] = GEN_DB_HDR(GEN_DB_VENDOR, len);
+        memcpy(&p[1], gen_oui_hdmi_forum, 3);
+        p[4] = 1;
+        p[5] = gen_range(gen, 0, 0x78);
+        for (i = 6; i <= len; i++)
+                p[i] = gen_next(gen) & 0xFF;
+
+        return len + 1;
+}
+
+static int gen_db_speaker(struct edid_gen *gen, u_int8_t *p, int room)
+{
+        if (room < 4)
+                return 0;
+
+        p[0] = GEN_DB_HDR(GEN_DB_SPEAKER, 3);
+        p[1] = gen_range(gen, 1, 0xFF);
+        p[2] = 0;
+        p[3] = 0;
+        return 4;
+}
+
+/* Extended tag blocks count the extended tag byte in their length */
+static int gen_db_vcdb(struct edid_gen *gen, u_int8_t *p, int room)
+{
+        if (room < 3)
+                return 0;
+
+        p[0] = GEN_DB_HDR(GEN_DB_EXTENDED, 2);
+        p[1] = 0;
+        p[2] = gen_next(gen) & 0xFF;
+        return 3;
+}
+
+static int gen_db_vsvdb(struct edid_gen *gen, u_int8_t *p, int room)
+{
+        int len, i;
+
+        if (room < 6)
+                return 0;
+
+        len = gen_range(gen, 5, gen_min(31, room - 1));
+        p[0] = GEN_DB_HDR(GEN_DB_EXTENDED, len);
+        p[1] = 1;
+        memcpy(&p[2], gen_chance(gen, 50) ? gen_oui_dolby : gen_oui_hdr10plus, 3);
+        for (i = 5; i <= len; i++)
+                p[i] = gen_next(gen) & 0xFF;
+
+        return len + 1;
+}
+
+static int gen_db_colorimetry(struct edid_gen *gen, u_int8_t *p, int room)
+{
+        if (room < 4)
+                return 0;
+
+        p[0] = GEN_DB_HDR(GEN_DB_EXTENDED, 3);
+        p[1] = 5;
+        p[2] = gen_next(gen) & 0xFF;
+        p[3] = gen_next(gen) & 0x8F;
+        return 4;
+}
+
+static int gen_db_hdr_static(struct edid_gen *gen, u_int8_t *p, int room)
+{
+        int len, i;
+
+        if (room < 4)
+                return 0;
+
+        len = gen_range(gen, 3, gen_min(6, room - 1));
+        p[0] = GEN_DB_HDR(GEN_DB_EXTENDED, len);
+        p[1] = 6;
+        p[2] = gen_range(gen, 1, 0xF);
+        p[3] = 0x01;
+        for (i = 4; i <= len; i++)
+                p[i] = gen_next(gen) & 0xFF;
+
+        return len + 1;
+}
+
+static int gen_db_hdr_dynamic(struct edid_gen *gen, u_int8_t *p, int room)
+{
+        int len = 1, max;
+
+        if (room < 7)
+                return 0;
+
+        /* One or more (length, type, version) metadata entries */
+        max = gen_min(31, room - 1);
+        p[1] = 7;
+        while (len + 5 <= max) {
+                u_int8_t *md = &p[1 + len];
+                int mdl = gen_range(gen, 3, gen_min(8, max - len - 1));
+                int i;
+
+                md[0] = mdl;
+                md[1] = gen_range(gen, 1, 4);
+                md[2] = 0;
+                for (i = 3; i <= mdl; i++)
+                        md[i] = gen_next(gen) & 0xFF;
+                len += mdl + 1;
+
+                if (gen_chance(gen, 50))
+                        break;
+        }
+
+        p[0] = GEN_DB_HDR(GEN_DB_EXTENDED, len);
+        return len + 1;
+}
+
+static int gen_db_vfpdb(struct edid_gen *gen, u_int8_t *p, int room)
+{
+        int len, i;
+
+        if (room < 3)
+                return 0;
+
+        len = gen_range(gen, 2, gen_min(12, room - 1));
+        p[0] = GEN_DB_HDR(GEN_DB_EXTENDED, len);
+        p[1] = 13;
+        /* SVRs are VICs, or references to DTDs (129-144) */
+        for (i = 2; i <= len; i++)
+                p[i] = gen_chance(gen, 20) ? gen_range(gen, 129, 144) : gen_vic(gen);
+
+        return len + 1;
+}
+
+static int gen_db_420_vdb(struct edid_gen *gen, u_int8_t *p, int room)
+{
+        int len, i;
+
+        if (room < 3)
+                return 0;
+
+        len = gen_range(gen, 2, gen_min(10, room - 1));
+        p[0] = GEN_DB_HDR(GEN_DB_EXTENDED, len);
+        p[1] = 14;
+        for (i = 2; i <= len; i++)
+                p[i] = gen_chance(gen, 70) ? gen_range(gen, 96, 107) : gen_vic(gen);
+
+        return len + 1;
+}
+
+static int gen_db_420_cmdb(struct edid_gen *gen, u_int8_t *p, int room)
+{
+        int len, i;
+
+        if (room < 2)
+                return 0;
+
+        /* Just the extended tag means all the SVDs support 4:2:0 */
+        len = gen_range(gen, 1, gen_min(5, room - 1));
+        p[0] = GEN_DB_HDR(GEN_DB_EXTENDED, len);
+        p[1] = 15;
+        for (i = 2; i <= len; i++)
+                p[i] = gen_next(gen) & 0xFF;
+
+        return len + 1;
+}
+
+static int gen_db_ifdb(struct edid_gen *gen, u_int8_t *p, int room)
+{
+        int len, i;
+
+        if (room < 4)
+                return 0;
+
+        len = gen_range(gen, 3, gen_min(12, room - 1));
+        p[0] = GEN_DB_HDR(GEN_DB_EXTENDED, len);
+        p[1] = 32;
+        /* Header: additional payload length in bits 7:5, and VSIF count */
+        p[2] = gen_range(gen, 0, gen_min(7, len - 3)) << 5;
+        p[3] = gen_range(gen, 0, 2);
+        for (i = 4; i <= len; i++)
+                p[i] = gen_next(gen) & 0xFF;
+
+        return len + 1;
+}
+
+static int (*const gen_db_writers[])(struct edid_gen *, u_int8_t *, int) = {
+        gen_db_audio,
+        gen_db_video,
+        gen_db_video,
+        gen_db_hdmi_vsdb,
+        gen_db_hf_vsdb,
+        gen_db_speaker,
+        gen_db_vcdb,
+        gen_db_vsvdb,
+        gen_db_colorimetry,
+        gen_db_hdr_static,
+        gen_db_hdr_dynamic,
+        gen_db_vfpdb,
+        gen_db_420_vdb,
+        gen_db_420_cmdb,
+        gen_db_ifdb,
+};
+
+/* eeodb is the extension count for a HF-EEODB, 0 for none */
+static void gen_cea_block(struct edid_gen *gen, u_int8_t *cea, u_int8_t eeodb)
+{
+        int n_db = gen_range(gen, 1, 16);
+        int n_dtd = 0;
+        int reserve;
+        int pos = 4;
+        int d;
+
+        memset(cea, 0, GEN_BLK_SIZE);
+        cea[0] = 0x02;
+        cea[1] = 3;
+
+        /* The HF-EEODB must be the first data block */
+        if (eeodb) {
+                cea[pos++] = GEN_DB_HDR(GEN_DB_EXTENDED, 2);
+                cea[pos++] = 0x78;
+                cea[pos++] = eeodb;
+        }
+
+        /* Keep some room for DTDs, or none, to get long data block collections */
+        reserve = gen_range(gen, 0, 3) * GEN_DTD_SIZE;
+        while (n_db--) {
+                int room = GEN_BLK_SIZE - 1 - reserve - pos;
+                int n = gen_db_writers[gen_range(gen, 0,
+                        sizeof(gen_db_writers) / sizeof(gen_db_writers[0]) - 1)](gen, &cea[pos], room);
+
+                pos += n;
+        }
+
+        d = pos;
+        cea[2] = d;
+        for (pos = d; pos + GEN_DTD_SIZE <= GEN_BLK_SIZE - 1 && gen_chance(gen, 70);
+                        pos += GEN_DTD_SIZE) {
+                gen_dtd(gen, &cea[pos]);
+                n_dtd++;
+        }
+
+        /* Underscan, audio, 4:4:4, 4:2:2 and the native DTD count */
+        cea[3] = gen_range(gen, 0, 15) << 4 | gen_range(gen, 0, n_dtd);
+        gen_checksum(cea);
+}
+
+/* DisplayID sections: header, data blocks, padding, section checksum */
+#define GEN_DID_HDR_SIZE 5
+#define GEN_DID_MAX_SECTION (GEN_BLK_SIZE - GEN_DID_HDR_SIZE - 2)
+
+static void gen_did_checksum(u_int8_t *blk)
+{
+        u_int8_t sum = 0;
+        int i;
+
+        if (blk[2] > GEN_DID_MAX_SECTION)
+                return;
+
+        for (i = 1; i < GEN_DID_HDR_SIZE + blk[2]; i++)
+                sum += blk[i];
+
+        blk[GEN_DID_HDR_SIZE + blk[2]] = (u_int8_t)(0x100 - sum);
+}
+
+/* Type I (DisplayID 1.x) or VII (2.0) detailed timings */
+static int gen_did_detailed(struct edid_gen *gen, u_int8_t *p, int room, bool v2)
+{
+        int n;
+        int i;
+
+        if (room < 23)
+                return 0;
+
+        n = gen_min(gen_range(gen, 1, 2), (room - 3) / 20);
+
+        p[0] = v2 ? 0x22 : 0x03;
+        p[1] = 0;
+        p[2] = n * 20;
+        for (i = 0; i < n; i++) {
+                const struct gen_timing *t = &gen_timings[gen_range(gen, 0,
+                        sizeof(gen_timings) / sizeof(gen_timings[0]) - 1)];
+                u_int32_t clock = (v2 ? t->clock_khz : t->clock_khz / 10) - 1;
+                u_int16_t v[8] = { t->hactive, t->hblank, t->hfrontp, t->hsync,
+                        t->vactive, t->vblank, t->vfrontp, t->vsync };
+                u_int8_t *d = &p[3 + i * 20];
+                int k;
+
+                d[0] = clock & 0xFF;
+                d[1] = (clock >> 8) & 0xFF;
+                d[2] = clock >> 16;
+                /* Preferred, 16:9 */
+                d[3] = (i ? 0 : 0x80) | 0x04;
+                for (k = 0; k < 8; k++) {
+                        d[4 + k * 2] = (v[k] - 1) & 0xFF;
+                        d[5 + k * 2] = (v[k] - 1) >> 8;
+                }
+                /* Positive syncs */
+                d[9] |= 0x80;
+                d[17] |= 0x80;
+        }
+
+        return n * 20 + 3;
+}
+
+static int gen_did_formula(struct edid_gen *gen, u_int8_t *p, int room, bool v2)
+{
+        int size = v2 ? 6 : 3;
+        int n;
+        int i;
+
+        if (room < 3 + size)
+                return 0;
+
+        n = gen_min(gen_range(gen, 1, 4), (room - 3) / size);
+
+        p[0] = v2 ? 0x24 : 0x05;
+        p[1] = 0;
+        p[2] = n * size;
+        for (i = 0; i < n; i++) {
+                u_int8_t *d = &p[3 + i * size];
+                u_int16_t h = gen_range(gen, 80, 480) * 8;
+
+                if (v2) {
+                        u_int16_t v = h * 9 / 16;
+
+                        d[0] = gen_range(gen, 0, 2) | (gen_chance(gen, 20) ? 0x10 : 0);
+                        d[1] = (h - 1) & 0xFF;
+                        d[2] = (h - 1) >> 8;
+                        d[3] = (v - 1) & 0xFF;
+                        d[4] = (v - 1) >> 8;
+                        d[5] = gen_range(gen, 23, 143);
+                } else {
+                        d[0] = gen_range(gen, 0, 1) << 4 | gen_range(gen, 0, 7);
+                        d[1] = h / 8 - 1;
+                        d[2] = gen_range(gen, 23, 119);
+                }
+        }
+
+        return n * size + 3;
+}
+
+/* Type IV / VIII codes: DMT IDs, VICs or HDMI VICs */
+static int gen_did_codes(struct edid_gen *gen, u_int8_t *p, int room, bool v2)
+{
+        int type = gen_range(gen, 0, 2);
+        int n;
+        int i;
+
+        if (room < 4)
+                return 0;
+
+        n = gen_min(gen_range(gen, 1, 12), room - 3);
+
+        p[0] = v2 ? 0x23 : 0x06;
+        p[1] = type << 6;
+        p[2] = n;
+        for (i = 0; i < n; i++) {
+                if (type == 0)
+                        p[3 + i] = gen_range(gen, 1, 0x58);
+                else if (type == 1)
+                        p[3 + i] = gen_vic(gen);
+                else
+                        p[3 + i] = gen_range(gen, 1, 4);
+        }
+
+        return n + 3;
+}
+
+/* DMT (0x07) or VIC (0x08) bitmaps */
+static int gen_did_bitmap(struct edid_gen *gen, u_int8_t *p, int room)
+{
+        bool vics = gen_chance(gen, 50);
+        int n;
+        int i;
+
+        if (room < 4)
+                return 0;
+
+        n = gen_min(vics ? 8 : 10, room - 3);
+
+        p[0] = vics ? 0x08 : 0x07;
+        p[1] = 0;
+        p[2] = n;
+        for (i = 0; i < n; i++)
+                p[3 + i] = gen_chance(gen, 50) ? gen_range(gen, 0, 0xFF) : 0;
+
+        return n + 3;
+}
+
+static int gen_did_range(struct edid_gen *gen, u_int8_t *p, int room, bool v2)
+{
+        u_int32_t max_khz = gen_range(gen, 150000, 1200000);
+        u_int32_t min_khz = 25000;
+        int len = v2 ? 9 : 15;
+
+        if (room < len + 3)
+                return 0;
+
+        memset(p, 0, len + 3);
+        p[0] = v2 ? 0x25 : 0x09;
+        p[1] = v2;
+        p[2] = len;
+        if (!v2) {
+                min_khz /= 10;
+                max_khz /= 10;
+        }
+        p[3] = (min_khz - 1) & 0xFF;
+        p[4] = ((min_khz - 1) >> 8) & 0xFF;
+        p[5] = (min_khz - 1) >> 16;
+        p[6] = (max_khz - 1) & 0xFF;
+        p[7] = ((max_khz - 1) >> 8) & 0xFF;
+        p[8] = (max_khz - 1) >> 16;
+        if (v2) {
+                p[9] = gen_range(gen, 24, 48);
+                p[10] = gen_range(gen, 60, 240);
+                p[11] = gen_chance(gen, 50) ? 0x80 : 0;
+        } else {
+                p[13] = gen_range(gen, 24, 48);
+                p[14] = gen_range(gen, 60, 240);
+                p[17] = gen_chance(gen, 50) ? 0x10 : 0;
+        }
+
+        return len + 3;
+}
+
+static int gen_did_tile(struct edid_gen *gen, u_int8_t *p, int room, bool v2)
+{
+        u_int8_t n_h = gen_range(gen, 1, 4), n_v = gen_range(gen, 1, 2);
+        u_int16_t w = 1920, h = 2160;
+
+        if (room < 25)
+                return 0;
+
+        memset(p, 0, 25);
+        p[0] = v2 ? 0x28 : 0x12;
+        p[2] = 22;
+        p[3] = gen_chance(gen, 50) ? 0x80 : 0;
+        p[4] = (n_h - 1) << 4 | (n_v - 1);
+        p[5] = gen_range(gen, 0, n_h - 1) << 4 | gen_range(gen, 0, n_v - 1);
+        p[7] = (w - 1) & 0xFF;
+        p[8] = (w - 1) >> 8;
+        p[9] = (h - 1) & 0xFF;
+        p[10] = (h - 1) >> 8;
+        p[11] = 10;
+        p[12] = p[13] = p[14] = p[15] = gen_range(gen, 0, 40);
+        memcpy(&p[16], "GSM", 3);
+        p[19] = gen_range(gen, 0, 0xFF);
+        p[21] = gen_range(gen, 0, 0xFF);
+
+        return 25;
+}
+
+/* CTA-861 data blocks, carried by a DisplayID data block */
+static int gen_did_cta(struct edid_gen *gen, u_int8_t *p, int room)
+{
+        int pos = 3;
+        int n_db = gen_range(gen, 1, 4);
+
+        if (room < 8)
+                return 0;
+
+        room = gen_min(room, 3 + 0xFF);
+        while (n_db--) {
+                int n = gen_db_writers[gen_range(gen, 0,
+                        sizeof(gen_db_writers) / sizeof(gen_db_writers[0]) - 1)](gen, &p[pos],
+                        room - pos);
+
+                pos += n;
+        }
+
+        if (pos == 3)
+                return 0;
+
+        p[0] = 0x81;
+        p[1] = 0;
+        p[2] = pos - 3;
+        return pos;
+}
+
+static void gen_displayid_block(struct edid_gen *gen, u_int8_t *blk)
+{
+        bool v2 = gen_chance(gen, 50);
+        int n_db = gen_range(gen, 1, 6);
+        int pos = GEN_DID_HDR_SIZE;
+        int end = GEN_DID_HDR_SIZE + GEN_DID_MAX_SECTION;
+
+        memset(blk, 0, GEN_BLK_SIZE);
+        blk[0] = 0x70;
+        blk[1] = v2 ? 0x20 : 0x12;
+        blk[3] = v2 ? gen_range(gen, 0, 8) : gen_range(gen, 0, 6);
+
+        while (n_db--) {
+                int room = end - pos;
+
+                switch (gen_range(gen, 0, 6)) {
+                case 0:
+                        pos += gen_did_detailed(gen, &blk[pos], room, v2);
+                        break;
+                case 1:
+                        pos += gen_did_formula(gen, &blk[pos], room, v2);
+                        break;
+                case 2:
+                        pos += gen_did_codes(gen, &blk[pos], room, v2);
+                        break;
+                case 3:
+                        pos += gen_did_bitmap(gen, &blk[pos], room);
+                        break;
+                case 4:
+                        pos += gen_did_range(gen, &blk[pos], room, v2);
+                        break;
+                case 5:
+                        pos += gen_did_tile(gen, &blk[pos], room, v2);
+                        break;
+                default:
+                        pos += gen_did_cta(gen, &blk[pos], room);
+                        break;
+                }
+        }
+
+        /* Some sections are zero padded up to their full size */
+        blk[2] = gen_chance(gen, 30) ? GEN_DID_MAX_SECTION : pos - GEN_DID_HDR_SIZE;
+        gen_did_checksum(blk);
+        gen_checksum(blk);
+}
+
+/* Break the blob in one or more ways, returns the new blob length */
+static size_t gen_malform(struct edid_gen *gen, u_int8_t *buf, size_t len)
+{
+        int n_blks = len / GEN_BLK_SIZE;
+        int n = gen_range(gen, 1, 3);
+        bool fix_checksum = true;
+
+        while (n--) {
+                int blk = gen_range(gen, 0, n_blks - 1);
+                u_int8_t *b = &buf[blk * GEN_BLK_SIZE];
+                u_int8_t *cea = &buf[gen_range(gen, 1, n_blks - 1) * GEN_BLK_SIZE];
+                int i;
+
+                switch (gen_range(gen, 0, 10)) {
+                case 0:
+                        /* Random byte flips */
+                        for (i = gen_range(gen, 1, 8); i; i--)
+                                b[gen_range(gen, 0, GEN_BLK_SIZE - 2)] ^= 1 << gen_range(gen, 0, 7);
+                        break;
+
+                case 1:
+                        buf[gen_range(gen, 0, 7)] ^= 0xFF;
+                        break;
+
+                case 2:
+                        b[GEN_BLK_SIZE - 1]++;
+                        fix_checksum = false;
+                        break;
+
+                case 3:
+                        /* DTD offset past the end of the block */
+                        cea[2] = gen_range(gen, GEN_BLK_SIZE - 1, 0xFF);
+                        break;
+
+                case 4:
+                        /* DTD offset which is not at a data block boundary */
+                        cea[2] = gen_range(gen, 0, GEN_BLK_SIZE - 2);
+                        break;
+
+                case 5:
+                        /* Data block which runs past d */
+                        if (cea[2] > 4)
+                                cea[4] |= 0x1F;
+                        break;
+
+                case 6:
+                        /* Extended tag block without an extended tag */
+                        cea[4] = GEN_DB_HDR(GEN_DB_EXTENDED, 0);
+                        break;
+
+                case 7:
+                        /* Too many native DTDs */
+                        cea[3] |= 0x0F;
+                        break;
+
+                case 8:
+                        /* Not a CEA extension */
+                        cea[0] = gen_chance(gen, 50) ? 0x70 : 0xF0;
+                        break;
+
+                case 9:
+                        /* Claim more extensions than there are */
+                        buf[126] += gen_range(gen, 1, 4);
+                        break;
+
+                default:
+                        /* Truncated */
+                        len = gen_range(gen, 1, len - 1);
+                        break;
+                }
+        }
+
+        /* Keep checksums valid, so that the breakage isn't caught early */
+        if (fix_checksum) {
+                int blk;
+
+                for (blk = 0; blk < n_blks; blk++) {
+                        if (blk && buf[blk * GEN_BLK_SIZE] == 0x70)
+                                gen_did_checksum(&buf[blk * GEN_BLK_SIZE]);
+                        gen_checksum(&buf[blk * GEN_BLK_SIZE]);
+                }
+        }
+
+        return len;
+}
+
+void edid_gen_seed(struct edid_gen *gen, u_int64_t seed)
+{
+        gen->state = seed;
+}
+
+size_t edid_gen_blob(struct edid_gen *gen, u_int32_t flags, u_int8_t *buf)
+{
+        u_int8_t n_ext = flags & EDID_GEN_MAX_BLKS ? EDID_GEN_MAX_EXT_BLKS :
+                gen_range(gen, 1, gen_chance(gen, 75) ? 3 : EDID_GEN_MAX_EXT_BLKS);
+        size_t len = (n_ext + 1) * GEN_BLK_SIZE;
+        bool eeodb, block_map;
+        int blk;
+
+        /* Past the count of the base block with a HF-EEODB, or with a block map */
+        eeodb = n_ext > 1 && gen_chance(gen, 10);
+        block_map = !eeodb && n_ext > 1 && gen_chance(gen, 10);
+
+        gen_base_block(gen, buf, eeodb ? 1 : n_ext);
+        for (blk = 1; blk <= n_ext; blk++) {
+                u_int8_t *b = &buf[blk * GEN_BLK_SIZE];
+
+                if (blk == 1 && eeodb)
+                        gen_cea_block(gen, b, n_ext);
+                else if (gen_chance(gen, 15))
+                        gen_displayid_block(gen, b);
+                else
+                        gen_cea_block(gen, b, 0);
+        }
+
+        if (block_map) {
+                memset(buf + GEN_BLK_SIZE, 0, GEN_BLK_SIZE);
+                buf[GEN_BLK_SIZE] = 0xF0;
+                for (blk = 2; blk <= n_ext; blk++)
+                        buf[GEN_BLK_SIZE + blk - 1] = buf[blk * GEN_BLK_SIZE];
+                gen_checksum(buf + GEN_BLK_SIZE);
+        }
+
+        if (flags & EDID_GEN_MALFORMED)
+                len = gen_malform(gen, buf, len);
+
+        return len;
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2022 Shashank Sharma (contactshashanksharma@gmail.com)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sub license,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the
+ * next paragraph) shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Synthetic EDID generator, used by the benchmarks and the fuzz target.
+ * This is test tooling, and is not a part of libedid.so.
+ *
+ * The output only depends on the seed, so any blob can be reproduced
+ * from the seed it was generated with.
+ */
+
+#ifndef EDID_GEN_H
+#define EDID_GEN_H
+#include <sys/types.h>
+#include <stddef.h>
+
+/* Base block + up to 7 CEA (or DisplayID) extension blocks */
+#define EDID_GEN_MAX_EXT_BLKS 7
+#define EDID_GEN_MAX_SIZE ((EDID_GEN_MAX_EXT_BLKS + 1) * 128)
+
+enum edid_gen_flags {
+        /* Deliberately break the blob after generating it */
+        EDID_GEN_MALFORMED = 1 << 0,
+        /* Always use EDID_GEN_MAX_EXT_BLKS extension blocks */
+        EDID_GEN_MAX_BLKS = 1 << 1,
+};
+
+struct edid_gen {
+        u_int64_t state;
+};
+
+/* (Re)start the generator from this seed */
+void edid_gen_seed(struct edid_gen *gen, u_int64_t seed);
+
+/*
+ * Generate one EDID into buf, which must have room for EDID_GEN_MAX_SIZE
+ * bytes. Returns the number of valid bytes in buf. A malformed blob can be
+ * shorter than what its extension count claims.
+ */
+size_t edid_gen_blob(struct edid_gen *gen, u_int32_t flags, u_int8_t *buf);
+
+#endif
@@ -0,0 +1,399 @@
+/*
+ * Copyright (c) 2022 Shashank Sharma (contactshashanksharma@gmail.com)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sub license,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the
+ * next paragraph) shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * CTA-861 video format (VIC) timings.
+ *
+ * One entry per VIC, indexed by the VIC itself, so a lookup is a single
+ * load. The entries are written as modelines (active, sync start, sync
+ * end, total), and EDID_VIC() turns them into blanking, porches and sync
+ * widths, the pixel clock and refresh rate of the fractional (1/1.001)
+ * variant, and the refresh rates, all at build time.
+ *
+ * Pixel repeated VICs are listed with the repeated pixels (1440 wide
+ * at 27 MHz for 480i), which is what a sink actually receives.
+ */
+
+#include <stddef.h>
+#include <sys/types.h>
+
+#include "libedid.h"
+
+#define VIC_FIELDS(fl) (((fl) & EDID_VIC_INTERLACED) ? 2 : 1)
+#define VIC_TOTAL(ht, vt) ((u_int64_t)(ht) * (vt))
+
+/* Refresh rate in mHz, rounded, of a pixel clock in Hz */
+#define VIC_REFRESH_MHZ(clk_hz, ht, vt, fl) \
+        (u_int32_t)(((clk_hz) * 1000 * VIC_FIELDS(fl) + VIC_TOTAL(ht, vt) / 2) / \
+                VIC_TOTAL(ht, vt))
+
+/* Pixel clock in Hz of the fractional variant of a clock in kHz */
+#define VIC_FRAC_CLOCK_HZ(clk) ((u_int64_t)(clk) * 1000000 / 1001)
+
+#define EDID_VIC(clk, ha, hss, hse, ht, va, vss, vse, vt, fl, ar) { \
+        .pixel_clock_khz = (clk), \
+        .refresh_mhz = VIC_REFRESH_MHZ((u_int64_t)(clk) * 1000, ht, vt, fl), \
+        .frac_pixel_clock_khz = ((fl) & EDID_VIC_FRACTIONAL) ? \
+                (u_int32_t)((VIC_FRAC_CLOCK_HZ(clk) + 500) / 1000) : 0, \
+        .frac_refresh_mhz = ((fl) & EDID_VIC_FRACTIONAL) ? \
+                VIC_REFRESH_MHZ(VIC_FRAC_CLOCK_HZ(clk), ht, vt, fl) : 0, \
+        .hactive = (ha), \
+        .hfrontp = (hss) - (ha), \
+        .hsync = (hse) - (hss), \
+        .hblank = (ht) - (ha), \
+        .vactive = (va) / VIC_FIELDS(fl), \
+        .vfrontp = ((vss) - (va)) / VIC_FIELDS(fl), \
+        .vsync = ((vse) - (vss)) / VIC_FIELDS(fl), \
+        .vblank = ((vt) - (va)) / VIC_FIELDS(fl), \
+        .flags = (fl), \
+        .aspect = (ar), \
+}
+
+/* Short names for the table below: sync polarities (+hsync+vsync,
+ * +hsync-vsync, -hsync-vsync), interlaced, pixel repeated, fractional
+ */
+#define PP (EDID_VIC_HSYNC_POS | EDID_VIC_VSYNC_POS)
+#define PN EDID_VIC_HSYNC_POS
+#define NN 0
+#define IL EDID_VIC_INTERLACED
+#define PR EDID_VIC_PIXEL_REPEAT
+#define FR EDID_VIC_FRACTIONAL
+
+/* VICs 0, 128-192 and 220-255 are reserved, and left zeroed */
+static const struct edid_vic_timing edid_vic_timings[256] = {
+        [1] = EDID_VIC(25200, 640, 656, 752, 800, 480, 490, 492, 525,
+                        NN | FR, EDID_ASPECT_4_3),
+        [2] = EDID_VIC(27027, 720, 736, 798, 858, 480, 489, 495, 525,
+                        NN | FR, EDID_ASPECT_4_3),
+        [3] = EDID_VIC(27027, 720, 736, 798, 858, 480, 489, 495, 525,
+                        NN | FR, EDID_ASPECT_16_9),
+        [4] = EDID_VIC(74250, 1280, 1390, 1430, 1650, 720, 725, 730, 750,
+                        PP | FR, EDID_ASPECT_16_9),
+        [5] = EDID_VIC(74250, 1920, 2008, 2052, 2200, 1080, 1084, 1094, 1125,
+                        IL | PP | FR, EDID_ASPECT_16_9),
+        [6] = EDID_VIC(27027, 1440, 1478, 1602, 1716, 480, 488, 494, 525,
+                        IL | PR | NN | FR, EDID_ASPECT_4_3),
+        [7] = EDID_VIC(27027, 1440, 1478, 1602, 1716, 480, 488, 494, 525,
+                        IL | PR | NN | FR, EDID_ASPECT_16_9),
+        [8] = EDID_VIC(27000, 1440, 1478, 1602, 1716, 240, 244, 247, 262,
+                        PR | NN | FR, EDID_ASPECT_4_3),
+        [9] = EDID_VIC(27000, 1440, 1478, 1602, 1716, 240, 244, 247, 262,
+                        PR | NN | FR, EDID_ASPECT_16_9),
+        [10] = EDID_VIC(54054, 2880, 2956, 3204, 3432, 480, 488, 494, 525,
+                        IL | NN | FR, EDID_ASPECT_4_3),
+        [11] = EDID_VIC(54054, 2880, 2956, 3204, 3432, 480, 488, 494, 525,
+                        IL | NN | FR, EDID_ASPECT_16_9),
+        [12] = EDID_VIC(54000, 2880, 2956, 3204, 3432, 240, 244, 247, 262,
+                        NN | FR, EDID_ASPECT_4_3),
+        [13] = EDID_VIC(54000, 2880, 2956, 3204, 3432, 240, 244, 247, 262,
+                        NN | FR, EDID_ASPECT_16_9),
+        [14] = EDID_VIC(54054, 1440, 1472, 1596, 1716, 480, 489, 495, 525,
+                        NN | FR, EDID_ASPECT_4_3),
+        [15] = EDID_VIC(54054, 1440, 1472, 1596, 1716, 480, 489, 495, 525,
+                        NN | FR, EDID_ASPECT_16_9),
+        [16] = EDID_VIC(148500, 1920, 2008, 2052, 2200, 1080, 1084, 1089, 1125,
+                        PP | FR, EDID_ASPECT_16_9),
+        [17] = EDID_VIC(27000, 720, 732, 796, 864, 576, 581, 586, 625,
+                        NN, EDID_ASPECT_4_3),
+        [18] = EDID_VIC(27000, 720, 732, 796, 864, 576, 581, 586, 625,
+                        NN, EDID_ASPECT_16_9),
+        [19] = EDID_VIC(74250, 1280, 1720, 1760, 1980, 720, 725, 730, 750,
+                        PP, EDID_ASPECT_16_9),
+        [20] = EDID_VIC(74250, 1920, 2448, 2492, 2640, 1080, 1084, 1094, 1125,
+                        IL | PP, EDID_ASPECT_16_9),
+        [21] = EDID_VIC(27000, 1440, 1464, 1590, 1728, 576, 580, 586, 625,
+                        IL | PR | NN, EDID_ASPECT_4_3),
+        [22] = EDID_VIC(27000, 1440, 1464, 1590, 1728, 576, 580, 586, 625,
+                        IL | PR | NN, EDID_ASPECT_16_9),
+        [23] = EDID_VIC(27000, 1440, 1464, 1590, 1728, 288, 290, 293, 312,
+                        PR | NN, EDID_ASPECT_4_3),
+        [24] = EDID_VIC(27000, 1440, 1464, 1590, 1728, 288, 290, 293, 312,
+                        PR | NN, EDID_ASPECT_16_9),
+        [25] = EDID_VIC(54000, 2880, 2928, 3180, 3456, 576, 580, 586, 625,
+                        IL | NN, EDID_ASPECT_4_3),
+        [26] = EDID_VIC(54000, 2880, 2928, 3180, 3456, 576, 580, 586, 625,
+                        IL | NN, EDID_ASPECT_16_9),
+        [27] = EDID_VIC(54000, 2880, 2928, 3180, 3456, 288, 290, 293, 312,
+                        NN, EDID_ASPECT_4_3),
+        [28] = EDID_VIC(54000, 2880, 2928, 3180, 3456, 288, 290, 293, 312,
+                        NN, EDID_ASPECT_16_9),
+        [29] = EDID_VIC(54000, 1440, 1464, 1592, 1728, 576, 581, 586, 625,
+                        NN, EDID_ASPECT_4_3),
+        [30] = EDID_VIC(54000, 1440, 1464, 1592, 1728, 576, 581, 586, 625,
+                        NN, EDID_ASPECT_16_9),
+        [31] = EDID_VIC(148500, 1920, 2448, 2492, 2640, 1080, 1084, 1089, 1125,
+                        PP, EDID_ASPECT_16_9),
+        [32] = EDID_VIC(74250, 1920, 2558, 2602, 2750, 1080, 1084, 1089, 1125,
+                        PP | FR, EDID_ASPECT_16_9),
+        [33] = EDID_VIC(74250, 1920, 2448, 2492, 2640, 1080, 1084, 1089, 1125,
+                        PP, EDID_ASPECT_16_9),
+        [34] = EDID_VIC(74250, 1920, 2008, 2052, 2200, 1080, 1084, 1089, 1125,
+                        PP | FR, EDID_ASPECT_16_9),
+        [35] = EDID_VIC(108108, 2880, 2944, 3192, 3432, 480, 489, 495, 525,
+                        NN | FR, EDID_ASPECT_4_3),
+        [36] = EDID_VIC(108108, 2880, 2944, 3192, 3432, 480, 489, 495, 525,
+                        NN | FR, EDID_ASPECT_16_9),
+        [37] = EDID_VIC(108000, 2880, 2928, 3184, 3456, 576, 581, 586, 625,
+                        NN, EDID_ASPECT_4_3),
+        [38] = EDID_VIC(108000, 2880, 2928, 3184, 3456, 576, 581, 586, 625,
+                        NN, EDID_ASPECT_16_9),
+        [39] = EDID_VIC(72000, 1920, 1952, 2120, 2304, 1080, 1126, 1136, 1250,
+                        IL | PN, EDID_ASPECT_16_9),
+        [40] = EDID_VIC(148500, 1920, 2448, 2492, 2640, 1080, 1084, 1094, 1125,
+                        IL | PP, EDID_ASPECT_16_9),
+        [41] = EDID_VIC(148500, 1280, 1720, 1760, 1980, 720, 725, 730, 750,
+                        PP, EDID_ASPECT_16_9),
+        [42] = EDID_VIC(54000, 720, 732, 796, 864, 576, 581, 586, 625,
+                        NN, EDID_ASPECT_4_3),
+        [43] = EDID_VIC(54000, 720, 732, 796, 864, 576, 581, 586, 625,
+                        NN, EDID_ASPECT_16_9),
+        [44] = EDID_VIC(54000, 1440, 1464, 1590, 1728, 576, 580, 586, 625,
+                        IL | PR | NN, EDID_ASPECT_4_3),
+        [45] = EDID_VIC(54000, 1440, 1464, 1590, 1728, 576, 580, 586, 625,
+                        IL | PR | NN, EDID_ASPECT_16_9),
+        [46] = EDID_VIC(148500, 1920, 2008, 2052, 2200, 1080, 1084, 1094, 1125,
+                        IL | PP | FR, EDID_ASPECT_16_9),
+        [47] = EDID_VIC(148500, 1280, 1390, 1430, 1650, 720, 725, 730, 750,
+                        PP | FR, EDID_ASPECT_16_9),
+        [48] = EDID_VIC(54054, 720, 736, 798, 858, 480, 489, 495, 525,
+                        NN | FR, EDID_ASPECT_4_3),
+        [49] = EDID_VIC(54054, 720, 736, 798, 858, 480, 489, 495, 525,
+                        NN | FR, EDID_ASPECT_16_9),
+        [50] = EDID_VIC(54054, 1440, 1478, 1602, 1716, 480, 488, 494, 525,
+                        IL | PR | NN | FR, EDID_ASPECT_4_3),
+        [51] = EDID_VIC(54054, 1440, 1478, 1602, 1716, 480, 488, 494, 525,
+                        IL | PR | NN | FR, EDID_ASPECT_16_9),
+        [52] = EDID_VIC(108000, 720, 732, 796, 864, 576, 581, 586, 625,
+                        NN, EDID_ASPECT_4_3),
+        [53] = EDID_VIC(108000, 720, 732, 796, 864, 576, 581, 586, 625,
+                        NN, EDID_ASPECT_16_9),
+        [54] = EDID_VIC(108000, 1440, 1464, 1590, 1728, 576, 580, 586, 625,
+                        IL | PR | NN, EDID_ASPECT_4_3),
+        [55] = EDID_VIC(108000, 1440, 1464, 1590, 1728, 576, 580, 586, 625,
+                        IL | PR | NN, EDID_ASPECT_16_9),
+        [56] = EDID_VIC(108108, 720, 736, 798, 858, 480, 489, 495, 525,
+                        NN | FR, EDID_ASPECT_4_3),
+        [57] = EDID_VIC(108108, 720, 736, 798, 858, 480, 489, 495, 525,
+                        NN | FR, EDID_ASPECT_16_9),
+        [58] = EDID_VIC(108108, 1440, 1478, 1602, 1716, 480, 488, 494, 525,
+                        IL | PR | NN | FR, EDID_ASPECT_4_3),
+        [59] = EDID_VIC(108108, 1440, 1478, 1602, 1716, 480, 488, 494, 525,
+                        IL | PR | NN | FR, EDID_ASPECT_16_9),
+        [60] = EDID_VIC(59400, 1280, 3040, 3080, 3300, 720, 725, 730, 750,
+                        PP | FR, EDID_ASPECT_16_9),
+        [61] = EDID_VIC(74250, 1280, 3700, 3740, 3960, 720, 725, 730, 750,
+                        PP, EDID_ASPECT_16_9),
+        [62] = EDID_VIC(74250, 1280, 3040, 3080, 3300, 720, 725, 730, 750,
+                        PP | FR, EDID_ASPECT_16_9),
+        [63] = EDID_VIC(297000, 1920, 2008, 2052, 2200, 1080, 1084, 1089, 1125,
+                        PP | FR, EDID_ASPECT_16_9),
+        [64] = EDID_VIC(297000, 1920, 2448, 2492, 2640, 1080, 1084, 1089, 1125,
+                        PP, EDID_ASPECT_16_9),
+        [65] = EDID_VIC(59400, 1280, 3040, 3080, 3300, 720, 725, 730, 750,
+                        PP | FR, EDID_ASPECT_64_27),
+        [66] = EDID_VIC(74250, 1280, 3700, 3740, 3960, 720, 725, 730, 750,
+                        PP, EDID_ASPECT_64_27),
+        [67] = EDID_VIC(74250, 1280, 3040, 3080, 3300, 720, 725, 730, 750,
+                        PP | FR, EDID_ASPECT_64_27),
+        [68] = EDID_VIC(74250, 1280, 1720, 1760, 1980, 720, 725, 730, 750,
+                        PP, EDID_ASPECT_64_27),
+        [69] = EDID_VIC(74250, 1280, 1390, 1430, 1650, 720, 725, 730, 750,
+                        PP | FR, EDID_ASPECT_64_27),
+        [70] = EDID_VIC(148500, 1280, 1720, 1760, 1980, 720, 725, 730, 750,
+                        PP, EDID_ASPECT_64_27),
+        [71] = EDID_VIC(148500, 1280, 1390, 1430, 1650, 720, 725, 730, 750,
+                        PP | FR, EDID_ASPECT_64_27),
+        [72] = EDID_VIC(74250, 1920, 2558, 2602, 2750, 1080, 1084, 1089, 1125,
+                        PP | FR, EDID_ASPECT_64_27),
+        [73] = EDID_VIC(74250, 1920, 2448, 2492, 2640, 1080, 1084, 1089, 1125,
+                        PP, EDID_ASPECT_64_27),
+        [74] = EDID_VIC(74250, 1920, 2008, 2052, 2200, 1080, 1084, 1089, 1125,
+                        PP | FR, EDID_ASPECT_64_27),
+        [75] = EDID_VIC(148500, 1920, 2448, 2492, 2640, 1080, 1084, 1089, 1125,
+                        PP, EDID_ASPECT_64_27),
+        [76] = EDID_VIC(148500, 1920, 2008, 2052, 2200, 1080, 1084, 1089, 1125,
+                        PP | FR, EDID_ASPECT_64_27),
+        [77] = EDID_VIC(297000, 1920, 2448, 2492, 2640, 1080, 1084, 1089, 1125,
+                        PP, EDID_ASPECT_64_27),
+        [78] = EDID_VIC(297000, 1920, 2008, 2052, 2200, 1080, 1084, 1089, 1125,
+                        PP | FR, EDID_ASPECT_64_27),
+        [79] = EDID_VIC(59400, 1680, 3040, 3080, 3300, 720, 725, 730, 750,
+                        PP | FR, EDID_ASPECT_64_27),
+        [80] = EDID_VIC(59400, 1680, 2908, 2948, 3168, 720, 725, 730, 750,
+                        PP, EDID_ASPECT_64_27),
+        [81] = EDID_VIC(59400, 1680, 2380, 2420, 2640, 720, 725, 730, 750,
+                        PP | FR, EDID_ASPECT_64_27),
+        [82] = EDID_VIC(82500, 1680, 1940, 1980, 2200, 720, 725, 730, 750,
+                        PP, EDID_ASPECT_64_27),
+        [83] = EDID_VIC(99000, 1680, 1940, 1980, 2200, 720, 725, 730, 750,
+                        PP | FR, EDID_ASPECT_64_27),
+        [84] = EDID_VIC(165000, 1680, 1740, 1780, 2000, 720, 725, 730, 825,
+                        PP, EDID_ASPECT_64_27),
+        [85] = EDID_VIC(198000, 1680, 1740, 1780, 2000, 720, 725, 730, 825,
+                        PP | FR, EDID_ASPECT_64_27),
+        [86] = EDID_VIC(99000, 2560, 3558, 3602, 3750, 1080, 1084, 1089, 1100,
+                        PP | FR, EDID_ASPECT_64_27),
+        [87] = EDID_VIC(90000, 2560, 3008, 3052, 3200, 1080, 1084, 1089, 1125,
+                        PP, EDID_ASPECT_64_27),
+        [88] = EDID_VIC(118800, 2560, 3328, 3372, 3520, 1080, 1084, 1089, 1125,
+                        PP | FR, EDID_ASPECT_64_27),
+        [89] = EDID_VIC(185625, 2560, 3108, 3152, 3300, 1080, 1084, 1089, 1125,
+                        PP, EDID_ASPECT_64_27),
+        [90] = EDID_VIC(198000, 2560, 2808, 2852, 3000, 1080, 1084, 1089, 1100,
+                        PP | FR, EDID_ASPECT_64_27),
+        [91] = EDID_VIC(371250, 2560, 2778, 2822, 2970, 1080, 1084, 1089, 1250,
+                        PP, EDID_ASPECT_64_27),
+        [92] = EDID_VIC(495000, 2560, 3108, 3152, 3300, 1080, 1084, 1089, 1250,
+                        PP | FR, EDID_ASPECT_64_27),
+        [93] = EDID_VIC(297000, 3840, 5116, 5204, 5500, 2160, 2168, 2178, 2250,
+                        PP | FR, EDID_ASPECT_16_9),
+        [94] = EDID_VIC(297000, 3840, 4896, 4984, 5280, 2160, 2168, 2178, 2250,
+                        PP, EDID_ASPECT_16_9),
+        [95] = EDID_VIC(297000, 3840, 4016, 4104, 4400, 2160, 2168, 2178, 2250,
+                        PP | FR, EDID_ASPECT_16_9),
+        [96] = EDID_VIC(594000, 3840, 4896, 4984, 5280, 2160, 2168, 2178, 2250,
+                        PP, EDID_ASPECT_16_9),
+        [97] = EDID_VIC(594000, 3840, 4016, 4104, 4400, 2160, 2168, 2178, 2250,
+                        PP | FR, EDID_ASPECT_16_9),
+        [98] = EDID_VIC(297000, 4096, 5116, 5204, 5500, 2160, 2168, 2178, 2250,
+                        PP | FR, EDID_ASPECT_256_135),
+        [99] = EDID_VIC(297000, 4096, 5064, 5152, 5280, 2160, 2168, 2178, 2250,
+                        PP, EDID_ASPECT_256_135),
+        [100] = EDID_VIC(297000, 4096, 4184, 4272, 4400, 2160, 2168, 2178, 2250,
+                        PP | FR, EDID_ASPECT_256_135),
+        [101] = EDID_VIC(594000, 4096, 5064, 5152, 5280, 2160, 2168, 2178, 2250,
+                        PP, EDID_ASPECT_256_135),
+        [102] = EDID_VIC(594000, 4096, 4184, 4272, 4400, 2160, 2168, 2178, 2250,
+                        PP | FR, EDID_ASPECT_256_135),
+        [103] = EDID_VIC(297000, 3840, 5116, 5204, 5500, 2160, 2168, 2178, 2250,
+                        PP | FR, EDID_ASPECT_64_27),
+        [104] = EDID_VIC(297000, 3840, 4896, 4984, 5280, 2160, 2168, 2178, 2250,
+                        PP, EDID_ASPECT_64_27),
+        [105] = EDID_VIC(297000, 3840, 4016, 4104, 4400, 2160, 2168, 2178, 2250,
+                        PP | FR, EDID_ASPECT_64_27),
+        [106] = EDID_VIC(594000, 3840, 4896, 4984, 5280, 2160, 2168, 2178, 2250,
+                        PP, EDID_ASPECT_64_27),
+        [107] = EDID_VIC(594000, 3840, 4016, 4104, 4400, 2160, 2168, 2178, 2250,
+                        PP | FR, EDID_ASPECT_64_27),
+        [108] = EDID_VIC(90000, 1280, 2240, 2280, 2500, 720, 725, 730, 750,
+                        PP | FR, EDID_ASPECT_16_9),
+        [109] = EDID_VIC(90000, 1280, 2240, 2280, 2500, 720, 725, 730, 750,
+                        PP | FR, EDID_ASPECT_64_27),
+        [110] = EDID_VIC(99000, 1680, 2490, 2530, 2750, 720, 725, 730, 750,
+                        PP | FR, EDID_ASPECT_64_27),
+        [111] = EDID_VIC(148500, 1920, 2558, 2602, 2750, 1080, 1084, 1089, 1125,
+                        PP | FR, EDID_ASPECT_16_9),
+        [112] = EDID_VIC(148500, 1920, 2558, 2602, 2750, 1080, 1084, 1089, 1125,
+                        PP | FR, EDID_ASPECT_64_27),
+        [113] = EDID_VIC(198000, 2560, 3558, 3602, 3750, 1080, 1084, 1089, 1100,
+                        PP | FR, EDID_ASPECT_64_27),
+        [114] = EDID_VIC(594000, 3840, 5116, 5204, 5500, 2160, 2168, 2178, 2250,
+                        PP | FR, EDID_ASPECT_16_9),
+        [115] = EDID_VIC(594000, 4096, 5116, 5204, 5500, 2160, 2168, 2178, 2250,
+                        PP | FR, EDID_ASPECT_256_135),
+        [116] = EDID_VIC(594000, 3840, 5116, 5204, 5500, 2160, 2168, 2178, 2250,
+                        PP | FR, EDID_ASPECT_64_27),
+        [117] = EDID_VIC(1188000, 3840, 4896, 4984, 5280, 2160, 2168, 2178, 2250,
+                        PP, EDID_ASPECT_16_9),
+        [118] = EDID_VIC(1188000, 3840, 4016, 4104, 4400, 2160, 2168, 2178, 2250,
+                        PP | FR, EDID_ASPECT_16_9),
+        [119] = EDID_VIC(1188000, 3840, 4896, 4984, 5280, 2160, 2168, 2178, 2250,
+                        PP, EDID_ASPECT_64_27),
+        [120] = EDID_VIC(1188000, 3840, 4016, 4104, 4400, 2160, 2168, 2178, 2250,
+                        PP | FR, EDID_ASPECT_64_27),
+        [121] = EDID_VIC(396000, 5120, 7116, 7204, 7500, 2160, 2168, 2178, 2200,
+                        PP | FR, EDID_ASPECT_64_27),
+        [122] = EDID_VIC(396000, 5120, 6816, 6904, 7200, 2160, 2168, 2178, 2200,
+                        PP, EDID_ASPECT_64_27),
+        [123] = EDID_VIC(396000, 5120, 5784, 5872, 6000, 2160, 2168, 2178, 2200,
+                        PP | FR, EDID_ASPECT_64_27),
+        [124] = EDID_VIC(742500, 5120, 5866, 5954, 6250, 2160, 2168, 2178, 2475,
+                        PP | FR, EDID_ASPECT_64_27),
+        [125] = EDID_VIC(742500, 5120, 6216, 6304, 6600, 2160, 2168, 2178, 2250,
+                        PP, EDID_ASPECT_64_27),
+        [126] = EDID_VIC(742500, 5120, 5284, 5372, 5500, 2160, 2168, 2178, 2250,
+                        PP | FR, EDID_ASPECT_64_27),
+        [127] = EDID_VIC(1485000, 5120, 6216, 6304, 6600, 2160, 2168, 2178, 2250,
+                        PP, EDID_ASPECT_64_27),
+        [193] = EDID_VIC(1485000, 5120, 5284, 5372, 5500, 2160, 2168, 2178, 2250,
+                        PP | FR, EDID_ASPECT_64_27),
+        [194] = EDID_VIC(1188000, 7680, 10232, 10408, 11000, 4320, 4336, 4356, 4500,
+                        PP | FR, EDID_ASPECT_16_9),
+        [195] = EDID_VIC(1188000, 7680, 10032, 10208, 10800, 4320, 4336, 4356, 4400,
+                        PP, EDID_ASPECT_16_9),
+        [196] = EDID_VIC(1188000, 7680, 8232, 8408, 9000, 4320, 4336, 4356, 4400,
+                        PP | FR, EDID_ASPECT_16_9),
+        [197] = EDID_VIC(2376000, 7680, 10232, 10408, 11000, 4320, 4336, 4356, 4500,
+                        PP | FR, EDID_ASPECT_16_9),
+        [198] = EDID_VIC(2376000, 7680, 10032, 10208, 10800, 4320, 4336, 4356, 4400,
+                        PP, EDID_ASPECT_16_9),
+        [199] = EDID_VIC(2376000, 7680, 8232, 8408, 9000, 4320, 4336, 4356, 4400,
+                        PP | FR, EDID_ASPECT_16_9),
+        [200] = EDID_VIC(4752000, 7680, 9792, 9968, 10560, 4320, 4336, 4356, 4500,
+                        PP, EDID_ASPECT_16_9),
+        [201] = EDID_VIC(4752000, 7680, 8032, 8208, 8800, 4320, 4336, 4356, 4500,
+                        PP | FR, EDID_ASPECT_16_9),
+        [202] = EDID_VIC(1188000, 7680, 10232, 10408, 11000, 4320, 4336, 4356, 4500,
+                        PP | FR, EDID_ASPECT_64_27),
+        [203] = EDID_VIC(1188000, 7680, 10032, 10208, 10800, 4320, 4336, 4356, 4400,
+                        PP, EDID_ASPECT_64_27),
+        [204] = EDID_VIC(1188000, 7680, 8232, 8408, 9000, 4320, 4336, 4356, 4400,
+                        PP | FR, EDID_ASPECT_64_27),
+        [205] = EDID_VIC(2376000, 7680, 10232, 10408, 11000, 4320, 4336, 4356, 4500,
+                        PP | FR, EDID_ASPECT_64_27),
+        [206] = EDID_VIC(2376000, 7680, 10032, 10208, 10800, 4320, 4336, 4356, 4400,
+                        PP, EDID_ASPECT_64_27),
+        [207] = EDID_VIC(2376000, 7680, 8232, 8408, 9000, 4320, 4336, 4356, 4400,
+                        PP | FR, EDID_ASPECT_64_27),
+        [208] = EDID_VIC(4752000, 7680, 9792, 9968, 10560, 4320, 4336, 4356, 4500,
+                        PP, EDID_ASPECT_64_27),
+        [209] = EDID_VIC(4752000, 7680, 8032, 8208, 8800, 4320, 4336, 4356, 4500,
+                        PP | FR, EDID_ASPECT_64_27),
+        [210] = EDID_VIC(1485000, 10240, 11732, 11908, 12500, 4320, 4336, 4356, 4950,
+                        PP | FR, EDID_ASPECT_64_27),
+        [211] = EDID_VIC(1485000, 10240, 12732, 12908, 13500, 4320, 4336, 4356, 4400,
+                        PP, EDID_ASPECT_64_27),
+        [212] = EDID_VIC(1485000, 10240, 10528, 10704, 11000, 4320, 4336, 4356, 4500,
+                        PP | FR, EDID_ASPECT_64_27),
+        [213] = EDID_VIC(2970000, 10240, 11732, 11908, 12500, 4320, 4336, 4356, 4950,
+                        PP | FR, EDID_ASPECT_64_27),
+        [214] = EDID_VIC(2970000, 10240, 12732, 12908, 13500, 4320, 4336, 4356, 4400,
+                        PP, EDID_ASPECT_64_27),
+        [215] = EDID_VIC(2970000, 10240, 10528, 10704, 11000, 4320, 4336, 4356, 4500,
+                        PP | FR, EDID_ASPECT_64_27),
+        [216] = EDID_VIC(5940000, 10240, 12432, 12608, 13200, 4320, 4336, 4356, 4500,
+                        PP, EDID_ASPECT_64_27),
+        [217] = EDID_VIC(5940000, 10240, 10528, 10704, 11000, 4320, 4336, 4356, 4500,
+                        PP | FR, EDID_ASPECT_64_27),
+        [218] = EDID_VIC(1188000, 4096, 4896, 4984, 5280, 2160, 2168, 2178, 2250,
+                        PP, EDID_ASPECT_256_135),
+        [219] = EDID_VIC(1188000, 4096, 4184, 4272, 4400, 2160, 2168, 2178, 2250,
+                        PP | FR, EDID_ASPECT_256_135),
+};
+
+const struct edid_vic_timing *libedid_vic_timing(u_int8_t vic)
+{
+        const struct edid_vic_timing *timing = &edid_vic_timings[vic];
+
+        return timing->hactive ? timing : NULL;
+}
@@ -24,7 +24,7 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <malloc.h>
-#include <math.h>
+#include <stdlib.h>
 #include <string.h>
 #include <sys/types.h>
 
@@ -66,6 +66,15 @@
 #define CEA_EXTN_BLK_SIZE 128
 #define CEA_EXT_BLK_TAG_VALUE 0x2
 
+/* DisplayID extension block */
+#define DISPLAYID_EXT_BLK_TAG_VALUE 0x70
+/* Tag, version, section length, product type and extension count */
+#define DISPLAYID_HDR_SIZE 5
+/* Data block tag, revision and payload length */
+#define DISPLAYID_DB_HDR_SIZE 3
+/* The section and its checksum must fit before the block checksum */
+#define DISPLAYID_MAX_SECTION (CEA_EXTN_BLK_SIZE - DISPLAYID_HDR_SIZE - 2)
+
 /* CEA colorimetry block byte 1 */
 #define CEA_EXT_CLR_BT2020RGB_BIT   7
 #define CEA_EXT_CLR_BT2020YCC_BIT   6
@@ -143,8 +152,8 @@
 #define CEA_EXT_BLK_TAG(b) ((b & (0x7 << 5)) >> 5)
 #define CEA_EXT_BLK_DATA_LEN(b) (b & 0x1F)
 
-/* Utility macro to set a vic in a vicdb */
-#define SET_VIC(vdb, v) (vdb |= (1 << (v-1)))
+/* Utility macro to set a vic in a vicdb, bit 0 of vdb[0] is VIC 1 */
+#define SET_VIC(vdb, v) (vdb[((v) - 1) / 64] |= 1ULL << (((v) - 1) % 64))
 
 /* Utility to check if a bit is set in a value */
 #define CHECK_BIT(x, bit) ((x & (1 << bit)) >> bit)
@@ -170,6 +179,7 @@ static const char *cea_extended_tag_names[] = {
         [CEA_DATA_BLOCK_EXT_RCDB] = "Room Configuration Data Block ",
         [CEA_DATA_BLOCK_EXT_SPKR_LOC_DB] = "Speaker Location Data Block ",
         [CEA_DATA_BLOCK_EXT_IFDB] = "InfoFrame Data Block ",
+        [CEA_DATA_BLOCK_EXT_HF_EEODB] = "HDMI Forum EDID Extension Override Data Block ",
 };
 
 static const char *cea_db_names[] = {
@@ -182,122 +192,563 @@ static const char *cea_db_names[] = {
         [CEA_DATA_BLOCK_EXTENDED] = "Extended"
 };
 
-/* Logs */
-#define edid_error printf
+/* Logs, VERBOSE builds only: the parse path reports through edid_report() */
 #if VERBOSE
+#define edid_error printf
 #define edid_warn printf
 #define edid_debug printf
 #else
+int edid_error(const char *format, ...) { return 0;}
 int edid_warn(const char *format, ...) { return 0;}
 int edid_debug(const char *format, ...) { return 0;}
 #endif
 
+/* Not synchronized with the parses, set before any of them like the data
+ * block handlers
+ */
+static struct {
+        libedid_diag_handler handler;
+        void *data;
+} edid_diag_sink;
+
+void libedid_register_diag_handler(libedid_diag_handler handler, void *data)
+{
+        edid_diag_sink.handler = handler;
+        edid_diag_sink.data = handler ? data : NULL;
+}
+
+/* Keep a diagnostic in diags (if any), and pass it to the handler */
+static void
+edid_report_to(struct edid_diags *diags, u_int8_t severity, u_int8_t code,
+                u_int8_t blk, u_int16_t offset, u_int16_t detail)
+{
+        struct edid_diag diag = {
+                .code = code,
+                .severity = severity,
+                .blk = blk,
+                .offset = offset,
+                .detail = detail,
+        };
+
+        if (diags) {
+                if (diags->n_diags < EDID_MAX_DIAGS)
+                        diags->diag[diags->n_diags++] = diag;
+                else if (diags->n_dropped < 255)
+                        diags->n_dropped++;
+        }
+
+        if (edid_diag_sink.handler)
+                edid_diag_sink.handler(&diag, edid_diag_sink.data);
+}
+
+/* Same as above, kept in info */
+static inline void
+edid_report(struct edid_info *info, u_int8_t severity, u_int8_t code,
+                u_int8_t blk, u_int16_t offset, u_int16_t detail)
+{
+        edid_report_to(info ? &info->diags : NULL, severity, code, blk, offset, detail);
+}
+
+/* Same as above, at p in info->raw_edid */
+static inline void
+edid_report_at(struct edid_info *info, u_int8_t severity, u_int8_t code,
+                const u_int8_t *p, u_int16_t detail)
+{
+        u_int16_t offset = p - info->raw_edid;
+
+        edid_report(info, severity, code, offset / 128, offset, detail);
+}
+
+/* Same as above, for the data block being parsed */
+static void
+edid_report_db(struct edid_info *info, u_int8_t severity, u_int8_t code, u_int16_t detail)
+{
+        const struct edid_db_entry *entry = &info->db_index.entries[info->cur_db];
+
+        edid_report(info, severity, code, entry->ext_blk, entry->offset, detail);
+}
+
+/* Arena allocations are kept 8 byte aligned */
+#define EDID_ARENA_ALIGN(s) (((s) + 7) & ~((size_t)7))
+
+static void
+*edid_alloc(struct edid_info *info, size_t size)
+{
+        struct edid_arena *arena = &info->arena;
+        void *ptr;
+
+        if (!(info->flags & EDID_PARSE_ARENA))
+                return malloc(size);
+
+        size = EDID_ARENA_ALIGN(size);
+        if (arena->used + size > arena->size) {
+                edid_error("EDID arena exhausted (%zu + %zu > %zu)\n",
+                        arena->used, size, arena->size);
+                return NULL;
+        }
+
+        ptr = &arena->base[arena->used];
+        arena->used += size;
+        return ptr;
+}
+
+/* Payloads point into the raw EDID instead of being copied out */
+#define EDID_PARSE_VIEWS (EDID_PARSE_BORROW_RAW | EDID_PARSE_OWN_RAW)
+
+static inline struct edid_view
+edid_make_view(struct edid_info *info, u_int8_t *ptr, u_int16_t len)
+{
+        struct edid_view view = {
+                .offset = ptr - info->raw_edid,
+                .len = len,
+        };
+
+        return view;
+}
+
+const u_int8_t
+*libedid_view_data(struct edid_info *info, const struct edid_view *view)
+{
+        if (!info || !view || !view->len)
+                return NULL;
+
+        return &info->raw_edid[view->offset];
+}
+
+/* The IFDB header carries the IFPD payload length in bits 7:5 */
+static inline u_int8_t
+cea_ifdb_payload_len(u_int8_t *ifdb, u_int8_t ifdbl)
+{
+        u_int8_t len = (ifdb[0] & 0xE0) >> 5;
+
+        return len > ifdbl - 2 ? ifdbl - 2 : len;
+}
+
+/* Block map extension, lists the tags of the blocks after it */
+#define EDID_BLOCK_MAP_TAG 0xF0
+
+/* The base block, and up to 255 extension blocks */
+#define EDID_MAX_EXT_BLKS 255
+
+/*
+ * Number of extension blocks. The HF-EEODB, the first data block of the
+ * first CEA block when there is one, overrides the count of the base
+ * block, which stays at 1 for the sake of old sources. With
+ * EDID_PARSE_BASE_COUNT there is no length to check the HF-EEODB count
+ * against, so only the base block is trusted. Otherwise raw_edid must
+ * have the first extension block if the base block says there is one.
+ */
+static unsigned int
+edid_n_ext_blks(const u_int8_t *raw_edid, u_int32_t flags)
+{
+        const struct edid *edid = (const struct edid *)raw_edid;
+        const u_int8_t *cea = &raw_edid[CEA_EXTN_BLK_SIZE];
+
+        if (flags & EDID_PARSE_BASE_COUNT)
+                return edid->extensions;
+
+        if (!edid->extensions || cea[0] != CEA_EXT_BLK_TAG_VALUE || cea[2] < 7)
+                return edid->extensions;
+
+        if (CEA_EXT_BLK_TAG(cea[4]) == CEA_DATA_BLOCK_EXTENDED &&
+                        CEA_EXT_BLK_DATA_LEN(cea[4]) >= 2 &&
+                        cea[5] == CEA_DATA_BLOCK_EXT_HF_EEODB && cea[6])
+                return cea[6];
+
+        return edid->extensions;
+}
+
+/* Blob size for the entry points which get no length */
+static size_t
+edid_base_size(const u_int8_t *raw_edid)
+{
+        return (((const struct edid *)raw_edid)->extensions + 1) * CEA_EXTN_BLK_SIZE;
+}
+
+/*
+ * Streams the extension blocks of an EDID in order, block maps left out,
+ * up to n_blks, the edid_n_ext_blks() of the parse. Every walk over the
+ * extension blocks goes through it, see for_each_ext_blk().
+ */
+struct edid_blk_reader {
+        const u_int8_t *raw_edid;
+        u_int16_t n_blks;
+        u_int16_t blk;
+};
+
+static inline void
+edid_blk_reader_init(struct edid_blk_reader *r, const u_int8_t *raw_edid,
+                     unsigned int n_blks)
+{
+        r->raw_edid = raw_edid;
+        r->n_blks = n_blks;
+        r->blk = 0;
+}
+
+/* Number of the next extension block, 0 at the end */
+static inline unsigned int
+edid_blk_next(struct edid_blk_reader *r)
+{
+        while (r->blk < r->n_blks) {
+                r->blk++;
+                if (r->raw_edid[r->blk * CEA_EXTN_BLK_SIZE] != EDID_BLOCK_MAP_TAG)
+                        return r->blk;
+        }
+
+        return 0;
+}
+
+#define for_each_ext_blk(r, raw_edid, n_blks, blk) \
+        for (edid_blk_reader_init(&(r), raw_edid, n_blks); ((blk) = edid_blk_next(&(r))); )
+
+/* Next DisplayID data block at off, false at the end of the section or
+ * at the zero padding after the last block
+ */
+static inline bool
+displayid_db_valid(const u_int8_t *blk, unsigned int off, unsigned int end)
+{
+        return off + DISPLAYID_DB_HDR_SIZE <= end && (blk[off] || blk[off + 2]) &&
+                off + DISPLAYID_DB_HDR_SIZE + blk[off + 2] <= end;
+}
+
+#define for_each_displayid_db(blk, off, end) \
+        for (off = DISPLAYID_HDR_SIZE; displayid_db_valid(blk, off, end); \
+                        off += DISPLAYID_DB_HDR_SIZE + blk[off + 2])
+
+/* Bytes of an extension block holding a CTA-861 data block collection */
+struct edid_db_range {
+        u_int8_t start;
+        u_int8_t end;
+};
+
+/* One per DisplayID data block at most */
+#define EDID_MAX_DB_RANGES (DISPLAYID_MAX_SECTION / DISPLAYID_DB_HDR_SIZE)
+
+/*
+ * End of the CTA data blocks between start and end which are in bounds:
+ * end when they all are, else the start of the first one which runs past
+ * end (or of an extended block with no room for its extended tag).
+ */
+static unsigned int
+edid_db_collection_end(const u_int8_t *blk, unsigned int start, unsigned int end)
+{
+        for (; start < end; start += CEA_EXT_BLK_DATA_LEN(blk[start]) + 1) {
+                u_int8_t dblen = CEA_EXT_BLK_DATA_LEN(blk[start]);
+
+                if (start + dblen + 1 > end)
+                        return start;
+
+                if (CEA_EXT_BLK_TAG(blk[start]) == CEA_DATA_BLOCK_EXTENDED && !dblen)
+                        return start;
+        }
+
+        return end;
+}
+
+static u_int8_t
+edid_sum(const u_int8_t *p, unsigned int len)
+{
+        u_int8_t sum = 0;
+
+        while (len--)
+                sum += *p++;
+
+        return sum;
+}
+
+/* A DisplayID section which fits in its block */
+static inline bool
+displayid_section_fits(const u_int8_t *blk)
+{
+        return blk[2] <= DISPLAYID_MAX_SECTION;
+}
+
+/* And which adds up, the ones which don't are skipped, not rejected */
+static inline bool
+displayid_section_ok(const u_int8_t *blk)
+{
+        return displayid_section_fits(blk) &&
+                !edid_sum(&blk[1], DISPLAYID_HDR_SIZE + blk[2]);
+}
+
+/*
+ * CTA data block collections of an extension block: bytes 4 to d of a CEA
+ * block, or the payloads of the CTA data blocks of a DisplayID section.
+ * Only the data blocks which are in bounds are in the ranges, so EDIDs
+ * which failed validation can be parsed too.
+ */
+static int
+edid_blk_db_ranges(const u_int8_t *blk, struct edid_db_range *ranges)
+{
+        unsigned int off, end = DISPLAYID_HDR_SIZE + blk[2];
+        int n = 0;
+
+        if (blk[0] == CEA_EXT_BLK_TAG_VALUE) {
+                if (blk[2] < 4)
+                        return 0;
+
+                ranges[0].start = 4;
+                ranges[0].end = edid_db_collection_end(blk, 4,
+                        blk[2] < CEA_EXTN_BLK_SIZE - 1 ? blk[2] : CEA_EXTN_BLK_SIZE - 1);
+                return 1;
+        }
+
+        if (blk[0] != DISPLAYID_EXT_BLK_TAG_VALUE || !displayid_section_ok(blk))
+                return 0;
+
+        for_each_displayid_db(blk, off, end) {
+                if (blk[off] != DISPLAYID_CTA_DATA || !blk[off + 2])
+                        continue;
+
+                ranges[n].start = off + DISPLAYID_DB_HDR_SIZE;
+                ranges[n].end = edid_db_collection_end(blk, ranges[n].start,
+                        off + DISPLAYID_DB_HDR_SIZE + blk[off + 2]);
+                n++;
+        }
+
+        return n;
+}
+
+/* DTDs start at byte d, and must fit before the checksum byte */
+static inline u_int8_t
+cea_n_dtd_modes(u_int8_t *cea)
+{
+        u_int8_t n_dtd = cea[3] & 0xF;
+        u_int8_t room = cea[2] < CEA_EXTN_BLK_SIZE - 1 ?
+                (CEA_EXTN_BLK_SIZE - 1 - cea[2]) / 18 : 0;
+
+        return n_dtd > room ? room : n_dtd;
+}
+
 static inline void
 _set_vic(u_int64_t *vicdb, u_int8_t vic)
 {
-        edid_debug("Setting VIC %d as vic[%d][%d]\n", vic, vic/64, vic%64);
-        SET_VIC(vicdb[vic/64], vic%64);
+        edid_debug("Setting VIC %d as vic[%d][%d]\n", vic, (vic - 1) / 64, (vic - 1) % 64);
+        SET_VIC(vicdb, vic);
 }
 
+/* Set the VIC of this SVD in vicdb, and return it, 0 if the SVD is invalid */
 static u_int8_t
-set_vic(u_int64_t *vicdb, u_int64_t vic)
-{
-        if ((vic >= 1 && vic <= 127) || (vic >= 193 && vic <= 253)) {
-                _set_vic(vicdb, vic);
-        } else if (vic >= 129 || vic <= 192) {
-                edid_debug("VIC %ld is native mode\n", vic & 0x7F);
-                _set_vic(vicdb, vic & 0x7F);
-                return vic & 0x7F;
-        } else {
-                edid_debug("Ignoring invalid vic %ld\n", vic);
+set_vic(u_int64_t *vicdb, u_int8_t svd, bool *native)
+{
+        *native = false;
+        if ((svd >= 1 && svd <= 127) || (svd >= 193 && svd <= 253)) {
+                _set_vic(vicdb, svd);
+                return svd;
+        } else if (svd >= 129 && svd <= 192) {
+                edid_debug("VIC %d is native mode\n", svd & 0x7F);
+                _set_vic(vicdb, svd & 0x7F);
+                *native = true;
+                return svd & 0x7F;
         }
 
+        edid_debug("Ignoring invalid vic %d\n", svd);
         return 0;
 }
 
-u_int8_t
-*find_data_block_in_edid(struct edid_info *info, u_int8_t *vdblen, enum cea_data_block_tags tag)
+/* Add flags to the caps of a VIC, found in the data block being parsed */
+static void
+set_vic_caps(struct edid_info *info, u_int8_t vic, u_int8_t flags)
 {
-        u_int8_t blk = 0;
-        struct edid_tags *etags = &info->cea_blks;
+        struct edid_vic_caps *caps = &info->cea_blks.vic_caps[vic];
 
-        for (blk = 1; blk <= etags->n_cea_ext_blks; blk++) {
-                u_int8_t *cea_ext = &(info->raw_edid[blk * CEA_EXTN_BLK_SIZE]);
-                u_int8_t d = cea_ext[2];
-                u_int8_t count = 4;
+        caps->flags |= flags;
+        if (!caps->ext_blk) {
+                caps->ext_blk = info->db_index.entries[info->cur_db].ext_blk;
+                caps->db = info->cur_db;
+        }
+}
 
-                if (d <= 4) {
-                        edid_debug("Skipping too small CEA block\n");
-                        continue;
-                }
+const struct edid_db_entry
+*libedid_find_db(struct edid_info *info, u_int8_t tag, u_int8_t ext_tag)
+{
+        struct edid_db_index *idx = &info->db_index;
+        u_int16_t first;
 
-                /* CEA data block collection is between bytes 4 and d */
-                while (count < d) {
-                        u_int8_t *db = &cea_ext[count];
-                        u_int8_t dblen = CEA_EXT_BLK_DATA_LEN(db[0]);
-                        enum cea_data_block_tags blk_tag = CEA_EXT_BLK_TAG(db[0]);
+        if (tag > CEA_DATA_BLOCK_EXTENDED)
+                return NULL;
 
-                        if (blk_tag == tag) {
-                                edid_debug("Found desired data block in CEA EXT (%d)\n", blk);
-                                *vdblen = dblen;
-                                return db;
-                        }
-                        count += dblen;
-                }
+        first = (tag == CEA_DATA_BLOCK_EXTENDED) ?
+                idx->first_ext_tag[ext_tag] : idx->first_tag[tag];
+
+        return first == EDID_DB_NONE ? NULL : &idx->entries[first];
+}
+
+const struct edid_db_entry
+*libedid_next_db(struct edid_info *info, const struct edid_db_entry *entry)
+{
+        if (!entry || entry->next == EDID_DB_NONE)
+                return NULL;
+
+        return &info->db_index.entries[entry->next];
+}
+
+u_int8_t
+*find_data_block_in_edid(struct edid_info *info, u_int8_t *vdblen, enum cea_data_block_tags tag)
+{
+        const struct edid_db_entry *entry = libedid_find_db(info, tag, 0);
+
+        if (!entry) {
+                edid_debug("No such data block Found in EDID\n");
+                return NULL;
         }
 
-        edid_debug("No such data block Found in EDID\n");
-        return NULL;
+        edid_debug("Found desired data block in CEA EXT (%d)\n", entry->ext_blk);
+        *vdblen = entry->len;
+        return &info->raw_edid[entry->offset];
 }
 
-static inline u_int8_t
-find_vic_from_pos(u_int8_t *db, u_int8_t pos)
+/* SVD positions run across all the VDBs, in EDID order */
+static u_int8_t
+find_vic_from_pos(struct edid_info *info, unsigned int pos)
 {
-        return db[pos];
+        const struct edid_db_entry *vdb;
+
+        for (vdb = libedid_find_db(info, CEA_DATA_BLOCK_VIDEO, 0); vdb;
+                        vdb = libedid_next_db(info, vdb)) {
+                if (pos < vdb->len)
+                        /* First byte in VDB is tag */
+                        return info->raw_edid[vdb->offset + 1 + pos];
+                pos -= vdb->len;
+        }
+
+        return 0;
 }
 
 static void
-parse_cea_ext_extended_hdr_dynamic_md_blk(struct edid_tags *etags, u_int8_t *db, u_int8_t dblen)
+parse_cea_ext_extended_hdr_dynamic_md_blk(struct edid_info *info, u_int8_t *db, u_int8_t dblen, void *data)
 {
         u_int8_t *hddb = db;
         u_int8_t hddbl = dblen;
-        u_int8_t old_size = 0;
+        u_int16_t old_size = 0;
+        struct edid_tags *etags = &info->cea_blks;
+        bool in_place;
 
         if (hddbl < 2) {
                 edid_warn("Invalid Static HDR MD DB len %d\n", hddbl + 1);
+                edid_report_db(info, EDID_DIAG_WARN, EDID_DIAG_BAD_DB_LEN, hddbl);
                 return;
         }
 
         /* Todo: The dynamic metadata is being saved in raw form as of now,
          * we can do it better here, and tabulate in a format_tye vs data
          * table */
-        if (etags->hdr_dmd.size) {
-                /* This is not the first dynamic HDR metadata block */
-                old_size = etags->hdr_dmd.size;
-                etags->hdr_dmd.data = realloc((void *)etags->hdr_dmd.data,
-                                etags->hdr_dmd.size + hddbl);
-                etags->hdr_dmd.size += hddbl;
-
+        if (etags->hdr_dmd.n_views < EDID_MAX_HDR_DMD_VIEWS) {
+                etags->hdr_dmd.views[etags->hdr_dmd.n_views++] =
+                        edid_make_view(info, hddb, hddbl);
         } else {
-                etags->hdr_dmd.data = malloc(hddbl);
+                edid_warn("Too many dynamic HDR metadata blocks, not viewing this one\n");
+                edid_report_db(info, EDID_DIAG_WARN, EDID_DIAG_DB_LIMIT, 0);
+        }
+
+        /* Viewed, a single block is used in place. The blocks after it are
+         * copied together with it, as in the other modes.
+         */
+        if ((info->flags & EDID_PARSE_VIEWS) && !etags->hdr_dmd.data) {
+                etags->hdr_dmd.data = hddb;
                 etags->hdr_dmd.size = hddbl;
+                return;
+        }
+
+        in_place = etags->hdr_dmd.data &&
+                etags->hdr_dmd.data == &info->raw_edid[etags->hdr_dmd.views[0].offset];
+        old_size = etags->hdr_dmd.size;
+
+        /* The first block copied reserves room for all of them, see edid_prescan() */
+        if (!etags->hdr_dmd.data || in_place) {
+                u_int8_t *buf = edid_alloc(info, info->arena.hdr_dmd_size);
+
+                if (!buf) {
+                        edid_error("Out of memory for dynamic HDR metadata\n");
+                        edid_report_db(info, EDID_DIAG_ERROR, EDID_DIAG_NO_MEMORY,
+                                EDID_DECODE_HDR);
+                        return;
+                }
+
+                if (in_place)
+                        memcpy(buf, etags->hdr_dmd.data, old_size);
+                etags->hdr_dmd.data = buf;
+        }
+
+        if (old_size + hddbl > info->arena.hdr_dmd_size) {
+                edid_error("Dynamic HDR metadata past its reservation\n");
+                edid_report_db(info, EDID_DIAG_ERROR, EDID_DIAG_NO_MEMORY, EDID_DECODE_HDR);
+                return;
         }
+        etags->hdr_dmd.size += hddbl;
 
         memcpy((void *)&(etags->hdr_dmd.data[old_size]), (const void *)hddb, hddbl);
         edid_debug("Found %s dynamic HDR metadata block, size %d\n",
                 old_size ? "another" : "", dblen);
 }
 
+/* 2 ^ (k / 32), k = 0..31, in 32.32 fixed point */
+static const u_int64_t edid_pow2_32nds[32] = {
+        0x100000000ULL, 0x1059b0d31ULL, 0x10b5586d0ULL, 0x111301d01ULL,
+        0x1172b83c8ULL, 0x11d487317ULL, 0x12387a6e7ULL, 0x129e9df52ULL,
+        0x1306fe0a3ULL, 0x1371a7374ULL, 0x13dea64c1ULL, 0x144e08606ULL,
+        0x14bfdad53ULL, 0x15342b56aULL, 0x15ab07dd5ULL, 0x16247eb04ULL,
+        0x16a09e668ULL, 0x171f75e8fULL, 0x17a11473fULL, 0x182589995ULL,
+        0x18ace5423ULL, 0x193737b0dULL, 0x19c49182aULL, 0x1a5503b24ULL,
+        0x1ae89f996ULL, 0x1b7f76f30ULL, 0x1c199bdd8ULL, 0x1cb720dcfULL,
+        0x1d5818dd0ULL, 0x1dfc97338ULL, 0x1ea4afa2aULL, 0x1f50765b7ULL,
+};
+
+/* Luminance value= 50 * 2 ^(CV/32), in 32.32 fixed point */
+static u_int64_t
+cea_hdr_lum_fx(u_int8_t cv)
+{
+        return (50 * edid_pow2_32nds[cv & 31]) << (cv >> 5);
+}
+
+/* 32.32 fixed point to float, exact up to the final rounding */
+static float
+edid_fx_to_float(u_int64_t fx)
+{
+        return (double)fx * (1.0 / 4294967296.0);
+}
+
+/* Luminances, in cd/m2, from the code values of the static HDR metadata */
+static void
+cea_hdr_smd_lums(struct cea_static_hdr_md *smd)
+{
+        u_int32_t cv;
+
+        smd->content_max_lum_fx = 0;
+        smd->content_fav_lum_fx = 0;
+        smd->content_min_lum_fx = 0;
+
+        if (smd->n_lum_cv >= 1)
+                smd->content_max_lum_fx = cea_hdr_lum_fx(smd->lum_cv[0]);
+
+        if (smd->n_lum_cv >= 2)
+                smd->content_fav_lum_fx = cea_hdr_lum_fx(smd->lum_cv[1]);
+
+        if (smd->n_lum_cv >= 3) {
+                /* Desired Content Min Luminance = (Desired Content Max Luminance * (CV/255) 2 / 100),
+                 * which fits in 64 bits: max is below 2^46, CV^2 below 2^16
+                 */
+                cv = smd->lum_cv[2];
+                smd->content_min_lum_fx = (smd->content_max_lum_fx * cv * cv +
+                                255 * 255 * 100 / 2) / (255 * 255 * 100);
+        }
+
+        smd->content_max_lum = edid_fx_to_float(smd->content_max_lum_fx);
+        smd->content_fav_lum = edid_fx_to_float(smd->content_fav_lum_fx);
+        smd->content_min_lum = edid_fx_to_float(smd->content_min_lum_fx);
+}
+
 static void
-parse_cea_ext_extended_hdr_static_md_blk(struct edid_tags *etags, u_int8_t *db, u_int8_t dblen)
+parse_cea_ext_extended_hdr_static_md_blk(struct edid_info *info, u_int8_t *db, u_int8_t dblen, void *data)
 {
+        struct edid_tags *etags = &info->cea_blks;
         u_int8_t *hsdb = db;
         u_int8_t hsdbl = dblen;
         u_int8_t hdr_md;
-        float lum;
 
         if (hsdbl < 2) {
                 edid_warn("Invalid Static HDR MD DB len %d\n", hsdbl + 1);
+                edid_report_db(info, EDID_DIAG_WARN, EDID_DIAG_BAD_DB_LEN, hsdbl);
                 return;
         }
 
@@ -311,24 +762,9 @@ parse_cea_ext_extended_hdr_static_md_blk(struct edid_tags *etags, u_int8_t *db,
         etags->hdr_smd.static_md_type_1 = CHECK_BIT(hdr_md, CEA_HDR_SMD_TYPE1_BIT);
 
         /* Content luminance data */
-        if (hsdbl >= 3) {
-                lum = hsdb[2];
-                /* Luminance value= 50 * 2 ^(CV/32) */
-                etags->hdr_smd.content_max_lum = 50 * pow(2, lum/32);
-        }
-
-        if (hsdbl >= 4) {
-                lum = hsdb[3];
-                /* Luminance value= 50 * 2 ^(CV/32) */
-                etags->hdr_smd.content_fav_lum = 50 * pow(2, lum/32);
-        }
-
-        if (hsdbl >= 5) {
-                lum = hsdb[4];
-                /* Desired Content Min Luminance = (Desired Content Max Luminance * (CV/255) 2 / 100) */
-                etags->hdr_smd.content_min_lum = (etags->hdr_smd.content_max_lum *
-                                        pow(lum/255, 2) / 100);
-        }
+        etags->hdr_smd.n_lum_cv = hsdbl - 2 > 3 ? 3 : hsdbl - 2;
+        memcpy(etags->hdr_smd.lum_cv, &hsdb[2], etags->hdr_smd.n_lum_cv);
+        cea_hdr_smd_lums(&etags->hdr_smd);
 
         edid_debug("Static HDR metadata block: %d bytes\n", hsdbl);
         edid_debug("Gamma: SDR:%s HDR:%s ST2084:%s HLG:%s\n",
@@ -343,14 +779,16 @@ parse_cea_ext_extended_hdr_static_md_blk(struct edid_tags *etags, u_int8_t *db,
 }
 
 static void
-parse_cea_ext_extended_vfpdb_blk(struct edid_tags *etags, u_int8_t *db, u_int8_t dblen)
+parse_cea_ext_extended_vfpdb_blk(struct edid_info *info, u_int8_t *db, u_int8_t dblen, void *data)
 {
+        struct edid_tags *etags = &info->cea_blks;
         u_int8_t *vfpdb = db;
         u_int8_t vfpdbl = dblen;
         u_int8_t count;
 
         if (!vfpdbl) {
                 edid_warn("Invalid VFPDB len %d\n", vfpdbl);
+                edid_report_db(info, EDID_DIAG_WARN, EDID_DIAG_BAD_DB_LEN, vfpdbl);
                 return;
         }
 
@@ -361,32 +799,36 @@ parse_cea_ext_extended_vfpdb_blk(struct edid_tags *etags, u_int8_t *db, u_int8_t
         for (count = 0; count < vfpdbl; count++) {
                 u_int8_t vic = vfpdb[count];
 
-                if ((vic > 0 && vic < 128) || (vic > 192 && vic < 254))
+                if ((vic > 0 && vic < 128) || (vic > 192 && vic < 254)) {
                         etags->vics_preferred[count] = vic;
-                else if (vic >= 128 && vic <= 144)
-                        /* todo: convert VIC to DTD */
-                        edid_warn("Not handling VIC %d in pref block for now\n", vic);
-                else
+                        if (!etags->vic_caps[vic].pref_rank)
+                                etags->vic_caps[vic].pref_rank = count + 1;
+                } else if (vic >= 129 && vic <= 144) {
+                        /* Ranked by edid_build_mode_index() */
+                        edid_debug("DTD %d listed in pref block\n", vic - 128);
+                } else {
                         edid_warn("Invalid VIC %d listed in pref block\n", vic);
+                        edid_report_db(info, EDID_DIAG_WARN, EDID_DIAG_BAD_VIC, vic);
+                }
         }
 
         edid_debug("Found %d modes in video preference block\n", count);
 }
 
 static void
-parse_cea_ext_extended_ycbcr420_cmdb_blk(struct edid_info *info, u_int8_t *db, u_int8_t dblen)
+parse_cea_ext_extended_ycbcr420_cmdb_blk(struct edid_info *info, u_int8_t *db, u_int8_t dblen, void *data)
 {
-        u_int8_t vdbl;
         u_int8_t count;
         u_int8_t total;
-        u_int8_t vic_index;
-        u_int8_t *vdb;
+        unsigned int vic_index;
         u_int8_t *cmdb = db;
         u_int8_t cmdbl = dblen;
         struct edid_tags *etags = &info->cea_blks;
+        bool native;
 
         if (!cmdbl) {
                 edid_warn("Invalid 4:2:0 CMDB len %d\n", cmdbl);
+                edid_report_db(info, EDID_DIAG_WARN, EDID_DIAG_BAD_DB_LEN, cmdbl);
                 return;
         }
 
@@ -399,14 +841,12 @@ parse_cea_ext_extended_ycbcr420_cmdb_blk(struct edid_info *info, u_int8_t *db, u
          * This means we need VDB block also here
          */
 
-        vdb = find_data_block_in_edid(info, &vdbl, CEA_DATA_BLOCK_VIDEO);
-        if (!vdb || !vdbl) {
+        if (!libedid_find_db(info, CEA_DATA_BLOCK_VIDEO, 0)) {
                 edid_error("420 CMDB set, but no VDB found\n");
+                edid_report_db(info, EDID_DIAG_WARN, EDID_DIAG_CMDB_NO_VDB, 0);
                 return;
         }
 
-        /* First byte in VDB is tag */
-        vdb +=1;
         total = 0;
         vic_index = 0;
 
@@ -418,8 +858,18 @@ parse_cea_ext_extended_ycbcr420_cmdb_blk(struct edid_info *info, u_int8_t *db, u
                         u_int8_t vic;
 
                         if (byte & (1 << pos)) {
-                                vic = find_vic_from_pos(vdb, vic_index);
-                                set_vic(etags->vics_420_also, vic);
+                                vic = find_vic_from_pos(info, vic_index);
+                                if (!vic) {
+                                        edid_warn("CMDB bit %d has no SVD\n", vic_index);
+                                        edid_report_db(info, EDID_DIAG_WARN,
+                                                EDID_DIAG_CMDB_NO_SVD, vic_index);
+                                        vic_index++;
+                                        continue;
+                                }
+
+                                vic = set_vic(etags->vics_420_also, vic, &native);
+                                if (vic)
+                                        set_vic_caps(info, vic, EDID_VIC_CAP_420_ALSO);
                                 edid_debug("VIC %d(index %d) is 420_also mode\n", vic, vic_index);
                                 total++;
                         }
@@ -433,14 +883,17 @@ parse_cea_ext_extended_ycbcr420_cmdb_blk(struct edid_info *info, u_int8_t *db, u
 }
 
 static void
-parse_cea_ext_extended_ycbcr420_vdb_blk(struct edid_tags *etags, u_int8_t *db, u_int8_t dblen)
+parse_cea_ext_extended_ycbcr420_vdb_blk(struct edid_info *info, u_int8_t *db, u_int8_t dblen, void *data)
 {
+        struct edid_tags *etags = &info->cea_blks;
         u_int8_t *vdb = db;
         u_int8_t vdbl = dblen;
         u_int8_t count;
+        bool native;
 
         if (!vdbl) {
                 edid_warn("Invalid 4:2:0 VDB len %d\n", vdbl);
+                edid_report_db(info, EDID_DIAG_WARN, EDID_DIAG_BAD_DB_LEN, vdbl);
                 return;
         }
 
@@ -452,9 +905,14 @@ parse_cea_ext_extended_ycbcr420_vdb_blk(struct edid_tags *etags, u_int8_t *db, u
                 u_int8_t vic = vdb[count];
 
                 if (vic) {
-                        vic = set_vic(etags->vics_420_only, vic);
-                        if (vic)
-                        /* Found a native 4:2:0 vic */
+                        vic = set_vic(etags->vics_420_only, vic, &native);
+                        if (!vic)
+                                continue;
+
+                        set_vic_caps(info, vic, EDID_VIC_CAP_420_ONLY |
+                                (native ? EDID_VIC_CAP_NATIVE : 0));
+                        if (native)
+                                /* Found a native 4:2:0 vic */
                                 etags->native_vic = vic;
                 }
         }
@@ -463,20 +921,43 @@ parse_cea_ext_extended_ycbcr420_vdb_blk(struct edid_tags *etags, u_int8_t *db, u
 }
 
 static void
-parse_cea_ext_extended_ifdb_blk(struct edid_tags *etags, u_int8_t *db, u_int8_t dblen)
+parse_cea_ext_extended_ifdb_blk(struct edid_info *info, u_int8_t *db, u_int8_t dblen, void *data)
 {
         u_int8_t *ifdb = db;
         u_int8_t ifdbl = dblen;
+        struct edid_tags *etags = &info->cea_blks;
 
-        if (!ifdbl) {
+        if (ifdbl < 2) {
                 edid_warn("Invalid IFDB len %d\n", ifdbl + 1);
+                edid_report_db(info, EDID_DIAG_WARN, EDID_DIAG_BAD_DB_LEN, ifdbl);
+                return;
+        }
+
+        /* Only one IFDB is allowed, keep the first */
+        if (etags->ifdb.data_len) {
+                edid_debug("Skipping another IFDB\n");
                 return;
         }
 
-        etags->ifdb.data_len = ifdb[0] & 0xE0;
+        etags->ifdb.data_len = cea_ifdb_payload_len(ifdb, ifdbl);
         etags->ifdb.num_vsif = ifdb[1];
+        if (!etags->ifdb.data_len)
+                return;
+
+        etags->ifdb.view = edid_make_view(info, &ifdb[2], etags->ifdb.data_len);
+        if (info->flags & EDID_PARSE_VIEWS) {
+                etags->ifdb.data = &ifdb[2];
+                return;
+        }
+
+        etags->ifdb.data = edid_alloc(info, etags->ifdb.data_len);
+        if (!etags->ifdb.data) {
+                edid_error("Out of memory for IFDB\n");
+                edid_report_db(info, EDID_DIAG_ERROR, EDID_DIAG_NO_MEMORY, EDID_DECODE_MISC);
+                etags->ifdb.data_len = 0;
+                return;
+        }
 
-        etags->ifdb.data = malloc(etags->ifdb.data_len);
         memcpy((void *)etags->ifdb.data, (const void *)&(ifdb[2]), etags->ifdb.data_len);
         edid_debug("Found EXT IFDB, data len %d, num_vsif %d\n",
                 etags->ifdb.data_len,
@@ -484,31 +965,55 @@ parse_cea_ext_extended_ifdb_blk(struct edid_tags *etags, u_int8_t *db, u_int8_t
 }
 
 static void
-parse_cea_ext_extended_vsvdb_blk(struct edid_tags *etags, u_int8_t *db, u_int8_t dblen)
+parse_cea_ext_extended_vsvdb_blk(struct edid_info *info, u_int8_t *db, u_int8_t dblen, void *data)
 {
         u_int8_t *vsvdb = db;
         u_int8_t vsvdbl = dblen;
+        struct edid_tags *etags = &info->cea_blks;
 
         if (vsvdbl < 4) {
                 edid_warn("Invalid VSVDB len %d\n", vsvdbl + 1);
+                edid_report_db(info, EDID_DIAG_WARN, EDID_DIAG_BAD_DB_LEN, vsvdbl);
+                return;
+        }
+
+        /* The first one in EDID order, the others are in the db index */
+        if (etags->vsvdb.datalen) {
+                edid_debug("Skipping another VSVDB\n");
                 return;
         }
 
         etags->vsvdb.oui = (vsvdb[2] << 16 | vsvdb[1] << 8 | vsvdb[0]);
-        etags->vsvdb.data = malloc(vsvdbl - 3);
-        memcpy((void *) etags->vsvdb.data, (const void *)&vsvdb[3], vsvdbl - 3);
+        etags->vsvdb.view = edid_make_view(info, &vsvdb[3], vsvdbl - 3);
+        if (info->flags & EDID_PARSE_VIEWS) {
+                etags->vsvdb.data = &vsvdb[3];
+        } else {
+                etags->vsvdb.data = edid_alloc(info, vsvdbl - 3);
+                if (!etags->vsvdb.data) {
+                        edid_error("Out of memory for VSVDB\n");
+                        edid_report_db(info, EDID_DIAG_ERROR, EDID_DIAG_NO_MEMORY,
+                                EDID_DECODE_VSDB);
+                        return;
+                }
+
+                memcpy((void *) etags->vsvdb.data, (const void *)&vsvdb[3], vsvdbl - 3);
+        }
+
+        etags->vsvdb.datalen = vsvdbl - 3;
         edid_debug("Found EXT VSVDB, len %d, vendor id 0x%x\n",
                 vsvdbl + 1,
                 etags->vsvdb.oui);
 }
 
 static void
-parse_cea_ext_extended_vcapability_blk(struct edid_tags *etags, u_int8_t *db, u_int8_t dblen)
+parse_cea_ext_extended_vcapability_blk(struct edid_info *info, u_int8_t *db, u_int8_t dblen, void *data)
 {
+        struct edid_tags *etags = &info->cea_blks;
         u_int8_t vcap_info;
 
         if (dblen != 1) {
                 edid_warn("Ignoring video capabiliity block with invalid length %d\n", dblen);
+                edid_report_db(info, EDID_DIAG_WARN, EDID_DIAG_BAD_DB_LEN, dblen);
                 return;
         }
 
@@ -528,12 +1033,14 @@ parse_cea_ext_extended_vcapability_blk(struct edid_tags *etags, u_int8_t *db, u_
 }
 
 static void
-parse_cea_ext_extended_colorimetry_blk(struct edid_tags *etags, u_int8_t *db, u_int8_t dblen)
+parse_cea_ext_extended_colorimetry_blk(struct edid_info *info, u_int8_t *db, u_int8_t dblen, void *data)
 {
+        struct edid_tags *etags = &info->cea_blks;
         u_int8_t clr_info;
 
         if (dblen != 2) {
                 edid_warn("Ignoring colorimetry block with invalid length %d\n", dblen);
+                edid_report_db(info, EDID_DIAG_WARN, EDID_DIAG_BAD_DB_LEN, dblen);
                 return;
         }
 
@@ -562,106 +1069,39 @@ parse_cea_ext_extended_colorimetry_blk(struct edid_tags *etags, u_int8_t *db, u_
                 etags->colorimetry.xvYCC_601);
 }
 
-static void parse_cea_ext_extended_block(struct edid_info *info, u_int8_t *edb, u_int8_t dblen)
+static void parse_cea_ext_vesa_block(struct edid_info *info, u_int8_t *db, u_int8_t dblen, void *data)
 {
-        /* First byte is extended tag, and its counted in dblen */
-        u_int8_t extag = edb[0];
-        u_int8_t *db = &edb[1];
-        u_int8_t dbl = dblen -1;
-        struct edid_tags *etags = &info->cea_blks;
+        /* Todo: Parse VESA timing block */
+        edid_warn("Vesa timing block parsing is not yet supported\n");
+        edid_report_db(info, EDID_DIAG_INFO, EDID_DIAG_UNSUPPORTED_DB, CEA_DATA_BLOCK_VESA_DTC << 8);
+}
 
-        edid_debug("CEA Extended DATA BLOCK Type: %s\n", cea_extended_tag_names[extag]);
+static void parse_cea_ext_speaker_block(struct edid_info *info, u_int8_t *db, u_int8_t dblen, void *data)
+{
+        /* Todo: Parse speaker block */
+        edid_warn("Speaker block parsing is not yet supported\n");
+        edid_report_db(info, EDID_DIAG_INFO, EDID_DIAG_UNSUPPORTED_DB, CEA_DATA_BLOCK_SPEAKER_ALLOC << 8);
+}
 
-        /* Todo: Handling only limited blocks now, that too video */
-        switch (extag) {
-        /* Video Capability Data Block */
-        case CEA_DATA_BLOCK_EXT_VCDB:
-                parse_cea_ext_extended_vcapability_blk(etags, db, dbl);
-                break;
+static void parse_cea_ext_audio_block(struct edid_info *info, u_int8_t *db, u_int8_t dblen, void *data)
+{
+        /* Todo: Parse audio block */
+        edid_warn("Audio block parsing is not yet supported\n");
+        edid_report_db(info, EDID_DIAG_INFO, EDID_DIAG_UNSUPPORTED_DB, CEA_DATA_BLOCK_AUDIO << 8);
+}
 
-        /* Vendor-Specific Video Data Block */
-        case CEA_DATA_BLOCK_EXT_VSVDB:
-                parse_cea_ext_extended_vsvdb_blk(etags, db, dbl);
-                break;
+static void parse_hdmi_hf_vsdb(struct edid_info *info, u_int8_t *db, u_int8_t dblen)
+{
+        struct edid_tags *etags = &info->cea_blks;
 
-        /* Colorimetry Data Block */
-        case CEA_DATA_BLOCK_EXT_COLORIMETRY:
-                parse_cea_ext_extended_colorimetry_blk(etags, db, dbl);
-                break;
- 
-        /* HDR Static Metadata Data Block */
-        case CEA_DATA_BLOCK_EXT_HDR_STATIC_MD:
-                parse_cea_ext_extended_hdr_static_md_blk(etags, db, dbl);
-                break;
+        if (dblen < 4) {
+                edid_warn("Invalid hf-vsdb data length %d\n", dblen);
+                edid_report_db(info, EDID_DIAG_WARN, EDID_DIAG_BAD_DB_LEN, dblen + 3);
+                return;
+        }
 
-        /* HDR Dynamic Metadata Data Block */
-        case CEA_DATA_BLOCK_EXT_HDR_DYNAMIC_MD:
-                parse_cea_ext_extended_hdr_dynamic_md_blk(etags, db, dbl);
-                break;
-
-        /* Video Format Preference Data Block */
-        case CEA_DATA_BLOCK_EXT_VF_PREF:
-                parse_cea_ext_extended_vfpdb_blk(etags, db, dbl);
-                break;
- 
-        /* YCBCR 4:2:0 Video Data Block */
-        case CEA_DATA_BLOCK_EXT_YCBCR420_VDB:
-                parse_cea_ext_extended_ycbcr420_vdb_blk(etags, db, dbl);
-                break;
-
-        /* YCBCR 4:2:0 Capability Map Data Block */
-        case CEA_DATA_BLOCK_EXT_YCBCR420_CMDB:
-                parse_cea_ext_extended_ycbcr420_cmdb_blk(info, db, dbl);
-                break;
-
-        /* Infoframe data block */
-        case CEA_DATA_BLOCK_EXT_IFDB:
-                parse_cea_ext_extended_ifdb_blk(etags, db, dbl);
-                break;
-
-        /* VESA Display Device Data Block */
-        case CEA_DATA_BLOCK_EXT_VDDDB:
-                /* Todo: This is a separate spec, no details found in CEA-861-G,
-                 * so can't process this as of now */
-
-        /*VESA Video Timing Block Extension */
-        case CEA_DATA_BLOCK_EXT_VVTBE:
-                /* Todo: This is a separate spec, no details found in CEA-861-G,
-                 * so can't process this as of now */
-
-        default:
-                edid_warn("Not handling extended tag 0x%x\n", extag);
-                return;
-        }
-}
-
-static void parse_cea_ext_vesa_block(struct edid_tags *etags, u_int8_t *db, u_int8_t dblen)
-{
-        /* Todo: Parse VESA timing block */
-        edid_warn("Vesa timing block parsing is not yet supported\n");
-}
-
-static void parse_cea_ext_speaker_block(struct edid_tags *etags, u_int8_t *db, u_int8_t dblen)
-{
-        /* Todo: Parse speaker block */
-        edid_warn("Speaker block parsing is not yet supported\n");
-}
-
-static void parse_cea_ext_audio_block(struct edid_tags *etags, u_int8_t *db, u_int8_t dblen)
-{
-        /* Todo: Parse audio block */
-        edid_warn("Audio block parsing is not yet supported\n");
-}
-
-static void parse_hdmi_hf_vsdb(struct edid_tags *etags, u_int8_t *db, u_int8_t dblen)
-{
-        if (dblen < 4) {
-                edid_warn("Invalid hf-vsdb data length %d\n", dblen);
-                return;
-        }
-
-        etags->hfvsdb.version = db[0];
-        etags->hfvsdb.max_tmds_rate_mhz = db[1] * 5;
+        etags->hfvsdb.version = db[0];
+        etags->hfvsdb.max_tmds_rate_mhz = db[1] * 5;
 
         etags->hfvsdb.scdc = CHECK_BIT(db[2], HDVSDB_SCDC_BIT);
         etags->hfvsdb.rr = CHECK_BIT(db[2], HDVSDB_RR_BIT);
@@ -670,6 +1110,7 @@ static void parse_hdmi_hf_vsdb(struct edid_tags *etags, u_int8_t *db, u_int8_t d
         etags->hfvsdb.dv = CHECK_BIT(db[2], HDVSDB_DV_BIT);
         etags->hfvsdb.osd_3d = CHECK_BIT(db[2], HDVSDB_3D_OSD_BIT);
 
+        etags->hfvsdb.max_frl_rate = db[3] >> 4;
         etags->hfvsdb.dc_48_420 = CHECK_BIT(db[3], HDVSDB_DC_420_16BPC);
         etags->hfvsdb.dc_36_420 = CHECK_BIT(db[3], HDVSDB_DC_420_12BPC);
         etags->hfvsdb.dc_30_420 = CHECK_BIT(db[3], HDVSDB_DC_420_10BPC);
@@ -679,16 +1120,20 @@ static void parse_hdmi_hf_vsdb(struct edid_tags *etags, u_int8_t *db, u_int8_t d
                 YESNO(etags->hfvsdb.scdc),
                 YESNO(etags->hfvsdb.scrambling_340mhz));
         
+        edid_debug("HF-VSDB: Max FRL rate:%d\n", etags->hfvsdb.max_frl_rate);
         edid_debug("4:2:0 deep color 16 BPC:%s 12 BPC:%s 10 BPC:%s\n",
                 YESNO(etags->hfvsdb.dc_48_420),
                 YESNO(etags->hfvsdb.dc_36_420),
                 YESNO(etags->hfvsdb.dc_30_420));
 }
 
-static void parse_hdmi_vsdb(struct edid_tags *etags, u_int8_t *db, u_int8_t dblen)
+static void parse_hdmi_vsdb(struct edid_info *info, u_int8_t *db, u_int8_t dblen)
 {
+        struct edid_tags *etags = &info->cea_blks;
+
         if (dblen < 2) {
                 edid_warn("Ignoring hdmi VSDB length %d < 2\n", dblen);
+                edid_report_db(info, EDID_DIAG_WARN, EDID_DIAG_BAD_DB_LEN, dblen + 3);
                 return;
         }
 
@@ -728,31 +1173,54 @@ static void parse_hdmi_vsdb(struct edid_tags *etags, u_int8_t *db, u_int8_t dble
                 YESNO(etags->hdmi_vsdb.dc_30_bpc));
 }
 
-static void parse_cea_ext_vendor_block(struct edid_tags *etags, u_int8_t *db, u_int8_t dblen)
+static void parse_cea_ext_vendor_block(struct edid_info *info, u_int8_t *db, u_int8_t dblen, void *data)
 {
         u_int8_t *vsdb = db;
         u_int8_t vsdbl = dblen;
+        struct edid_tags *etags = &info->cea_blks;
+        u_int32_t oui;
 
         if (vsdbl < 4) {
                 edid_warn("Invalid VSDB len %d\n", vsdbl + 1);
+                edid_report_db(info, EDID_DIAG_WARN, EDID_DIAG_BAD_DB_LEN, vsdbl);
                 return;
         }
 
-        etags->vsdb.oui = vsdb[2] << 16 | vsdb[1] << 8 | vsdb[0];
+        oui = vsdb[2] << 16 | vsdb[1] << 8 | vsdb[0];
+        if (oui == HDMI_IEEE_OUI) {
+                parse_hdmi_vsdb(info, &vsdb[3], vsdbl - 3);
+                return;
+        }
 
-        if (etags->vsdb.oui == HDMI_IEEE_OUI) {
-                parse_hdmi_vsdb(etags, &vsdb[3], vsdbl - 3);
+        if (oui == HDMI_FORUM_IEEE_OUI) {
+                parse_hdmi_hf_vsdb(info, &vsdb[3], vsdbl - 3);
                 return;
         }
 
-        if (etags->vsdb.oui == HDMI_FORUM_IEEE_OUI) {
-                parse_hdmi_hf_vsdb(etags, &vsdb[3], vsdbl - 3);
+        /* The first one in EDID order, the others are in the db index */
+        if (etags->vsdb.datalen) {
+                edid_debug("Skipping another VSDB, vendor oui 0x%x\n", oui);
                 return;
         }
 
+        etags->vsdb.oui = oui;
+
+        etags->vsdb.view = edid_make_view(info, &vsdb[3], vsdbl - 3);
+        if (info->flags & EDID_PARSE_VIEWS) {
+                etags->vsdb.data = &vsdb[3];
+        } else {
+                etags->vsdb.data = edid_alloc(info, vsdbl - 3);
+                if (!etags->vsdb.data) {
+                        edid_error("Out of memory for VSDB\n");
+                        edid_report_db(info, EDID_DIAG_ERROR, EDID_DIAG_NO_MEMORY,
+                                EDID_DECODE_VSDB);
+                        return;
+                }
+
+                memcpy((void *) etags->vsdb.data, (const void *)&vsdb[3], vsdbl - 3);
+        }
+
         etags->vsdb.datalen = vsdbl - 3;
-        etags->vsdb.data = malloc(vsdbl - 3);
-        memcpy((void *) etags->vsdb.data, (const void *)&vsdb[3], vsdbl - 3);
         edid_debug("Found VSDB, len %d, vendor oui 0x%x data %d\n",
                 vsdbl,
                 etags->vsdb.oui,
@@ -760,72 +1228,260 @@ static void parse_cea_ext_vendor_block(struct edid_tags *etags, u_int8_t *db, u_
 }
 
 static void
-parse_cea_ext_video_block(struct edid_tags *etags, u_int8_t *db, u_int8_t dblen)
+parse_cea_ext_video_block(struct edid_info *info, u_int8_t *db, u_int8_t dblen, void *data)
 {
+        struct edid_tags *etags = &info->cea_blks;
         u_int8_t *vdb = db;
         u_int8_t vdbl = dblen;
         u_int8_t count;
+        bool native;
 
         edid_debug("Parsing video block, dblen %d\n", dblen);
         for (count = 0; count < vdbl; count++) {
                 uint8_t vic = vdb[count];
 
                 if (vic) {
-                        vic = set_vic(etags->vics, vic);
-                        if (vic)
+                        vic = set_vic(etags->vics, vic, &native);
+                        if (!vic)
+                                continue;
+
+                        set_vic_caps(info, vic, EDID_VIC_CAP_SUPPORTED |
+                                (native ? EDID_VIC_CAP_NATIVE : 0));
+                        if (native)
                                 /* Found native mode */
                                 etags->native_vic = vic;
                 }
         }
 }
 
-static void
-parse_cea_data_block(struct edid_info *info, u_int8_t *db, u_int8_t dblen)
+/*
+ * Data block dispatch. Every (tag, extended tag) pair has its own slot,
+ * so dispatching is one table lookup, however many blocks we handle.
+ * Applications can replace, add or disable handlers per slot, and add
+ * handlers for vendor specific blocks by OUI.
+ */
+#define EDID_DB_SLOT(tag, ext_tag) ((tag) == CEA_DATA_BLOCK_EXTENDED ? \
+                CEA_DATA_BLOCK_EXTENDED + 1 + (ext_tag) : (tag))
+#define EDID_DB_N_SLOTS (CEA_DATA_BLOCK_EXTENDED + 1 + 256)
+#define EDID_EXT_SLOT(ext_tag) EDID_DB_SLOT(CEA_DATA_BLOCK_EXTENDED, ext_tag)
+
+static const libedid_db_handler edid_builtin_db_handlers[EDID_DB_N_SLOTS] = {
+        [CEA_DATA_BLOCK_AUDIO] = parse_cea_ext_audio_block,
+        [CEA_DATA_BLOCK_VIDEO] = parse_cea_ext_video_block,
+        [CEA_DATA_BLOCK_VENDOR] = parse_cea_ext_vendor_block,
+        [CEA_DATA_BLOCK_SPEAKER_ALLOC] = parse_cea_ext_speaker_block,
+        [CEA_DATA_BLOCK_VESA_DTC] = parse_cea_ext_vesa_block,
+        [EDID_EXT_SLOT(CEA_DATA_BLOCK_EXT_VCDB)] = parse_cea_ext_extended_vcapability_blk,
+        [EDID_EXT_SLOT(CEA_DATA_BLOCK_EXT_VSVDB)] = parse_cea_ext_extended_vsvdb_blk,
+        [EDID_EXT_SLOT(CEA_DATA_BLOCK_EXT_COLORIMETRY)] = parse_cea_ext_extended_colorimetry_blk,
+        [EDID_EXT_SLOT(CEA_DATA_BLOCK_EXT_HDR_STATIC_MD)] = parse_cea_ext_extended_hdr_static_md_blk,
+        [EDID_EXT_SLOT(CEA_DATA_BLOCK_EXT_HDR_DYNAMIC_MD)] = parse_cea_ext_extended_hdr_dynamic_md_blk,
+        [EDID_EXT_SLOT(CEA_DATA_BLOCK_EXT_VF_PREF)] = parse_cea_ext_extended_vfpdb_blk,
+        [EDID_EXT_SLOT(CEA_DATA_BLOCK_EXT_YCBCR420_VDB)] = parse_cea_ext_extended_ycbcr420_vdb_blk,
+        [EDID_EXT_SLOT(CEA_DATA_BLOCK_EXT_YCBCR420_CMDB)] = parse_cea_ext_extended_ycbcr420_cmdb_blk,
+        [EDID_EXT_SLOT(CEA_DATA_BLOCK_EXT_IFDB)] = parse_cea_ext_extended_ifdb_blk,
+};
+
+struct edid_db_handler {
+        /* NULL means the built-in handler */
+        libedid_db_handler handler;
+        void *data;
+        bool disabled;
+};
+
+static struct edid_db_handler edid_db_handlers[EDID_DB_N_SLOTS];
+
+/* Registered OUI handlers, open addressed by (slot, OUI) */
+#define EDID_OUI_N_HANDLERS 32
+
+struct edid_oui_handler {
+        u_int32_t oui;
+        u_int16_t slot;
+        bool used;
+        libedid_db_handler handler;
+        void *data;
+};
+
+static struct edid_oui_handler edid_oui_handlers[EDID_OUI_N_HANDLERS];
+static unsigned int edid_n_oui_handlers;
+
+static inline unsigned int
+edid_oui_hash(u_int16_t slot, u_int32_t oui)
 {
-        enum cea_data_block_tags tag;
-        struct edid_tags *etags = &info->cea_blks;
+        return ((oui ^ (slot << 24)) * 2654435761u) >> 27;
+}
 
-        tag = CEA_EXT_BLK_TAG(db[0]);
-        if (!dblen) {
-                edid_error("Skipping invalid sized(%d) block tag %d\n", dblen, tag);
-                return;
+static struct edid_oui_handler
+*edid_find_oui_handler(u_int16_t slot, u_int32_t oui, bool alloc)
+{
+        unsigned int i, h = edid_oui_hash(slot, oui);
+
+        for (i = 0; i < EDID_OUI_N_HANDLERS; i++) {
+                struct edid_oui_handler *oh =
+                        &edid_oui_handlers[(h + i) % EDID_OUI_N_HANDLERS];
+
+                if (!oh->used)
+                        return alloc ? oh : NULL;
+
+                if (oh->slot == slot && oh->oui == oui)
+                        return oh;
         }
 
-        switch (tag) {
-        case CEA_DATA_BLOCK_VIDEO:
-                parse_cea_ext_video_block(etags, db + 1, dblen);
-                break;
+        return NULL;
+}
 
-        case CEA_DATA_BLOCK_VENDOR:
-                parse_cea_ext_vendor_block(etags, db + 1, dblen);
-                break;
+/* Vendor specific blocks, which start with an OUI */
+static inline bool
+edid_db_slot_has_oui(u_int16_t slot)
+{
+        return slot == CEA_DATA_BLOCK_VENDOR ||
+                slot == EDID_EXT_SLOT(CEA_DATA_BLOCK_EXT_VSVDB) ||
+                slot == EDID_EXT_SLOT(CEA_DATA_BLOCK_EXT_VSADB);
+}
 
-        case CEA_DATA_BLOCK_EXTENDED:
-                parse_cea_ext_extended_block(info, db + 1, dblen);
-                break;
+static bool
+edid_db_slot_valid(u_int8_t tag)
+{
+        return tag <= CEA_DATA_BLOCK_EXTENDED;
+}
 
-        case CEA_DATA_BLOCK_AUDIO:
-                /* Todo: Support audio data processing */
-                parse_cea_ext_audio_block(etags, db + 1, dblen);
-                break;
+int libedid_register_db_handler(u_int8_t tag, u_int8_t ext_tag,
+                libedid_db_handler handler, void *data)
+{
+        struct edid_db_handler *h;
 
-        case CEA_DATA_BLOCK_SPEAKER_ALLOC:
-                /* Todo: Support speaker data processing */
-                parse_cea_ext_speaker_block(etags, db + 1, dblen);
-                break;
+        if (!edid_db_slot_valid(tag))
+                return -1;
 
-        case CEA_DATA_BLOCK_VESA_DTC:
-                /* Todo: This is a diff spec, not handling this block now */
-                parse_cea_ext_vesa_block(etags, db + 1, dblen);
-                break;
+        h = &edid_db_handlers[EDID_DB_SLOT(tag, ext_tag)];
+        h->handler = handler;
+        h->data = handler ? data : NULL;
+        return 0;
+}
 
-        case CEA_DATA_BLOCK_RESERVED_2:
-        case CEA_DATA_BLOCK_RESERVED:
-        default:
-                edid_warn("Invalid data block type %d\n", tag);
+int libedid_register_oui_handler(u_int8_t tag, u_int8_t ext_tag, u_int32_t oui,
+                libedid_db_handler handler, void *data)
+{
+        u_int16_t slot;
+        struct edid_oui_handler *oh;
+
+        if (!edid_db_slot_valid(tag))
+                return -1;
+
+        slot = EDID_DB_SLOT(tag, ext_tag);
+        if (!edid_db_slot_has_oui(slot))
+                return -1;
+
+        oh = edid_find_oui_handler(slot, oui, handler != NULL);
+        if (!oh)
+                return handler ? -1 : 0;
+
+        if (!handler) {
+                /* Deleting from an open addressed table: re-add the rest of the run */
+                struct edid_oui_handler run[EDID_OUI_N_HANDLERS];
+                unsigned int n = 0, i = oh - edid_oui_handlers;
+
+                oh->used = false;
+                edid_n_oui_handlers--;
+                for (i = (i + 1) % EDID_OUI_N_HANDLERS; edid_oui_handlers[i].used;
+                                i = (i + 1) % EDID_OUI_N_HANDLERS) {
+                        run[n++] = edid_oui_handlers[i];
+                        edid_oui_handlers[i].used = false;
+                }
+
+                while (n--)
+                        *edid_find_oui_handler(run[n].slot, run[n].oui, true) = run[n];
+                return 0;
         }
+
+        if (!oh->used) {
+                oh->used = true;
+                oh->slot = slot;
+                oh->oui = oui;
+                edid_n_oui_handlers++;
+        }
+
+        oh->handler = handler;
+        oh->data = data;
+        return 0;
+}
+
+int libedid_enable_db_handler(u_int8_t tag, u_int8_t ext_tag, bool enable)
+{
+        if (!edid_db_slot_valid(tag))
+                return -1;
+
+        edid_db_handlers[EDID_DB_SLOT(tag, ext_tag)].disabled = !enable;
+        return 0;
+}
+
+static const char
+*edid_db_name(const struct edid_db_entry *entry)
+{
+        if (entry->tag != CEA_DATA_BLOCK_EXTENDED)
+                return cea_db_names[entry->tag] ? cea_db_names[entry->tag] : "Reserved";
+
+        if (entry->ext_tag < sizeof(cea_extended_tag_names) / sizeof(cea_extended_tag_names[0]) &&
+                        cea_extended_tag_names[entry->ext_tag])
+                return cea_extended_tag_names[entry->ext_tag];
+
+        return "Unknown extended block";
 }
 
+/* db points to the tag byte of the indexed data block entry */
+static void
+edid_dispatch_db(struct edid_info *info, const struct edid_db_entry *entry, u_int8_t *db)
+{
+        u_int16_t slot = EDID_DB_SLOT(entry->tag, entry->ext_tag);
+        struct edid_db_handler *h = &edid_db_handlers[slot];
+        libedid_db_handler handler;
+        u_int8_t *payload = db + 1;
+        u_int8_t len = entry->len;
+        void *data = h->data;
+
+        info->cur_db = entry - info->db_index.entries;
+        if (!len) {
+                edid_error("Skipping invalid sized(%d) block tag %d\n", len, entry->tag);
+                edid_report_db(info, EDID_DIAG_WARN, EDID_DIAG_BAD_DB_LEN, len);
+                return;
+        }
+
+        if (h->disabled)
+                return;
+
+        /* The extended tag is counted in the length */
+        if (entry->tag == CEA_DATA_BLOCK_EXTENDED) {
+                edid_debug("CEA Extended DATA BLOCK Type: %s\n", edid_db_name(entry));
+                payload++;
+                len--;
+        }
+
+        handler = h->handler ? h->handler : edid_builtin_db_handlers[slot];
+        if (edid_n_oui_handlers && len >= 3 && edid_db_slot_has_oui(slot)) {
+                struct edid_oui_handler *oh = edid_find_oui_handler(slot,
+                        payload[2] << 16 | payload[1] << 8 | payload[0], false);
+
+                /* OUI handlers get the payload after the OUI */
+                if (oh) {
+                        handler = oh->handler;
+                        data = oh->data;
+                        payload += 3;
+                        len -= 3;
+                }
+        }
+
+        if (!handler) {
+                if (entry->tag == CEA_DATA_BLOCK_EXTENDED)
+                        edid_warn("Not handling extended tag 0x%x\n", entry->ext_tag);
+                else
+                        edid_warn("Invalid data block type %d\n", entry->tag);
+                edid_report_db(info, EDID_DIAG_INFO, EDID_DIAG_UNHANDLED_DB,
+                        entry->tag << 8 | entry->ext_tag);
+                return;
+        }
+
+        handler(info, payload, len, data);
+}
 static void extract_dtd_mode(u_int8_t *db, struct detailed_mode *mode)
 {
         memset(mode, 0, sizeof(struct detailed_mode));
@@ -878,123 +1534,344 @@ static void extract_dtd_mode(u_int8_t *db, struct detailed_mode *mode)
                 mode->vborder_2);
 }
 
-static void parse_cea_dtd_block(struct edid_tags *etags, u_int8_t *db)
+/* DTDs of all the CEA blocks, capped to what a u_int8_t can index */
+static u_int8_t
+edid_cea_n_dtds(u_int8_t *raw_edid, unsigned int n_blks)
+{
+        struct edid_blk_reader r;
+        unsigned int blk, n = 0;
+
+        for_each_ext_blk(r, raw_edid, n_blks, blk) {
+                u_int8_t *cea = &raw_edid[blk * CEA_EXTN_BLK_SIZE];
+
+                if (cea[0] == CEA_EXT_BLK_TAG_VALUE && cea[2] >= 4)
+                        n += cea_n_dtd_modes(cea);
+        }
+
+        return n > 255 ? 255 : n;
+}
+
+/* Append the DTDs of this block to dtd.d_modes, sized by edid_cea_n_dtds() */
+static void parse_cea_dtd_block(struct edid_info *info, u_int8_t *cea, struct edid_ext_blk *rec)
 {
         u_int8_t count;
-        u_int8_t blk_sz;
-        struct dtd_blk *dtdb = &etags->dtd;
+        struct dtd_blk *dtdb = &info->cea_blks.dtd;
+        u_int8_t *db = &cea[cea[2]];
+        u_int8_t n = cea_n_dtd_modes(cea);
 
-        if (!etags->n_dtd_blks) {
+        rec->first_dtd = dtdb->n_dtd_modes;
+        rec->n_dtds = 0;
+        if (!n) {
                 edid_debug("No DTD found in CEA Extension block\n");
                 return;
         }
 
-        dtdb->n_dtd_modes = etags->n_dtd_blks;
-        blk_sz = etags->n_dtd_blks * sizeof(struct detailed_mode);
-        dtdb->d_modes = malloc(blk_sz);
+        if (!dtdb->d_modes)
+                return;
+
+        if (n > 255 - dtdb->n_dtd_modes)
+                n = 255 - dtdb->n_dtd_modes;
 
         edid_debug("\n================================\n");
-        edid_debug("Found %d DTD modes\n", dtdb->n_dtd_modes);
-        for (count = 0; count < dtdb->n_dtd_modes; count++)
-                extract_dtd_mode(&db[count * 18], &dtdb->d_modes[count]);
+        edid_debug("Found %d DTD modes\n", n);
+        for (count = 0; count < n; count++)
+                extract_dtd_mode(&db[count * 18], &dtdb->d_modes[dtdb->n_dtd_modes++]);
         edid_debug("================================\n");
-        return;
+        rec->n_dtds = n;
+}
+
+/* Which decode group parses this data block */
+static u_int32_t
+edid_db_group(const struct edid_db_entry *entry)
+{
+        switch (entry->tag) {
+        case CEA_DATA_BLOCK_VIDEO:
+                return EDID_DECODE_VIDEO;
+
+        case CEA_DATA_BLOCK_VENDOR:
+                return EDID_DECODE_VSDB;
+
+        case CEA_DATA_BLOCK_EXTENDED:
+                if (!entry->len)
+                        return EDID_DECODE_MISC;
+
+                switch (entry->ext_tag) {
+                case CEA_DATA_BLOCK_EXT_VCDB:
+                case CEA_DATA_BLOCK_EXT_VF_PREF:
+                case CEA_DATA_BLOCK_EXT_YCBCR420_VDB:
+                case CEA_DATA_BLOCK_EXT_YCBCR420_CMDB:
+                        return EDID_DECODE_VIDEO;
+
+                case CEA_DATA_BLOCK_EXT_VSVDB:
+                        return EDID_DECODE_VSDB;
+
+                case CEA_DATA_BLOCK_EXT_COLORIMETRY:
+                        return EDID_DECODE_COLORIMETRY;
+
+                case CEA_DATA_BLOCK_EXT_HDR_STATIC_MD:
+                case CEA_DATA_BLOCK_EXT_HDR_DYNAMIC_MD:
+                        return EDID_DECODE_HDR;
+
+                default:
+                        return EDID_DECODE_MISC;
+                }
+
+        default:
+                return EDID_DECODE_MISC;
+        }
+}
+
+/*
+ * Parse the indexed CTA data blocks of extension block ext_blk, cursor is
+ * the first index entry of the block and is moved past its last one.
+ */
+static void
+edid_dispatch_blk_dbs(struct edid_info *info, u_int8_t *blk_data,
+                u_int8_t ext_blk, u_int16_t *cursor, u_int32_t groups)
+{
+        struct edid_db_index *idx = &info->db_index;
+        u_int8_t blk = 0;
+
+        while (*cursor < idx->n_entries &&
+                        idx->entries[*cursor].ext_blk == ext_blk) {
+                struct edid_db_entry *entry = &idx->entries[(*cursor)++];
+                u_int8_t start = entry->offset - ext_blk * CEA_EXTN_BLK_SIZE;
+                u_int8_t dblen = entry->len;
+
+                blk++;
+                if (!(edid_db_group(entry) & groups))
+                        continue;
+
+                if (!dblen) {
+                        edid_warn("Invalid dblen and/or tag %d/%d, skipping parsing data blocks\n",
+                        dblen, entry->tag);
+                }
+
+                edid_debug("\n================================\n");
+                edid_debug("CEA DATA BLOCK (%d) Type: %s\n", blk, cea_db_names[entry->tag]);
+                edid_debug("Bytes %d - %d (%d bytes + tag)\n", start, start + dblen, dblen);
+                edid_debug("=================================\n");
+                edid_dispatch_db(info, entry, &blk_data[start]);
+        }
 }
 
-void extract_cea_block_information(struct edid_info *info, u_int8_t *cea)
+void extract_cea_block_information(struct edid_info *info, u_int8_t *cea,
+                u_int8_t ext_blk, u_int16_t *cursor, u_int32_t groups)
 {
         u_int8_t tag = cea[0];
         u_int8_t d;
-        u_int8_t count = 0;
         struct edid_tags *etags = &info->cea_blks;
+        struct edid_ext_blk *rec = &info->ext_blks[ext_blk - 1];
 
         if (tag != CEA_EXT_BLK_TAG_VALUE) {
-                edid_error("Invalid CEA block tag %d\n", tag);
+                /* DisplayID blocks can carry CTA data blocks too */
+                if (groups & EDID_DECODE_CEA_HDR)
+                        edid_debug("Extension block %d is not a CEA block, tag 0x%x\n",
+                                ext_blk, tag);
+                edid_dispatch_blk_dbs(info, cea, ext_blk, cursor, groups);
                 return;
         }
 
         d = cea[2];
         if (d < 4) {
-                edid_warn("Empty/Bad CEA extenstion block, d=%d\n", d);
+                if (groups & EDID_DECODE_CEA_HDR) {
+                        edid_warn("Empty/Bad CEA extenstion block, d=%d\n", d);
+                        edid_report(info, EDID_DIAG_WARN, EDID_DIAG_BAD_EXT_BLK, ext_blk,
+                                ext_blk * CEA_EXTN_BLK_SIZE + 2, d);
+                }
                 return;
         }
 
-        etags->it_underscan = CHECK_BIT(cea[3], CEA_EXT_IT_UNDESCAN_BIT);
-        etags->audio = CHECK_BIT(cea[3], CEA_EXT_AUDIO_BIT);
-        etags->ycbcr444 = CHECK_BIT(cea[3], CEA_EXT_YCBCR444_BIT);
-        etags->ycbcr422 = CHECK_BIT(cea[3], CEA_EXT_YCBCR422_BIT);
-        etags->n_dtd_blks = cea[3] & 0xF;
+        if (groups & EDID_DECODE_CEA_HDR) {
+                rec->flags = (CHECK_BIT(cea[3], CEA_EXT_IT_UNDESCAN_BIT) ? EDID_EXT_BLK_UNDERSCAN : 0) |
+                        (CHECK_BIT(cea[3], CEA_EXT_AUDIO_BIT) ? EDID_EXT_BLK_AUDIO : 0) |
+                        (CHECK_BIT(cea[3], CEA_EXT_YCBCR444_BIT) ? EDID_EXT_BLK_YCBCR444 : 0) |
+                        (CHECK_BIT(cea[3], CEA_EXT_YCBCR422_BIT) ? EDID_EXT_BLK_YCBCR422 : 0);
+
+                /* Merged view: any block can turn these on */
+                if (!etags->revision)
+                        etags->revision = rec->revision;
+                etags->it_underscan |= !!(rec->flags & EDID_EXT_BLK_UNDERSCAN);
+                etags->audio |= !!(rec->flags & EDID_EXT_BLK_AUDIO);
+                etags->ycbcr444 |= !!(rec->flags & EDID_EXT_BLK_YCBCR444);
+                etags->ycbcr422 |= !!(rec->flags & EDID_EXT_BLK_YCBCR422);
+                etags->n_dtd_blks = etags->n_dtd_blks + rec->n_native_dtds > 255 ?
+                        255 : etags->n_dtd_blks + rec->n_native_dtds;
+
+                edid_debug("\n##############################\n");
+                edid_debug("##### CEA Exension block #####\n");
+                edid_debug("##############################\n");
+                edid_debug("Basic information of CEA extn block: d %d underscan %s audio %s\n",
+                        d,
+                        YESNO(rec->flags & EDID_EXT_BLK_UNDERSCAN),
+                        YESNO(rec->flags & EDID_EXT_BLK_AUDIO));
+
+                edid_debug("ycbcr444 %s 422 %s dtd blocks %d\n",
+                        YESNO(rec->flags & EDID_EXT_BLK_YCBCR444),
+                        YESNO(rec->flags & EDID_EXT_BLK_YCBCR422),
+                        rec->n_native_dtds);
+
+                edid_debug("CEA data block collection size = %d bytes\n", d - 4);
+        }
 
-        edid_debug("\n##############################\n");
-        edid_debug("##### CEA Exension block #####\n");
-        edid_debug("##############################\n");
-        edid_debug("Basic information of CEA extn block: d %d underscan %s audio %s\n",
-                d,
-                YESNO(etags->it_underscan),
-                YESNO(etags->audio));
-        
-        edid_debug("ycbcr444 %s 422 %s dtd blocks %d\n",
-                YESNO(etags->ycbcr444),
-                YESNO(etags->ycbcr422),
-                etags->n_dtd_blks);
-
-        edid_debug("CEA data block collection size = %d bytes\n", d - 4);
-
-        /* Parse CEA Data Block Collection */
-        if ( d != 4) {
-                u_int8_t start = 4;
-                u_int8_t blk = 0;
-
-                /* Data blocks are between bytes 4 and d */
-                while (start < d) {
-                        u_int8_t *db = &cea[start];
-                        u_int8_t dblen = CEA_EXT_BLK_DATA_LEN(cea[start]);
-                        u_int8_t tag = CEA_EXT_BLK_TAG(cea[start]);
-
-                        if (!dblen) {
-                                edid_warn("Invalid dblen and/or tag %d/%d, skipping parsing data blocks\n",
-                                dblen, CEA_EXT_BLK_TAG(tag));
-                        }
+        /* Parse CEA Data Block Collection, as indexed for this block */
+        if ( d != 4)
+                edid_dispatch_blk_dbs(info, cea, ext_blk, cursor, groups);
+
+        /* Parse detailed timing descriptor blocks */
+        if (groups & EDID_DECODE_DTD)
+                parse_cea_dtd_block(info, cea, rec);
+}
+
+/*
+ * Index all the CEA data blocks in one linear pass, so that the parser and
+ * the lookups never need to walk the raw EDID again. Entries stay in EDID
+ * order, and blocks with the same tag (or extended tag) are chained.
+ */
+static int
+edid_build_db_index(struct edid_info *info, u_int16_t n_db)
+{
+        struct edid_db_index *idx = &info->db_index;
+        u_int16_t last_tag[CEA_DATA_BLOCK_EXTENDED + 1];
+        u_int16_t last_ext_tag[256];
+        struct edid_blk_reader r;
+        unsigned int blk;
+
+        memset(idx->first_tag, 0xFF, sizeof(idx->first_tag));
+        memset(idx->first_ext_tag, 0xFF, sizeof(idx->first_ext_tag));
+        idx->n_entries = 0;
+
+        /* One record per extension block, block maps included */
+        if (info->cea_blks.n_cea_ext_blks) {
+                unsigned int n_ext = info->cea_blks.n_cea_ext_blks;
+
+                info->ext_blks = edid_alloc(info, n_ext * sizeof(struct edid_ext_blk));
+                if (!info->ext_blks) {
+                        edid_error("Out of memory for extension block records\n");
+                        edid_report(info, EDID_DIAG_ERROR, EDID_DIAG_NO_MEMORY, 0, 0,
+                                EDID_DECODE_BASE);
+                        return -1;
+                }
 
-                        edid_debug("\n================================\n");
-                        edid_debug("CEA DATA BLOCK (%d) Type: %s\n", ++blk, cea_db_names[tag]);
-                        edid_debug("Bytes %d - %d (%d bytes + tag)\n", start, start + dblen, dblen);
-                        edid_debug("=================================\n");
-                        parse_cea_data_block(info, db, dblen);
+                memset(info->ext_blks, 0, n_ext * sizeof(struct edid_ext_blk));
+                for (blk = 1; blk <= n_ext; blk++) {
+                        u_int8_t *ext = &info->raw_edid[blk * CEA_EXTN_BLK_SIZE];
+                        struct edid_ext_blk *rec = &info->ext_blks[blk - 1];
 
-                        /* The dblen doesn't include tag byte, so +1 */
-                        start +=  (dblen + 1);
+                        rec->tag = ext[0];
+                        rec->revision = ext[1];
+                        if (ext[0] == CEA_EXT_BLK_TAG_VALUE && ext[2] >= 4)
+                                rec->n_native_dtds = ext[3] & 0xF;
                 }
         }
 
-        /* Parse detailed timing descriptor blocks */
-        for (count = 0; count < etags->n_dtd_blks; count++)
-                parse_cea_dtd_block(etags, &cea[count * 18 + d]);
+        if (!n_db)
+                return 0;
+
+        idx->entries = edid_alloc(info, n_db * sizeof(struct edid_db_entry));
+        if (!idx->entries) {
+                edid_error("Out of memory for data block index\n");
+                edid_report(info, EDID_DIAG_ERROR, EDID_DIAG_NO_MEMORY, 0, 0, EDID_DECODE_BASE);
+                return -1;
+        }
+
+        for_each_ext_blk(r, info->raw_edid, info->cea_blks.n_cea_ext_blks, blk) {
+                u_int8_t *cea = &info->raw_edid[blk * CEA_EXTN_BLK_SIZE];
+                struct edid_db_range ranges[EDID_MAX_DB_RANGES];
+                int n_ranges = edid_blk_db_ranges(cea, ranges);
+                int r;
+
+                info->ext_blks[blk - 1].first_db = idx->n_entries;
+                for (r = 0; r < n_ranges; r++) {
+                        unsigned int start = ranges[r].start;
+                        u_int8_t d = ranges[r].end;
+
+                        while (start < d && idx->n_entries < n_db) {
+                                struct edid_db_entry *entry = &idx->entries[idx->n_entries];
+                                u_int16_t *first, *last;
+
+                                entry->ext_blk = blk;
+                                entry->tag = CEA_EXT_BLK_TAG(cea[start]);
+                                entry->len = CEA_EXT_BLK_DATA_LEN(cea[start]);
+                                entry->ext_tag = 0;
+                                entry->offset = blk * CEA_EXTN_BLK_SIZE + start;
+                                entry->next = EDID_DB_NONE;
+
+                                if (entry->tag == CEA_DATA_BLOCK_EXTENDED && entry->len) {
+                                        entry->ext_tag = cea[start + 1];
+                                        first = &idx->first_ext_tag[entry->ext_tag];
+                                        last = &last_ext_tag[entry->ext_tag];
+                                } else {
+                                        first = &idx->first_tag[entry->tag];
+                                        last = &last_tag[entry->tag];
+                                }
+
+                                if (*first == EDID_DB_NONE)
+                                        *first = idx->n_entries;
+                                else
+                                        idx->entries[*last].next = idx->n_entries;
+                                *last = idx->n_entries++;
+
+                                /* The dblen doesn't include tag byte, so +1 */
+                                start += entry->len + 1;
+                        }
+                }
+                info->ext_blks[blk - 1].n_db = idx->n_entries - info->ext_blks[blk - 1].first_db;
+        }
+
+        edid_debug("Indexed %d CEA data blocks\n", idx->n_entries);
+        return 0;
 }
 
 static int
-process_edid_cea_extension_blocks(u_int8_t *raw_edid, struct edid_info *info)
+process_edid_cea_extension_blocks(u_int8_t *raw_edid, struct edid_info *info, u_int32_t groups)
 {
-        int count;
-        struct edid *edid_first_blk = (struct edid *)raw_edid;
+        unsigned int count;
+        u_int16_t cursor = 0;
         struct edid_tags *etags = &info->cea_blks;
+        struct edid_blk_reader r;
 
-        etags->n_cea_ext_blks = edid_first_blk->extensions;
         if (!etags->n_cea_ext_blks) {
                 edid_debug("No CEA-861 extension blocks in EDID\n");
                 return 0;
         }
 
         edid_debug("Found %d CEA extension blocks in EDID\n", etags->n_cea_ext_blks);
-        for (count = 1; count <= etags->n_cea_ext_blks; count++) {
+        if (etags->n_cea_ext_blks != ((struct edid *)raw_edid)->extensions)
+                edid_debug("Extension count %d from the HF-EEODB\n", etags->n_cea_ext_blks);
+
+        /* The DTDs of all the CEA blocks go to one array, in block order */
+        if (groups & EDID_DECODE_DTD) {
+                u_int8_t n_dtds = edid_cea_n_dtds(raw_edid, etags->n_cea_ext_blks);
+
+                etags->dtd.n_dtd_modes = 0;
+                if (n_dtds) {
+                        etags->dtd.d_modes = edid_alloc(info, n_dtds * sizeof(struct detailed_mode));
+                        if (!etags->dtd.d_modes) {
+                                edid_error("Out of memory for DTD modes\n");
+                                edid_report(info, EDID_DIAG_ERROR, EDID_DIAG_NO_MEMORY, 0, 0,
+                                        EDID_DECODE_DTD);
+                        }
+                }
+        }
+
+        for_each_ext_blk(r, raw_edid, etags->n_cea_ext_blks, count) {
                 u_int8_t *cea_extn = &(raw_edid[count * CEA_EXTN_BLK_SIZE]);
 
-                extract_cea_block_information(info, cea_extn);
+                extract_cea_block_information(info, cea_extn, count, &cursor, groups);
         }
 
         return 0;
 }
 
+static void
+edid_set_gamma(struct edid_base_blk *bb, u_int8_t value)
+{
+        /* gamma = (value + 100)/100, 0xFF means it is given elsewhere */
+        bb->gamma_x100 = value == 0xFF ? 0 : value + 100;
+        bb->gamma = bb->gamma_x100 / 100.0f;
+}
+
 static void
 edid_bb_get_input_details(struct edid *edid, struct edid_base_blk *bb)
 {
@@ -1058,8 +1935,7 @@ next:
                         bb->suspend,
                         bb->active_off);
 
-                /* gamma = (value + 100)/100 */
-                bb->gamma = (edid->gamma + 100) / 100;
+                edid_set_gamma(bb, edid->gamma);
                 edid_debug("EDID gamma %f\n", bb->gamma);
         }
 }
@@ -1079,6 +1955,28 @@ edid_bb_get_product_details(struct edid *edid, struct edid_base_blk *bb)
                 bb->vendor, (int)(bb->pid), bb->sno);
 }
 
+/* 10 bit coordinates: 8 high bits, and 2 low bits packed in a shared byte */
+#define EDID_CHROMA(hi, lo, shift) (((hi) << 2) | (((lo) >> (shift)) & 3))
+
+static void
+edid_bb_get_chromaticity(struct edid *edid, struct edid_base_blk *bb)
+{
+        struct edid_chromaticity *c = &bb->chroma;
+
+        c->red_x = EDID_CHROMA(edid->red_x, edid->red_green_lo, 6);
+        c->red_y = EDID_CHROMA(edid->red_y, edid->red_green_lo, 4);
+        c->green_x = EDID_CHROMA(edid->green_x, edid->red_green_lo, 2);
+        c->green_y = EDID_CHROMA(edid->green_y, edid->red_green_lo, 0);
+        c->blue_x = EDID_CHROMA(edid->blue_x, edid->black_white_lo, 6);
+        c->blue_y = EDID_CHROMA(edid->blue_y, edid->black_white_lo, 4);
+        c->white_x = EDID_CHROMA(edid->white_x, edid->black_white_lo, 2);
+        c->white_y = EDID_CHROMA(edid->white_y, edid->black_white_lo, 0);
+
+        edid_debug("Chromaticity (/1024): R %d,%d G %d,%d B %d,%d W %d,%d\n",
+                c->red_x, c->red_y, c->green_x, c->green_y,
+                c->blue_x, c->blue_y, c->white_x, c->white_y);
+}
+
 static void
 edid_bb_get_dtd_modes(u_int8_t *raw_edid, struct edid_base_blk *bb)
 {
@@ -1092,97 +1990,2055 @@ edid_bb_get_dtd_modes(u_int8_t *raw_edid, struct edid_base_blk *bb)
         edid_debug("\n");
 }
 
-int process_edid_base_block(u_int8_t *raw_edid, struct edid_info *info)
+/* 8 standard timings in the base block, then 6 per 0xFA descriptor */
+#define EDID_STD_TIMING_SLOTS (8 + 4 * 6)
+#define EDID_DESC_STD_TIMINGS 0xFA
+#define EDID_DESC_CVT_CODES 0xF8
+#define EDID_DESC_RANGE_LIMITS 0xFD
+/* Range limits descriptor flags: secondary GTF curve, or CVT, supported */
+#define EDID_RANGE_GTF2 0x02
+#define EDID_RANGE_CVT 0x04
+/* CVT range limits blanking support: reduced, standard */
+#define EDID_RANGE_CVT_RB 0x10
+#define EDID_RANGE_CVT_STD 0x08
+
+/* 4 CVT 3 byte codes per 0xF8 descriptor, after its version byte */
+#define EDID_CVT_CODES 4
+#define EDID_CVT_CODE_OFFSET 6
+/* Byte 2 of a CVT code: 50, 60, 75, 85 Hz, and 60 Hz reduced blanking */
+#define EDID_CVT_RATES 0x1F
+
+/* Standard timing slot n, NULL if its descriptor doesn't hold standard timings */
+static struct std_timing *
+edid_bb_std_timing(struct edid *edid, unsigned int n)
 {
-        const u_int8_t header[] = {0x0, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x0};
-        struct edid *edid = (struct edid *)raw_edid;
-        struct edid_base_blk *bb = &info->base_blk;
-
-        if (!edid) {
-                edid_error("No EDID found in input\n");
-                return -1;
-        }
+        struct detailed_timing *dt;
 
-        if (memcmp(edid->header, header, 8)) {
-                edid_error("Corrupt EDID: Header mismatch\n");
-                return -1;
-        }
+        if (n < 8)
+                return &edid->standard_timings[n];
 
-        edid_debug("\n##############################\n");
-        edid_debug("####### EDID Main block ######\n");
-        edid_debug("##############################\n");
+        dt = &edid->detailed_timings[(n - 8) / 6];
+        if (dt->pixel_clock || dt->data.other_data.pad1 ||
+                        dt->data.other_data.type != EDID_DESC_STD_TIMINGS)
+                return NULL;
 
-        edid_bb_get_product_details(edid, bb);
-        edid_bb_get_input_details(edid, bb);
-        edid_bb_get_dtd_modes(raw_edid, bb);
-        return 0;
+        return &dt->data.other_data.data.timings[(n - 8) % 6];
 }
 
-void libedid_destroy_edid_info(struct edid_info *info)
+/* 0x0101 marks an unused slot, a 0 size is invalid */
+static inline bool
+edid_std_timing_used(const struct std_timing *st)
 {
-        struct edid_tags *etags;
+        return st && st->hsize && !(st->hsize == 0x01 && st->vfreq_aspect == 0x01);
+}
 
-        if (!info)
-                return;
+/* Established timing bits, bit 16 is index 0 of libedid_est_timing() */
+static inline u_int32_t
+edid_bb_est_bits(struct edid *edid)
+{
+        return edid->established_timings.t1 << 9 | edid->established_timings.t2 << 1 |
+                edid->established_timings.mfg_rsvd >> 7;
+}
 
-        etags = &info->cea_blks;
+/* CVT 3 byte code n of descriptor i, NULL if it isn't a 0xF8 descriptor */
+static const u_int8_t *
+edid_bb_cvt_code(struct edid *edid, unsigned int i, unsigned int n)
+{
+        struct detailed_timing *dt = &edid->detailed_timings[i];
 
-        if (etags->ifdb.data) {
-                free(etags->ifdb.data);
-                etags->ifdb.data = NULL;
-        }
+        if (dt->pixel_clock || dt->data.other_data.pad1 ||
+                        dt->data.other_data.type != EDID_DESC_CVT_CODES)
+                return NULL;
 
-        if (etags->hdr_dmd.data) {
-                free(etags->hdr_dmd.data);
-                etags->hdr_dmd.data = NULL;
-        }
+        return (const u_int8_t *)dt + EDID_CVT_CODE_OFFSET + n * 3;
+}
 
-        if (etags->vsdb.data) {
-                free(etags->vsdb.data);
-                etags->vsdb.data = NULL;
-        }
+/* Modes of a CVT 3 byte code, one per supported rate, 0 if unused */
+static inline unsigned int
+edid_cvt_code_n_modes(const u_int8_t *code)
+{
+        if (!code || !(code[0] | code[1]))
+                return 0;
 
-        if (etags->vsvdb.data) {
-                free(etags->vsvdb.data);
-                etags->vsvdb.data = NULL;
-        }
+        return __builtin_popcount(code[2] & EDID_CVT_RATES);
+}
 
-        if (etags->dtd.d_modes) {
+/* Number of established and used standard timings of the base block, and
+ * of the modes of its CVT 3 byte codes
+ */
+static unsigned int
+edid_bb_n_std_modes(u_int8_t *raw_edid)
+{
+        struct edid *edid = (struct edid *)raw_edid;
+        unsigned int i, n, count = __builtin_popcount(edid_bb_est_bits(edid));
+
+        for (n = 0; n < EDID_STD_TIMING_SLOTS; n++)
+                if (edid_std_timing_used(edid_bb_std_timing(edid, n)))
+                        count++;
+
+        for (i = 0; i < 4; i++)
+                for (n = 0; n < EDID_CVT_CODES; n++)
+                        count += edid_cvt_code_n_modes(edid_bb_cvt_code(edid, i, n));
+
+        return count;
+}
+
+static void
+edid_dmt_mode(const struct edid_dmt_timing *dmt, struct detailed_mode *mode)
+{
+        memset(mode, 0, sizeof(*mode));
+        mode->pixel_clock_khz = dmt->pixel_clock_khz;
+        mode->hactive = dmt->hactive;
+        mode->hblank = dmt->hblank;
+        mode->hfrontp = dmt->hfrontp;
+        mode->hsync = dmt->hsync;
+        mode->vactive = dmt->vactive;
+        mode->vblank = dmt->vblank;
+        mode->vfrontp = dmt->vfrontp;
+        mode->vsync = dmt->vsync;
+        mode->interlaced = !!(dmt->flags & EDID_DMT_INTERLACED);
+}
+
+/*
+ * Formula for the standard timings DMT doesn't have: CVT since EDID 1.4,
+ * GTF before, or GTF with the secondary curve of the range limits
+ * descriptor when there is one. CVT range limits which only allow reduced
+ * blanking make it CVT-RB.
+ */
+static void
+edid_bb_std_formula(struct edid *edid, struct edid_timing_req *req)
+{
+        int i;
+
+        memset(req, 0, sizeof(*req));
+        if (edid->version > 1 || edid->revision >= 4)
+                req->formula = EDID_TIMING_CVT;
+        else
+                req->formula = EDID_TIMING_GTF;
+
+        for (i = 0; i < 4; i++) {
+                struct detailed_timing *dt = &edid->detailed_timings[i];
+                struct detailed_data_monitor_range *range = &dt->data.other_data.data.range;
+                u_int8_t *m = (u_int8_t *)&range->formula.gtf2.m;
+
+                if (dt->pixel_clock || dt->data.other_data.type != EDID_DESC_RANGE_LIMITS)
+                        continue;
+
+                if (range->flags == EDID_RANGE_CVT) {
+                        if ((range->formula.cvt.flags & (EDID_RANGE_CVT_RB | EDID_RANGE_CVT_STD)) ==
+                                        EDID_RANGE_CVT_RB)
+                                req->formula = EDID_TIMING_CVT_RB;
+                        break;
+                }
+
+                if (range->flags != EDID_RANGE_GTF2)
+                        continue;
+
+                req->formula = EDID_TIMING_GTF2;
+                req->gtf.start_khz = range->formula.gtf2.hfreq_start_khz * 2;
+                req->gtf.c_x2 = range->formula.gtf2.c;
+                req->gtf.m = m[1] << 8 | m[0];
+                req->gtf.k = range->formula.gtf2.k;
+                req->gtf.j_x2 = range->formula.gtf2.j;
+                break;
+        }
+}
+
+static const char *const edid_timing_formula_names[EDID_N_TIMING_FORMULAS] = {
+        "CVT", "CVT-RB", "CVT-RBv2", "CVT-RBv3", "GTF", "GTF2",
+};
+
+/* DMT timing of a standard timing, or its timing from the formula in req */
+static int
+edid_std_timing_mode(struct edid *edid, const struct std_timing *st,
+                     struct edid_timing_req *req, struct detailed_mode *mode)
+{
+        u_int16_t hactive = (st->hsize + 31) * 8;
+        u_int8_t refresh = (st->vfreq_aspect & 0x3F) + 60;
+        const struct edid_dmt_timing *dmt;
+        u_int16_t vactive;
+
+        switch (st->vfreq_aspect >> 6) {
+        case 0:
+                /* 16:10 since EDID 1.3, 1:1 before */
+                if (edid->version > 1 || edid->revision >= 3)
+                        vactive = hactive * 10 / 16;
+                else
+                        vactive = hactive;
+                break;
+        case 1:
+                vactive = hactive * 3 / 4;
+                break;
+        case 2:
+                vactive = hactive * 4 / 5;
+                break;
+        default:
+                vactive = hactive * 9 / 16;
+                break;
+        }
+
+        /* 1360x768 and 1366x768 can't be coded exactly */
+        if (hactive == 1360 && vactive == 765) {
+                vactive = 768;
+        } else if (hactive == 1368 && vactive == 769) {
+                hactive = 1366;
+                vactive = 768;
+        }
+
+        dmt = libedid_find_dmt(hactive, vactive, refresh);
+        edid_debug("Standard timing %dx%d@%d (%s)\n", hactive, vactive, refresh,
+                dmt ? "DMT" : edid_timing_formula_names[req->formula]);
+        if (dmt) {
+                edid_dmt_mode(dmt, mode);
+                return 0;
+        }
+
+        req->hactive = hactive;
+        req->vactive = vactive;
+        req->refresh_mhz = refresh * 1000;
+        return libedid_timing_mode(req, mode);
+}
+
+/* Aspect ratios of CVT 3 byte codes, as hactive:vactive */
+static const u_int8_t edid_cvt_aspect[][2] = {
+        { 4, 3 }, { 16, 9 }, { 16, 10 }, { 15, 9 },
+};
+
+/* Refresh rates of the bits of byte 2 of a CVT code, bit 4 first */
+static const u_int8_t edid_cvt_rates[] = { 50, 60, 75, 85, 60 };
+
+/* The modes of a CVT 3 byte code, standard blanking for the rates it lists,
+ * and reduced blanking for its 60 Hz RB bit
+ */
+static void
+edid_bb_cvt_code_modes(struct edid_info *info, const u_int8_t *code)
+{
+        struct edid_base_blk *bb = &info->base_blk;
+        struct edid_timing_req req;
+        u_int16_t vactive;
+        unsigned int i;
+
+        if (!edid_cvt_code_n_modes(code))
+                return;
+
+        memset(&req, 0, sizeof(req));
+        vactive = (((code[1] & 0xF0) << 4 | code[0]) + 1) * 2;
+        req.vactive = vactive;
+        req.hactive = vactive * edid_cvt_aspect[(code[1] >> 2) & 0x3][0] /
+                edid_cvt_aspect[(code[1] >> 2) & 0x3][1] / 8 * 8;
+
+        for (i = 0; i < sizeof(edid_cvt_rates) / sizeof(edid_cvt_rates[0]); i++) {
+                if (!(code[2] & (0x10 >> i)))
+                        continue;
+
+                req.formula = i == 4 ? EDID_TIMING_CVT_RB : EDID_TIMING_CVT;
+                req.refresh_mhz = edid_cvt_rates[i] * 1000;
+                edid_debug("CVT code %dx%d@%d%s\n", req.hactive, vactive,
+                        edid_cvt_rates[i], i == 4 ? " RB" : "");
+                if (!libedid_timing_mode(&req, &bb->std_modes[bb->n_std_modes])) {
+                        bb->n_std_modes++;
+                        continue;
+                }
+
+                edid_warn("CVT code %02x%02x%02x has no timing\n", code[0], code[1], code[2]);
+                edid_report_at(info, EDID_DIAG_WARN, EDID_DIAG_BAD_TIMING, code, 0);
+        }
+}
+
+static void
+edid_bb_get_std_modes(u_int8_t *raw_edid, struct edid_info *info)
+{
+        struct edid *edid = (struct edid *)raw_edid;
+        struct edid_base_blk *bb = &info->base_blk;
+        unsigned int n_max = edid_bb_n_std_modes(raw_edid);
+        u_int32_t est = edid_bb_est_bits(edid);
+        struct edid_timing_req req;
+        unsigned int n;
+
+        bb->n_std_modes = 0;
+        if (!n_max)
+                return;
+
+        bb->std_modes = edid_alloc(info, n_max * sizeof(struct detailed_mode));
+        if (!bb->std_modes) {
+                edid_error("Out of memory for standard timings\n");
+                edid_report(info, EDID_DIAG_ERROR, EDID_DIAG_NO_MEMORY, 0, 0, EDID_DECODE_DTD);
+                return;
+        }
+
+        for (n = 0; est; n++, est = (est << 1) & 0x1FFFF) {
+                const struct edid_dmt_timing *dmt = libedid_est_timing(n);
+
+                if (!(est & 0x10000))
+                        continue;
+
+                edid_debug("Established timing %dx%d@%d\n", dmt->hactive,
+                        (dmt->flags & EDID_DMT_INTERLACED) ? dmt->vactive * 2 : dmt->vactive,
+                        dmt->refresh_hz);
+                edid_dmt_mode(dmt, &bb->std_modes[bb->n_std_modes++]);
+        }
+
+        edid_bb_std_formula(edid, &req);
+        for (n = 0; n < EDID_STD_TIMING_SLOTS; n++) {
+                struct std_timing *st = edid_bb_std_timing(edid, n);
+
+                if (!edid_std_timing_used(st))
+                        continue;
+
+                if (edid_std_timing_mode(edid, st, &req, &bb->std_modes[bb->n_std_modes])) {
+                        edid_warn("Standard timing %02x%02x has no timing\n",
+                                st->hsize, st->vfreq_aspect);
+                        edid_report_at(info, EDID_DIAG_WARN, EDID_DIAG_BAD_TIMING,
+                                (const u_int8_t *)st, 0);
+                } else {
+                        bb->n_std_modes++;
+                }
+        }
+
+        for (n = 0; n < 4 * EDID_CVT_CODES; n++)
+                edid_bb_cvt_code_modes(info, edid_bb_cvt_code(edid, n / EDID_CVT_CODES,
+                        n % EDID_CVT_CODES));
+}
+
+/*
+ * DisplayID extension blocks. Each block carries one DisplayID section:
+ * the timings of its data blocks go to displayid.modes, its VIC codes to
+ * the CEA VIC bitmaps, and its CTA data blocks are indexed and parsed
+ * with the ones of the CEA blocks.
+ */
+
+#define DISPLAYID_LE16(p) ((p)[1] << 8 | (p)[0])
+#define DISPLAYID_LE24(p) ((p)[2] << 16 | (p)[1] << 8 | (p)[0])
+
+/* Timing code types of the type IV and VIII timing data blocks */
+enum displayid_code_type {
+        DISPLAYID_CODE_DMT,
+        DISPLAYID_CODE_VIC,
+        DISPLAYID_CODE_HDMI_VIC,
+};
+
+/* HDMI VICs 1 to 4 as CTA-861 VICs */
+static const u_int8_t displayid_hdmi_vics[] = { 0, 95, 94, 93, 98 };
+
+/* Type III aspect ratios, as hactive:vactive */
+static const u_int16_t displayid_aspect[][2] = {
+        { 1, 1 }, { 5, 4 }, { 4, 3 }, { 15, 9 },
+        { 16, 9 }, { 16, 10 }, { 64, 27 }, { 256, 135 },
+};
+
+static inline bool
+displayid_code_db(const u_int8_t *db)
+{
+        return db[0] == DISPLAYID_TIMING_TYPE_4 || db[0] == DISPLAYID_2_TIMING_TYPE_8;
+}
+
+/* Bytes per timing of a timing data block, 0 for other data blocks */
+static u_int8_t
+displayid_timing_size(const u_int8_t *db)
+{
+        switch (db[0]) {
+        case DISPLAYID_TIMING_TYPE_1:
+        case DISPLAYID_2_TIMING_TYPE_7:
+                return 20;
+        case DISPLAYID_TIMING_TYPE_3:
+                return 3;
+        case DISPLAYID_TIMING_TYPE_4:
+                return 1;
+        case DISPLAYID_2_TIMING_TYPE_8:
+                /* Or 2 byte standard timing codes */
+                return (db[1] & 0x08) ? 2 : 1;
+        case DISPLAYID_2_TIMING_TYPE_9:
+                return 6;
+        default:
+                return 0;
+        }
+}
+
+/*
+ * Upper bound of the timings (for displayid.modes) and of the VICs of one
+ * DisplayID data block. The prescan and the parser must agree on it.
+ */
+static unsigned int
+displayid_db_n_modes(const u_int8_t *db, unsigned int *n_vics)
+{
+        const u_int8_t *p = &db[DISPLAYID_DB_HDR_SIZE];
+        u_int8_t size = displayid_timing_size(db);
+        unsigned int n = 0;
+        int i;
+
+        switch (db[0]) {
+        case DISPLAYID_VESA_TIMINGS:
+        case DISPLAYID_CEA_TIMINGS:
+                for (i = 0; i < db[2]; i++)
+                        n += __builtin_popcount(p[i]);
+                if (db[0] == DISPLAYID_VESA_TIMINGS)
+                        return n;
+                *n_vics += n;
+                return 0;
+        default:
+                break;
+        }
+
+        if (!size)
+                return 0;
+
+        if (displayid_code_db(db) && (db[1] >> 6) != DISPLAYID_CODE_DMT) {
+                *n_vics += db[2] / size;
+                return 0;
+        }
+
+        return db[2] / size;
+}
+
+static unsigned int
+edid_displayid_n_modes(const u_int8_t *raw_edid, unsigned int n_blks, unsigned int *n_vics)
+{
+        struct edid_blk_reader r;
+        unsigned int n = 0, off, blk;
+
+        *n_vics = 0;
+        for_each_ext_blk(r, raw_edid, n_blks, blk) {
+                const u_int8_t *b = &raw_edid[blk * CEA_EXTN_BLK_SIZE];
+
+                if (b[0] != DISPLAYID_EXT_BLK_TAG_VALUE || !displayid_section_ok(b))
+                        continue;
+
+                for_each_displayid_db(b, off, DISPLAYID_HDR_SIZE + b[2])
+                        n += displayid_db_n_modes(&b[off], n_vics);
+        }
+
+        /* Indexed by a u_int8_t in the mode index */
+        return n > 255 ? 255 : n;
+}
+
+/* Type I and VII timings, clk_khz is the unit of the pixel clock */
+static void
+displayid_detailed_mode(const u_int8_t *t, u_int32_t clk_khz, struct detailed_mode *mode)
+{
+        memset(mode, 0, sizeof(*mode));
+        mode->pixel_clock_khz = (DISPLAYID_LE24(t) + 1) * clk_khz;
+        mode->hactive = DISPLAYID_LE16(&t[4]) + 1;
+        mode->hblank = DISPLAYID_LE16(&t[6]) + 1;
+        /* Bit 15 of the front porches is the sync polarity */
+        mode->hfrontp = (DISPLAYID_LE16(&t[8]) & 0x7FFF) + 1;
+        mode->hsync = DISPLAYID_LE16(&t[10]) + 1;
+        mode->vactive = DISPLAYID_LE16(&t[12]) + 1;
+        mode->vblank = DISPLAYID_LE16(&t[14]) + 1;
+        mode->vfrontp = (DISPLAYID_LE16(&t[16]) & 0x7FFF) + 1;
+        mode->vsync = DISPLAYID_LE16(&t[18]) + 1;
+        mode->interlaced = CHECK_BIT(t[3], 4);
+}
+
+/* Decode one timing of a timing data block, true if mode is valid */
+static bool
+displayid_timing(struct edid *edid, const u_int8_t *db, const u_int8_t *t,
+                 struct detailed_mode *mode, bool *preferred)
+{
+        struct edid_timing_req req;
+        const struct edid_dmt_timing *dmt;
+        u_int8_t aspect;
+
+        memset(&req, 0, sizeof(req));
+        *preferred = false;
+        switch (db[0]) {
+        case DISPLAYID_TIMING_TYPE_1:
+                *preferred = CHECK_BIT(t[3], 7);
+                displayid_detailed_mode(t, 10, mode);
+                return true;
+
+        case DISPLAYID_2_TIMING_TYPE_7:
+                *preferred = CHECK_BIT(t[3], 7);
+                displayid_detailed_mode(t, 1, mode);
+                return true;
+
+        case DISPLAYID_TIMING_TYPE_3:
+                *preferred = CHECK_BIT(t[0], 7);
+                aspect = t[0] & 0xF;
+                if (aspect >= sizeof(displayid_aspect) / sizeof(displayid_aspect[0]))
+                        return false;
+
+                /* Only CVT and CVT reduced blanking */
+                if ((t[0] >> 4) & 6)
+                        return false;
+
+                req.formula = (t[0] & 0x10) ? EDID_TIMING_CVT_RB : EDID_TIMING_CVT;
+                req.hactive = (t[1] + 1) * 8;
+                req.vactive = req.hactive * displayid_aspect[aspect][1] /
+                        displayid_aspect[aspect][0];
+                req.refresh_mhz = ((t[2] & 0x7F) + 1) * 1000;
+                if (t[2] & 0x80)
+                        req.flags |= EDID_TIMING_INTERLACED;
+                return !libedid_timing_mode(&req, mode);
+
+        case DISPLAYID_TIMING_TYPE_4:
+        case DISPLAYID_2_TIMING_TYPE_8:
+                if (displayid_timing_size(db) == 2) {
+                        req.formula = EDID_TIMING_CVT;
+                        return !edid_std_timing_mode(edid, (const struct std_timing *)t,
+                                                     &req, mode);
+                }
+
+                dmt = libedid_dmt_timing(t[0]);
+                if (!dmt)
+                        return false;
+
+                edid_dmt_mode(dmt, mode);
+                return true;
+
+        case DISPLAYID_2_TIMING_TYPE_9:
+                switch (t[0] & 7) {
+                case 0:
+                        req.formula = EDID_TIMING_CVT;
+                        break;
+                case 1:
+                        req.formula = EDID_TIMING_CVT_RB;
+                        break;
+                case 2:
+                        req.formula = EDID_TIMING_CVT_RB2;
+                        break;
+                default:
+                        return false;
+                }
+
+                req.hactive = DISPLAYID_LE16(&t[1]) + 1;
+                req.vactive = DISPLAYID_LE16(&t[3]) + 1;
+                req.refresh_mhz = (t[5] + 1) * 1000;
+                /* Refresh rate divided by 1.001 */
+                if (t[0] & 0x10) {
+                        if (req.formula == EDID_TIMING_CVT_RB2)
+                                req.flags |= EDID_TIMING_VIDEO_OPTIMIZED;
+                        else
+                                req.refresh_mhz = req.refresh_mhz * 1000 / 1001;
+                }
+                return !libedid_timing_mode(&req, mode);
+
+        default:
+                return false;
+        }
+}
+
+static void
+displayid_add_mode(struct edid_displayid *did, unsigned int n_max,
+                   const struct detailed_mode *mode, bool preferred)
+{
+        if (did->n_modes >= n_max)
+                return;
+
+        edid_debug("DisplayID timing %dx%d, %d kHz%s\n", mode->hactive, mode->vactive,
+                mode->pixel_clock_khz, preferred ? " (preferred)" : "");
+        if (preferred && did->preferred == 0xFF)
+                did->preferred = did->n_modes;
+        did->modes[did->n_modes++] = *mode;
+}
+
+static void
+displayid_get_modes(struct edid_info *info, const u_int8_t *db, unsigned int n_max)
+{
+        struct edid *edid = (struct edid *)info->raw_edid;
+        struct edid_displayid *did = &info->displayid;
+        const u_int8_t *p = &db[DISPLAYID_DB_HDR_SIZE];
+        u_int8_t size = displayid_timing_size(db);
+        struct detailed_mode mode;
+        bool preferred;
+        int i, k;
+
+        if (db[0] == DISPLAYID_VESA_TIMINGS) {
+                for (i = 0; i < db[2]; i++) {
+                        for (k = 0; k < 8; k++) {
+                                const struct edid_dmt_timing *dmt;
+
+                                if (!CHECK_BIT(p[i], k))
+                                        continue;
+
+                                dmt = libedid_dmt_timing(i * 8 + k + 1);
+                                if (!dmt) {
+                                        edid_report_at(info, EDID_DIAG_WARN,
+                                                EDID_DIAG_BAD_TIMING, &p[i], db[0]);
+                                        continue;
+                                }
+
+                                edid_dmt_mode(dmt, &mode);
+                                displayid_add_mode(did, n_max, &mode, false);
+                        }
+                }
+                return;
+        }
+
+        if (!size || (displayid_code_db(db) && (db[1] >> 6) != DISPLAYID_CODE_DMT))
+                return;
+
+        for (i = 0; i + size <= db[2]; i += size) {
+                if (displayid_timing(edid, db, &p[i], &mode, &preferred)) {
+                        displayid_add_mode(did, n_max, &mode, preferred);
+                        continue;
+                }
+
+                edid_warn("DisplayID timing %d of block 0x%x has no mode\n", i / size, db[0]);
+                edid_report_at(info, EDID_DIAG_WARN, EDID_DIAG_BAD_TIMING, &p[i], db[0]);
+        }
+}
+
+/* VICs listed by a DisplayID block are supported, but not in a CTA data block */
+static void
+displayid_add_vic(struct edid_info *info, u_int8_t vic, u_int8_t ext_blk)
+{
+        struct edid_vic_caps *caps = &info->cea_blks.vic_caps[vic];
+
+        if (!vic)
+                return;
+
+        _set_vic(info->cea_blks.vics, vic);
+        caps->flags |= EDID_VIC_CAP_SUPPORTED;
+        if (!caps->ext_blk) {
+                caps->ext_blk = ext_blk;
+                caps->db = EDID_DB_NONE;
+        }
+}
+
+static void
+displayid_get_vics(struct edid_info *info, const u_int8_t *db, u_int8_t ext_blk)
+{
+        const u_int8_t *p = &db[DISPLAYID_DB_HDR_SIZE];
+        int i, k;
+
+        if (db[0] == DISPLAYID_CEA_TIMINGS) {
+                for (i = 0; i < db[2] && i < 8; i++)
+                        for (k = 0; k < 8; k++)
+                                if (CHECK_BIT(p[i], k))
+                                        displayid_add_vic(info, i * 8 + k + 1, ext_blk);
+                return;
+        }
+
+        if (!displayid_code_db(db) || displayid_timing_size(db) != 1)
+                return;
+
+        for (i = 0; i < db[2]; i++) {
+                switch (db[1] >> 6) {
+                case DISPLAYID_CODE_VIC:
+                        displayid_add_vic(info, p[i], ext_blk);
+                        break;
+                case DISPLAYID_CODE_HDMI_VIC:
+                        if (p[i] < sizeof(displayid_hdmi_vics) / sizeof(displayid_hdmi_vics[0]))
+                                displayid_add_vic(info, displayid_hdmi_vics[p[i]], ext_blk);
+                        break;
+                default:
+                        break;
+                }
+        }
+}
+
+static void
+displayid_get_range(struct edid_info *info, const u_int8_t *db)
+{
+        const u_int8_t *p = &db[DISPLAYID_DB_HDR_SIZE];
+        struct edid_timing_range *range = &info->displayid.range;
+
+        if (db[0] == DISPLAYID_TIMING_RANGE && db[2] >= 15) {
+                range->min_pixel_clock_khz = (DISPLAYID_LE24(&p[0]) + 1) * 10;
+                range->max_pixel_clock_khz = (DISPLAYID_LE24(&p[3]) + 1) * 10;
+                range->min_refresh_hz = p[10];
+                range->max_refresh_hz = p[11];
+                range->seamless = CHECK_BIT(p[14], 4);
+        } else if (db[0] == DISPLAYID_2_DYNAMIC_RANGE && db[2] >= 9) {
+                range->min_pixel_clock_khz = DISPLAYID_LE24(&p[0]) + 1;
+                range->max_pixel_clock_khz = DISPLAYID_LE24(&p[3]) + 1;
+                range->min_refresh_hz = p[6];
+                range->max_refresh_hz = p[7];
+                /* 10 bit max refresh rate since revision 1 */
+                if (db[1] & 7)
+                        range->max_refresh_hz |= (p[8] & 3) << 8;
+                range->seamless = CHECK_BIT(p[8], 7);
+        } else {
+                edid_warn("DisplayID range block 0x%x too short, %d bytes\n", db[0], db[2]);
+                edid_report_at(info, EDID_DIAG_WARN, EDID_DIAG_BAD_DB_LEN, db, db[2]);
+                return;
+        }
+
+        edid_debug("DisplayID range: %d - %d kHz, %d - %d Hz%s\n",
+                range->min_pixel_clock_khz, range->max_pixel_clock_khz,
+                range->min_refresh_hz, range->max_refresh_hz,
+                range->seamless ? ", seamless" : "");
+}
+
+static void
+displayid_get_tile(struct edid_info *info, const u_int8_t *db)
+{
+        const u_int8_t *p = &db[DISPLAYID_DB_HDR_SIZE];
+        struct edid_tile *tile = &info->displayid.tile;
+        u_int8_t mult;
+
+        if (db[2] < 22) {
+                edid_warn("DisplayID tile block too short, %d bytes\n", db[2]);
+                edid_report_at(info, EDID_DIAG_WARN, EDID_DIAG_BAD_DB_LEN, db, db[2]);
+                return;
+        }
+
+        tile->caps = p[0];
+        tile->single_enclosure = CHECK_BIT(p[0], 7);
+        tile->n_htiles = ((p[1] >> 4) | ((p[3] >> 2) & 0x30)) + 1;
+        tile->n_vtiles = ((p[1] & 0xF) | (p[3] & 0x30)) + 1;
+        tile->hloc = (p[2] >> 4) | ((p[3] >> 2) & 3) << 4;
+        tile->vloc = (p[2] & 0xF) | (p[3] & 3) << 4;
+        tile->hsize = DISPLAYID_LE16(&p[4]) + 1;
+        tile->vsize = DISPLAYID_LE16(&p[6]) + 1;
+        /* Bezels are in multiples of 0.1 pixel */
+        mult = p[8];
+        tile->bezel_top = p[9] * mult / 10;
+        tile->bezel_bottom = p[10] * mult / 10;
+        tile->bezel_right = p[11] * mult / 10;
+        tile->bezel_left = p[12] * mult / 10;
+        memcpy(tile->vendor, &p[13], 3);
+        tile->vendor[3] = 0;
+        tile->product = DISPLAYID_LE16(&p[16]);
+        tile->serial = (u_int32_t)p[21] << 24 | p[20] << 16 | p[19] << 8 | p[18];
+
+        edid_debug("DisplayID tile %d,%d of %dx%d, %dx%d pixels, topology %.3s/%04x/%08x\n",
+                tile->hloc, tile->vloc, tile->n_htiles, tile->n_vtiles,
+                tile->hsize, tile->vsize, tile->vendor, tile->product, tile->serial);
+}
+
+static void
+displayid_parse_section(struct edid_info *info, const u_int8_t *blk,
+                        u_int8_t ext_blk, unsigned int n_max, u_int32_t groups)
+{
+        struct edid_displayid *did = &info->displayid;
+        unsigned int off, end = DISPLAYID_HDR_SIZE + blk[2];
+
+        if (groups & EDID_DECODE_MISC) {
+                if (!did->n_sections++) {
+                        did->version = blk[1];
+                        did->product_type = blk[3];
+                }
+                edid_debug("DisplayID %d.%d section in block %d, %d bytes\n",
+                        blk[1] >> 4, blk[1] & 0xF, ext_blk, blk[2]);
+        }
+
+        for_each_displayid_db(blk, off, end) {
+                const u_int8_t *db = &blk[off];
+
+                switch (db[0]) {
+                case DISPLAYID_TIMING_RANGE:
+                case DISPLAYID_2_DYNAMIC_RANGE:
+                        if (groups & EDID_DECODE_MISC)
+                                displayid_get_range(info, db);
+                        break;
+
+                case DISPLAYID_TILED_TOPOLOGY:
+                case DISPLAYID_2_TILED_TOPOLOGY:
+                        if (groups & EDID_DECODE_MISC)
+                                displayid_get_tile(info, db);
+                        break;
+
+                default:
+                        if (groups & EDID_DECODE_VIDEO)
+                                displayid_get_vics(info, db, ext_blk);
+                        if ((groups & EDID_DECODE_DTD) && did->modes)
+                                displayid_get_modes(info, db, n_max);
+                        break;
+                }
+        }
+}
+
+static void
+process_edid_displayid_blocks(u_int8_t *raw_edid, struct edid_info *info, u_int32_t groups)
+{
+        struct edid_displayid *did = &info->displayid;
+        unsigned int n_max = 0, n_vics, blk;
+        struct edid_blk_reader r;
+
+        if (!(groups & (EDID_DECODE_DTD | EDID_DECODE_VIDEO | EDID_DECODE_MISC)))
+                return;
+
+        if (groups & EDID_DECODE_DTD) {
+                did->n_modes = 0;
+                did->preferred = 0xFF;
+                n_max = edid_displayid_n_modes(raw_edid, info->cea_blks.n_cea_ext_blks,
+                                &n_vics);
+                if (n_max) {
+                        did->modes = edid_alloc(info, n_max * sizeof(struct detailed_mode));
+                        if (!did->modes) {
+                                edid_error("Out of memory for DisplayID timings\n");
+                                edid_report(info, EDID_DIAG_ERROR, EDID_DIAG_NO_MEMORY, 0, 0,
+                                        EDID_DECODE_DTD);
+                        }
+                }
+        }
+
+        for_each_ext_blk(r, raw_edid, info->cea_blks.n_cea_ext_blks, blk) {
+                u_int8_t *b = &raw_edid[blk * CEA_EXTN_BLK_SIZE];
+
+                if (b[0] != DISPLAYID_EXT_BLK_TAG_VALUE)
+                        continue;
+
+                /* Validation reports the ones which don't fit */
+                if (!displayid_section_fits(b)) {
+                        if (groups & EDID_DECODE_MISC)
+                                edid_debug("Skipping DisplayID section %d, %d bytes\n",
+                                        blk, b[2]);
+                        continue;
+                }
+
+                if (!displayid_section_ok(b)) {
+                        if (groups & EDID_DECODE_MISC) {
+                                edid_warn("Bad DisplayID section checksum in block %d\n", blk);
+                                edid_report(info, EDID_DIAG_WARN, EDID_DIAG_SECTION_CHECKSUM,
+                                        blk, blk * CEA_EXTN_BLK_SIZE +
+                                        DISPLAYID_HDR_SIZE + b[2], 0);
+                        }
+                        continue;
+                }
+
+                displayid_parse_section(info, b, blk, n_max, groups);
+        }
+}
+
+static int
+edid_check_base_block(struct edid_info *info, u_int8_t *raw_edid)
+{
+        const u_int8_t header[] = {0x0, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x0};
+        struct edid *edid = (struct edid *)raw_edid;
+
+        if (!edid) {
+                edid_error("No EDID found in input\n");
+                edid_report(info, EDID_DIAG_ERROR, EDID_DIAG_NO_EDID, 0, 0, 0);
+                return -1;
+        }
+
+        if (memcmp(edid->header, header, 8)) {
+                edid_error("Corrupt EDID: Header mismatch\n");
+                edid_report(info, EDID_DIAG_ERROR, EDID_DIAG_HEADER, 0, 0, 0);
+                return -1;
+        }
+
+        return 0;
+}
+
+static void
+decode_edid_base_block(u_int8_t *raw_edid, struct edid_info *info, u_int32_t groups)
+{
+        struct edid *edid = (struct edid *)raw_edid;
+        struct edid_base_blk *bb = &info->base_blk;
+
+        if (groups & EDID_DECODE_BASE) {
+                edid_debug("\n##############################\n");
+                edid_debug("####### EDID Main block ######\n");
+                edid_debug("##############################\n");
+
+                edid_bb_get_product_details(edid, bb);
+                edid_bb_get_input_details(edid, bb);
+                edid_bb_get_chromaticity(edid, bb);
+        }
+
+        if (groups & EDID_DECODE_DTD) {
+                edid_bb_get_dtd_modes(raw_edid, bb);
+                edid_bb_get_std_modes(raw_edid, info);
+        }
+}
+
+int process_edid_base_block(u_int8_t *raw_edid, struct edid_info *info)
+{
+        if (edid_check_base_block(info, raw_edid))
+                return -1;
+
+        decode_edid_base_block(raw_edid, info, EDID_DECODE_ALL);
+        return 0;
+}
+
+static int
+edid_mode_cmp(const void *a, const void *b)
+{
+        const struct edid_mode_entry *ma = a, *mb = b;
+
+        if (ma->hactive != mb->hactive)
+                return ma->hactive < mb->hactive ? -1 : 1;
+        if (ma->vactive != mb->vactive)
+                return ma->vactive < mb->vactive ? -1 : 1;
+        if (ma->refresh_mhz != mb->refresh_mhz)
+                return ma->refresh_mhz < mb->refresh_mhz ? -1 : 1;
+        if (ma->pixel_clock_khz != mb->pixel_clock_khz)
+                return ma->pixel_clock_khz < mb->pixel_clock_khz ? -1 : 1;
+        return 0;
+}
+
+/* Whole timing of an indexed mode, what duplicates are detected on */
+struct edid_mode_timing_key {
+        u_int32_t pixel_clock_khz;
+        u_int32_t h;
+        u_int32_t hsync;
+        u_int32_t v;
+        u_int32_t vsync;
+        u_int32_t interlaced;
+};
+
+/* Most modes the index keeps, slots of the dedup table are u_int16_t */
+#define EDID_MODE_MAX 0x7FFF
+
+/* Dedup table size for n modes, a power of two at least twice n so that
+ * probes stay short
+ */
+static unsigned int
+edid_mode_hash_size(unsigned int n)
+{
+        unsigned int size = 2;
+
+        while (size < 2 * n)
+                size <<= 1;
+
+        return size;
+}
+
+/* Scratch state of edid_build_mode_index() */
+struct edid_mode_ranker {
+        struct edid_info *info;
+        struct edid_mode_entry *modes;
+        u_int16_t n_modes;
+        u_int16_t n_max;
+        /* Modes left out for lack of room */
+        unsigned int n_dropped;
+        /* edid_mode_hash_size(n_max) - 1 */
+        u_int16_t mask;
+        /* Index in modes, or EDID_DB_NONE */
+        u_int16_t *slot;
+        /* Hash of the timing key of slot[], compared before the keys */
+        u_int32_t *hash;
+};
+
+static void
+edid_mode_timing_key(struct edid_info *info, const struct edid_mode_entry *mode,
+                     struct edid_mode_timing_key *key)
+{
+        if (mode->vic) {
+                const struct edid_vic_timing *t = libedid_vic_timing(mode->vic);
+
+                key->pixel_clock_khz = mode->pixel_clock_khz;
+                key->h = (u_int32_t)t->hactive << 16 | t->hblank;
+                key->hsync = (u_int32_t)t->hfrontp << 16 | t->hsync;
+                key->v = (u_int32_t)t->vactive << 16 | t->vblank;
+                key->vsync = (u_int32_t)t->vfrontp << 16 | t->vsync;
+                key->interlaced = !!(t->flags & EDID_VIC_INTERLACED);
+        } else {
+                const struct detailed_mode *d;
+
+                if (mode->flags & EDID_MODE_BASE_DTD)
+                        d = &info->base_blk.dmodes[mode->dtd];
+                else if (mode->flags & EDID_MODE_STD)
+                        d = &info->base_blk.std_modes[mode->dtd];
+                else if (mode->flags & EDID_MODE_DISPLAYID)
+                        d = &info->displayid.modes[mode->dtd];
+                else
+                        d = &info->cea_blks.dtd.d_modes[mode->dtd];
+
+                key->pixel_clock_khz = d->pixel_clock_khz;
+                key->h = (u_int32_t)d->hactive << 16 | d->hblank;
+                key->hsync = (u_int32_t)d->hfrontp << 16 | d->hsync;
+                key->v = (u_int32_t)d->vactive << 16 | d->vblank;
+                key->vsync = (u_int32_t)d->vfrontp << 16 | d->vsync;
+                key->interlaced = !!d->interlaced;
+        }
+}
+
+/* Keep the mode just written at modes[n_modes], unless its timing is already there */
+static void
+edid_rank_mode(struct edid_mode_ranker *rk)
+{
+        struct edid_mode_timing_key key, other;
+        const u_int32_t *w = (const u_int32_t *)&key;
+        u_int32_t h = 2166136261u;
+        unsigned int i, slot;
+
+        edid_mode_timing_key(rk->info, &rk->modes[rk->n_modes], &key);
+        for (i = 0; i < sizeof(key) / sizeof(*w); i++)
+                h = (h ^ w[i]) * 16777619u;
+
+        for (slot = h & rk->mask; rk->slot[slot] != EDID_DB_NONE;
+                        slot = (slot + 1) & rk->mask) {
+                if (rk->hash[slot] != h)
+                        continue;
+
+                edid_mode_timing_key(rk->info, &rk->modes[rk->slot[slot]], &other);
+                if (!memcmp(&key, &other, sizeof(key)))
+                        return;
+        }
+
+        rk->slot[slot] = rk->n_modes++;
+        rk->hash[slot] = h;
+}
+
+static void
+edid_rank_dtd(struct edid_mode_ranker *rk, struct detailed_mode *dtd,
+              u_int8_t n, u_int8_t flags)
+{
+        u_int64_t total = (u_int64_t)(dtd->hactive + dtd->hblank) *
+                (dtd->vactive + dtd->vblank);
+        struct edid_mode_entry *mode;
+
+        if (!dtd->pixel_clock_khz || !total)
+                return;
+
+        if (rk->n_modes >= rk->n_max) {
+                rk->n_dropped++;
+                return;
+        }
+
+        mode = &rk->modes[rk->n_modes];
+        mode->hactive = dtd->hactive;
+        mode->pixel_clock_khz = dtd->pixel_clock_khz;
+        /* Vertical timings of interlaced DTDs are per field */
+        mode->vactive = dtd->interlaced ? dtd->vactive * 2 : dtd->vactive;
+        mode->refresh_mhz = ((u_int64_t)dtd->pixel_clock_khz * 1000000 + total / 2) / total;
+        mode->vic = 0;
+        mode->flags = flags | (dtd->interlaced ? EDID_MODE_INTERLACED : 0);
+        mode->dtd = n;
+        edid_rank_mode(rk);
+}
+
+static void
+edid_rank_vic(struct edid_mode_ranker *rk, u_int8_t vic, bool fractional)
+{
+        const struct edid_vic_timing *timing = libedid_vic_timing(vic);
+        struct edid_mode_entry *mode;
+        bool interlaced;
+
+        if (!timing || (fractional && !(timing->flags & EDID_VIC_FRACTIONAL)))
+                return;
+
+        if (rk->n_modes >= rk->n_max) {
+                rk->n_dropped++;
+                return;
+        }
+
+        interlaced = timing->flags & EDID_VIC_INTERLACED;
+        mode = &rk->modes[rk->n_modes];
+        mode->hactive = timing->hactive;
+        mode->vactive = interlaced ? timing->vactive * 2 : timing->vactive;
+        mode->refresh_mhz = fractional ? timing->frac_refresh_mhz : timing->refresh_mhz;
+        mode->pixel_clock_khz = fractional ? timing->frac_pixel_clock_khz :
+                timing->pixel_clock_khz;
+        mode->vic = vic;
+        mode->flags = (interlaced ? EDID_MODE_INTERLACED : 0) |
+                (fractional ? EDID_MODE_FRACTIONAL : 0);
+        mode->dtd = 0;
+        edid_rank_mode(rk);
+}
+
+/* DTD number n (from 1) of the EDID, base block first, as the SVRs 129-144 count them */
+static void
+edid_rank_nth_dtd(struct edid_mode_ranker *rk, unsigned int n)
+{
+        struct edid_info *info = rk->info;
+        int i;
+
+        for (i = 0; i < 4; i++) {
+                if (info->base_blk.dmodes[i].pixel_clock_khz && !--n) {
+                        edid_rank_dtd(rk, &info->base_blk.dmodes[i], i, EDID_MODE_BASE_DTD);
+                        return;
+                }
+        }
+
+        if (n <= info->cea_blks.dtd.n_dtd_modes)
+                edid_rank_dtd(rk, &info->cea_blks.dtd.d_modes[n - 1], n - 1, 0);
+}
+
+static bool
+edid_vic_listed(const u_int64_t *vics, u_int8_t vic)
+{
+        return vic && (vics[(vic - 1) / 64] >> ((vic - 1) % 64)) & 1;
+}
+
+/*
+ * Index every DTD, established and standard timing, DisplayID timing and
+ * VIC of the display, once per distinct timing. ranked keeps them in order
+ * of preference: the video format preference block first, then the native
+ * VICs, the first DTD, the other DTDs, the VICs, the DisplayID and the
+ * standard timings. modes is the same set, sorted so that lookups are
+ * binary searches, with the refresh rates worked out once here.
+ */
+static int
+edid_build_mode_index(struct edid_info *info)
+{
+        struct edid_mode_index *idx = &info->mode_index;
+        struct edid_tags *etags = &info->cea_blks;
+        struct edid_mode_ranker rk;
+        const struct edid_db_entry *vfpdb;
+        u_int64_t vics[4];
+        unsigned int n_max = 4 + info->base_blk.n_std_modes + etags->dtd.n_dtd_modes +
+                info->displayid.n_modes;
+        unsigned int size;
+        int word, i, vic;
+
+        for (word = 0; word < 4; word++) {
+                vics[word] = etags->vics[word] | etags->vics_420_only[word] |
+                        etags->vics_420_also[word];
+                /* Room for the fractional variant too */
+                n_max += 2 * __builtin_popcountll(vics[word]);
+        }
+
+        if (n_max > EDID_MODE_MAX)
+                n_max = EDID_MODE_MAX;
+        size = edid_mode_hash_size(n_max);
+
+        idx->n_modes = 0;
+        idx->ranked = edid_alloc(info, n_max * sizeof(struct edid_mode_entry));
+        idx->modes = edid_alloc(info, n_max * sizeof(struct edid_mode_entry));
+        /* Only needed here, but taken from the arena like the rest */
+        rk.hash = edid_alloc(info, size * (sizeof(rk.hash[0]) + sizeof(rk.slot[0])));
+        if (!idx->ranked || !idx->modes || !rk.hash) {
+                edid_error("Out of memory for the mode index\n");
+                edid_report(info, EDID_DIAG_ERROR, EDID_DIAG_NO_MEMORY, 0, 0, EDID_DECODE_MODES);
+                if (!(info->flags & EDID_PARSE_ARENA))
+                        free(rk.hash);
+                return -1;
+        }
+
+        rk.info = info;
+        rk.modes = idx->ranked;
+        rk.n_modes = 0;
+        rk.n_max = n_max;
+        rk.n_dropped = 0;
+        rk.mask = size - 1;
+        rk.slot = (u_int16_t *)&rk.hash[size];
+        memset(rk.slot, 0xFF, size * sizeof(rk.slot[0]));
+
+        vfpdb = libedid_find_db(info, CEA_DATA_BLOCK_EXTENDED, CEA_DATA_BLOCK_EXT_VF_PREF);
+        if (vfpdb && vfpdb->len > 1) {
+                u_int8_t *svr = &info->raw_edid[vfpdb->offset + 2];
+
+                for (i = 0; i < vfpdb->len - 1; i++) {
+                        if (svr[i] >= 129 && svr[i] <= 144)
+                                edid_rank_nth_dtd(&rk, svr[i] - 128);
+                        else if (edid_vic_listed(vics, svr[i]))
+                                edid_rank_vic(&rk, svr[i], false);
+                }
+        }
+
+        for (vic = 1; vic < 256; vic++)
+                if ((etags->vic_caps[vic].flags & EDID_VIC_CAP_NATIVE) &&
+                                edid_vic_listed(vics, vic))
+                        edid_rank_vic(&rk, vic, false);
+
+        edid_rank_nth_dtd(&rk, 1);
+        for (i = 0; i < 4; i++)
+                edid_rank_dtd(&rk, &info->base_blk.dmodes[i], i, EDID_MODE_BASE_DTD);
+        for (i = 0; i < etags->dtd.n_dtd_modes; i++)
+                edid_rank_dtd(&rk, &etags->dtd.d_modes[i], i, 0);
+
+        for (word = 0; word < 4; word++) {
+                u_int64_t bits = vics[word];
+
+                while (bits) {
+                        vic = word * 64 + __builtin_ctzll(bits) + 1;
+                        bits &= bits - 1;
+                        edid_rank_vic(&rk, vic, false);
+                        edid_rank_vic(&rk, vic, true);
+                }
+        }
+
+        for (i = 0; i < info->displayid.n_modes; i++)
+                edid_rank_dtd(&rk, &info->displayid.modes[i], i, EDID_MODE_DISPLAYID);
+        for (i = 0; i < info->base_blk.n_std_modes; i++)
+                edid_rank_dtd(&rk, &info->base_blk.std_modes[i], i, EDID_MODE_STD);
+
+        if (!(info->flags & EDID_PARSE_ARENA))
+                free(rk.hash);
+
+        if (rk.n_dropped) {
+                edid_warn("Mode index full, %d modes left out\n", rk.n_dropped);
+                edid_report(info, EDID_DIAG_WARN, EDID_DIAG_MODE_LIMIT, 0, 0,
+                        rk.n_dropped > 0xFFFF ? 0xFFFF : rk.n_dropped);
+        }
+
+        idx->n_modes = rk.n_modes;
+        memcpy(idx->modes, idx->ranked, idx->n_modes * sizeof(struct edid_mode_entry));
+        qsort(idx->modes, idx->n_modes, sizeof(struct edid_mode_entry), edid_mode_cmp);
+        edid_debug("Indexed %d modes\n", idx->n_modes);
+        return 0;
+}
+
+_Static_assert(sizeof(struct edid_caps) == 64, "struct edid_caps must be one cache line");
+
+#define EDID_CAP_IF(cond, bit) ((cond) ? (bit) : 0)
+
+/* Fold the decoded groups into the flat capability profile, complete
+ * once EDID_DECODE_CAPS is decoded
+ */
+static void
+edid_build_caps(struct edid_info *info)
+{
+        struct edid_caps *caps = &info->caps;
+        struct edid_tags *etags = &info->cea_blks;
+        struct edid_base_blk *bb = &info->base_blk;
+        struct hdmi_vsdb *hdmi = &etags->hdmi_vsdb;
+        struct hf_vsdb *hf = &etags->hfvsdb;
+        struct cea_colorimetry *clr = &etags->colorimetry;
+        struct cea_static_hdr_md *smd = &etags->hdr_smd;
+
+        memset(caps, 0, sizeof(*caps));
+        caps->bits = EDID_CAP_IF(bb->clr_formats.clr_format_rgb444, EDID_CAP_RGB444) |
+                EDID_CAP_IF(bb->clr_formats.clr_format_ycbcr444, EDID_CAP_YCBCR444) |
+                EDID_CAP_IF(bb->clr_formats.clr_format_ycbcr422, EDID_CAP_YCBCR422) |
+                EDID_CAP_IF(bb->clr_formats.clr_format_ycbcr420, EDID_CAP_YCBCR420) |
+                EDID_CAP_IF(bb->srgb_default, EDID_CAP_SRGB_DEFAULT) |
+                EDID_CAP_IF(hdmi->dc_30_bpc, EDID_CAP_DC_30) |
+                EDID_CAP_IF(hdmi->dc_36_bpc, EDID_CAP_DC_36) |
+                EDID_CAP_IF(hdmi->dc_48_bpc, EDID_CAP_DC_48) |
+                EDID_CAP_IF(hdmi->dc_ycbcr444, EDID_CAP_DC_Y444) |
+                EDID_CAP_IF(hdmi->ai, EDID_CAP_HDMI_AI) |
+                EDID_CAP_IF(hdmi->dvi_dual, EDID_CAP_DVI_DUAL) |
+                EDID_CAP_IF(hf->dc_30_420, EDID_CAP_DC420_30) |
+                EDID_CAP_IF(hf->dc_36_420, EDID_CAP_DC420_36) |
+                EDID_CAP_IF(hf->dc_48_420, EDID_CAP_DC420_48) |
+                EDID_CAP_IF(hf->scdc, EDID_CAP_SCDC) |
+                EDID_CAP_IF(hf->rr, EDID_CAP_SCDC_RR) |
+                EDID_CAP_IF(hf->scrambling_340mhz, EDID_CAP_SCRAMBLING_340) |
+                EDID_CAP_IF(hf->max_frl_rate, EDID_CAP_FRL) |
+                EDID_CAP_IF(hf->osd_3d, EDID_CAP_3D_OSD) |
+                EDID_CAP_IF(hf->iv, EDID_CAP_3D_IV) |
+                EDID_CAP_IF(hf->dv, EDID_CAP_3D_DV) |
+                EDID_CAP_IF(clr->BT2020_RGB, EDID_CAP_BT2020_RGB) |
+                EDID_CAP_IF(clr->BT2020_YCC, EDID_CAP_BT2020_YCC) |
+                EDID_CAP_IF(clr->BT2020_CYCC, EDID_CAP_BT2020_CYCC) |
+                EDID_CAP_IF(clr->DCIP3, EDID_CAP_DCIP3) |
+                EDID_CAP_IF(clr->xvYCC_601, EDID_CAP_XVYCC_601) |
+                EDID_CAP_IF(clr->xvYCC_709, EDID_CAP_XVYCC_709) |
+                EDID_CAP_IF(clr->sYCC_601, EDID_CAP_SYCC_601) |
+                EDID_CAP_IF(clr->opYCC_601, EDID_CAP_OPYCC_601) |
+                EDID_CAP_IF(clr->opRGB, EDID_CAP_OPRGB) |
+                EDID_CAP_IF(smd->gamma_sdr, EDID_CAP_EOTF_SDR) |
+                EDID_CAP_IF(smd->gamma_hdr, EDID_CAP_EOTF_HDR) |
+                EDID_CAP_IF(smd->gamma_st2084, EDID_CAP_EOTF_ST2084) |
+                EDID_CAP_IF(smd->gamma_hlg, EDID_CAP_EOTF_HLG) |
+                EDID_CAP_IF(smd->static_md_type_1, EDID_CAP_HDR_STATIC_MD1) |
+                EDID_CAP_IF(etags->hdr_dmd.n_views, EDID_CAP_HDR_DYNAMIC_MD) |
+                EDID_CAP_IF(etags->audio, EDID_CAP_AUDIO) |
+                EDID_CAP_IF(etags->it_underscan, EDID_CAP_UNDERSCAN) |
+                EDID_CAP_IF(etags->vcap.quant_range_selectable_rgb, EDID_CAP_QS_RGB) |
+                EDID_CAP_IF(etags->vcap.quant_range_selectable_ycc, EDID_CAP_QS_YCC) |
+                EDID_CAP_IF(info->displayid.tile.n_htiles, EDID_CAP_TILED);
+
+        /* HF-VSDB value gets the priority */
+        caps->max_tmds_clk_mhz = hf->max_tmds_rate_mhz ? hf->max_tmds_rate_mhz :
+                hdmi->max_tmds_clock_mhz;
+        caps->hdr_max_lum = smd->content_max_lum;
+        caps->hdr_fav_lum = smd->content_fav_lum;
+        caps->hdr_min_lum = smd->content_min_lum;
+        caps->max_frl_rate = hf->max_frl_rate;
+        caps->max_bpc = hdmi->dc_48_bpc ? 16 : hdmi->dc_36_bpc ? 12 : hdmi->dc_30_bpc ? 10 : 8;
+        caps->max_420_bpc = hf->dc_48_420 ? 16 : hf->dc_36_420 ? 12 : hf->dc_30_420 ? 10 : 0;
+        caps->base_bpc = bb->clr_depth;
+
+        caps->pid = bb->pid;
+        caps->sno = bb->sno;
+        memcpy(caps->vendor, bb->vendor, sizeof(caps->vendor));
+        caps->n_ext_blks = etags->n_cea_ext_blks;
+}
+
+/*
+ * Decode the accessor groups which are not decoded yet. Lazy handles only
+ * get here on first use of a group, eager ones decode everything at once.
+ */
+int libedid_decode_groups(struct edid_info *info, u_int32_t groups)
+{
+        if (!info)
+                return -1;
+
+        groups &= EDID_DECODE_ALL & ~info->decoded;
+        if (!groups)
+                return 0;
+
+        /* The mode index is built from the DTDs and the VICs */
+        if (groups & EDID_DECODE_MODES)
+                groups |= (EDID_DECODE_DTD | EDID_DECODE_VIDEO) & ~info->decoded;
+
+        /* And the caps from everything but those */
+        if (groups & EDID_DECODE_CAPS)
+                groups |= (EDID_DECODE_BASE | EDID_DECODE_CEA_HDR | EDID_DECODE_VIDEO |
+                        EDID_DECODE_VSDB | EDID_DECODE_COLORIMETRY | EDID_DECODE_HDR |
+                        EDID_DECODE_MISC) & ~info->decoded;
+
+        decode_edid_base_block(info->raw_edid, info, groups);
+        if (process_edid_cea_extension_blocks(info->raw_edid, info, groups)) {
+                edid_error("Failed to process CEA extension blocks\n");
+                return -1;
+        }
+        process_edid_displayid_blocks(info->raw_edid, info, groups);
+
+        if ((groups & EDID_DECODE_MODES) && edid_build_mode_index(info))
+                return -1;
+
+        /* The caps bits of the groups decoded so far, groups which are not
+         * decoded yet are zeroed and leave theirs off
+         */
+        if (groups & ~EDID_DECODE_MODES)
+                edid_build_caps(info);
+
+        info->decoded |= groups;
+        return 0;
+}
+
+/*
+ * Add up the 128 bytes of a block, 8 at a time: even and odd bytes go to
+ * separate 16 bit lanes, which can't overflow in 16 steps. Only the low
+ * byte of the total matters for the checksum.
+ */
+static inline u_int8_t
+edid_block_sum(const u_int8_t *blk)
+{
+        u_int64_t even = 0, odd = 0, w;
+        int i;
+
+        for (i = 0; i < CEA_EXTN_BLK_SIZE; i += 8) {
+                memcpy(&w, &blk[i], 8);
+                even += w & 0x00FF00FF00FF00FFULL;
+                odd += (w >> 8) & 0x00FF00FF00FF00FFULL;
+        }
+
+        even += odd;
+        even += even >> 32;
+        even += even >> 16;
+        return even & 0xFF;
+}
+
+/* The CTA data blocks between start and end must end exactly at end */
+static int
+edid_validate_db_collection(const u_int8_t *blk, unsigned int start, unsigned int end)
+{
+        if (edid_db_collection_end(blk, start, end) != end)
+                return EDID_VALIDATE_DB_BOUNDS;
+
+        return EDID_VALIDATE_OK;
+}
+
+/* The data blocks of a CEA extension must end exactly at d */
+static int
+edid_validate_cea_block(const u_int8_t *cea)
+{
+        unsigned int d = cea[2];
+
+        /* d = 0 means no data blocks and no DTDs */
+        if (!d)
+                return EDID_VALIDATE_OK;
+
+        if (d < 4 || d > CEA_EXTN_BLK_SIZE - 1)
+                return EDID_VALIDATE_DB_BOUNDS;
+
+        return edid_validate_db_collection(cea, 4, d);
+}
+
+/* One DisplayID section, and the CTA data blocks it carries */
+static int
+edid_validate_displayid_block(const u_int8_t *blk)
+{
+        unsigned int off, end = DISPLAYID_HDR_SIZE + blk[2];
+
+        if (!displayid_section_fits(blk))
+                return EDID_VALIDATE_DB_BOUNDS;
+
+        /* The parser skips a section which doesn't add up, so its data
+         * blocks don't matter
+         */
+        if (!displayid_section_ok(blk))
+                return EDID_VALIDATE_OK;
+
+        for (off = DISPLAYID_HDR_SIZE; off + DISPLAYID_DB_HDR_SIZE <= end;
+                        off += DISPLAYID_DB_HDR_SIZE + blk[off + 2]) {
+                /* Zero padding up to the end of the section */
+                if (!blk[off] && !blk[off + 2])
+                        break;
+
+                if (off + DISPLAYID_DB_HDR_SIZE + blk[off + 2] > end)
+                        return EDID_VALIDATE_DB_BOUNDS;
+
+                if (blk[off] == DISPLAYID_CTA_DATA &&
+                                edid_validate_db_collection(blk, off + DISPLAYID_DB_HDR_SIZE,
+                                        off + DISPLAYID_DB_HDR_SIZE + blk[off + 2]))
+                        return EDID_VALIDATE_DB_BOUNDS;
+        }
+
+        return EDID_VALIDATE_OK;
+}
+
+/* Data block bounds of block blk, 0 is the base block */
+static int
+edid_validate_blk_layout(const u_int8_t *b, unsigned int blk)
+{
+        if (blk && b[0] == CEA_EXT_BLK_TAG_VALUE && edid_validate_cea_block(b))
+                return EDID_VALIDATE_DB_BOUNDS;
+
+        if (blk && b[0] == DISPLAYID_EXT_BLK_TAG_VALUE)
+                return edid_validate_displayid_block(b);
+
+        return EDID_VALIDATE_OK;
+}
+
+/* libedid_validate_edid(), *bad_blk gets the block which failed. Only
+ * EDID_PARSE_BASE_COUNT matters in flags.
+ */
+static int
+edid_validate(const u_int8_t *raw_edid, size_t len, u_int32_t flags, unsigned int *bad_blk)
+{
+        const u_int8_t header[] = {0x0, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x0};
+        const struct edid *edid = (const struct edid *)raw_edid;
+        unsigned int blk, n_blks;
+
+        /* Truncated: the first block which is not all there */
+        *bad_blk = len / CEA_EXTN_BLK_SIZE;
+        if (!raw_edid || len < CEA_EXTN_BLK_SIZE ||
+                        len < (edid->extensions + 1) * CEA_EXTN_BLK_SIZE)
+                return EDID_VALIDATE_TRUNCATED;
+
+        *bad_blk = 0;
+        if (memcmp(edid->header, header, sizeof(header)))
+                return EDID_VALIDATE_HEADER;
+
+        /* A HF-EEODB can make it longer than the base block says */
+        n_blks = edid_n_ext_blks(raw_edid, flags);
+        *bad_blk = len / CEA_EXTN_BLK_SIZE;
+        if (len < (n_blks + 1) * CEA_EXTN_BLK_SIZE)
+                return EDID_VALIDATE_TRUNCATED;
+
+        /* Block maps too, they are checksummed like the others */
+        for (blk = 0; blk <= n_blks; blk++) {
+                const u_int8_t *b = &raw_edid[blk * CEA_EXTN_BLK_SIZE];
+                int ret;
+
+                *bad_blk = blk;
+                if (edid_block_sum(b))
+                        return EDID_VALIDATE_CHECKSUM;
+
+                ret = edid_validate_blk_layout(b, blk);
+                if (ret)
+                        return ret;
+        }
+
+        return EDID_VALIDATE_OK;
+}
+
+int libedid_validate_edid(const u_int8_t *raw_edid, size_t len)
+{
+        unsigned int bad_blk;
+
+        return edid_validate(raw_edid, len, 0, &bad_blk);
+}
+
+static u_int8_t
+edid_validate_diag_code(int ret)
+{
+        switch (ret) {
+        case EDID_VALIDATE_TRUNCATED:
+                return EDID_DIAG_TRUNCATED;
+        case EDID_VALIDATE_HEADER:
+                return EDID_DIAG_HEADER;
+        case EDID_VALIDATE_CHECKSUM:
+                return EDID_DIAG_CHECKSUM;
+        default:
+                return EDID_DIAG_DB_BOUNDS;
+        }
+}
+
+int libedid_validate_edid_flags(const u_int8_t *raw_edid, size_t len, u_int32_t flags)
+{
+        unsigned int bad_blk;
+        int ret = edid_validate(raw_edid, len, flags, &bad_blk);
+
+        if (ret == EDID_VALIDATE_OK)
+                return ret;
+
+        /* Block numbers past 255 only come with a truncated length */
+        if (bad_blk > 255)
+                bad_blk = 255;
+
+        edid_report(NULL, EDID_DIAG_ERROR, edid_validate_diag_code(ret), bad_blk,
+                bad_blk * CEA_EXTN_BLK_SIZE, 0);
+        return ret;
+}
+
+int libedid_validate_edid_diag(const u_int8_t *raw_edid, size_t len)
+{
+        return libedid_validate_edid_flags(raw_edid, len, 0);
+}
+
+/*
+ * Validate before parsing, 0 if the EDID can be parsed. Unless
+ * EDID_PARSE_STRICT, bad checksums and data blocks out of bounds are only
+ * reported, and the parser skips what is out of bounds. A truncated EDID,
+ * or a bad header, is rejected either way.
+ */
+static int
+edid_validate_report(const u_int8_t *raw_edid, size_t len, u_int32_t flags,
+                     struct edid_diags *diags)
+{
+        unsigned int bad_blk, blk, n_blks;
+        int ret = edid_validate(raw_edid, len, flags, &bad_blk);
+
+        if (ret == EDID_VALIDATE_OK)
+                return 0;
+
+        if ((flags & EDID_PARSE_STRICT) || ret == EDID_VALIDATE_TRUNCATED ||
+                        ret == EDID_VALIDATE_HEADER)
+                return libedid_validate_edid_flags(raw_edid, len, flags);
+
+        n_blks = edid_n_ext_blks(raw_edid, flags);
+        for (blk = bad_blk; blk <= n_blks; blk++) {
+                const u_int8_t *b = &raw_edid[blk * CEA_EXTN_BLK_SIZE];
+
+                if (edid_block_sum(b))
+                        edid_report_to(diags, EDID_DIAG_WARN, EDID_DIAG_CHECKSUM, blk,
+                                blk * CEA_EXTN_BLK_SIZE, 0);
+
+                ret = edid_validate_blk_layout(b, blk);
+                if (ret)
+                        edid_report_to(diags, EDID_DIAG_WARN, edid_validate_diag_code(ret),
+                                blk, blk * CEA_EXTN_BLK_SIZE, 0);
+        }
+
+        return 0;
+}
+
+size_t libedid_validate_edids(const u_int8_t *const *raw_edids, const size_t *lens,
+                int *status, size_t n)
+{
+        size_t invalid = 0;
+        size_t i;
+
+        for (i = 0; i < n; i++) {
+                status[i] = libedid_validate_edid(raw_edids[i], lens[i]);
+                if (status[i] != EDID_VALIDATE_OK)
+                        invalid++;
+        }
+
+        return invalid;
+}
+
+/*
+ * Walk the CEA data blocks once, and add up the bytes which the parser is
+ * going to allocate for them. This must stay in sync with the parse_*
+ * functions above, which is why it mirrors their length checks.
+ */
+static size_t
+edid_prescan_db_size(u_int8_t *db, u_int8_t dblen, size_t *hdr_dmd_size)
+{
+        u_int8_t tag = CEA_EXT_BLK_TAG(db[0]);
+        u_int32_t oui;
+
+        if (!dblen)
+                return 0;
+
+        /* Skip the tag byte */
+        db++;
+
+        switch (tag) {
+        case CEA_DATA_BLOCK_VENDOR:
+                if (dblen < 4)
+                        return 0;
+
+                oui = db[2] << 16 | db[1] << 8 | db[0];
+                if (oui == HDMI_IEEE_OUI || oui == HDMI_FORUM_IEEE_OUI)
+                        return 0;
+
+                return EDID_ARENA_ALIGN(dblen - 3);
+
+        case CEA_DATA_BLOCK_EXTENDED:
+                /* Extended tag is counted in dblen */
+                dblen--;
+
+                switch (db[0]) {
+                case CEA_DATA_BLOCK_EXT_VSVDB:
+                        return dblen < 4 ? 0 : EDID_ARENA_ALIGN(dblen - 3);
+
+                case CEA_DATA_BLOCK_EXT_IFDB:
+                        if (dblen < 2)
+                                return 0;
+                        return EDID_ARENA_ALIGN(cea_ifdb_payload_len(&db[1], dblen));
+
+                case CEA_DATA_BLOCK_EXT_HDR_DYNAMIC_MD:
+                        /* Reserved in one piece, see hdr_dmd_size */
+                        if (dblen >= 2)
+                                *hdr_dmd_size += dblen;
+                        return 0;
+
+                default:
+                        return 0;
+                }
+
+        default:
+                return 0;
+        }
+}
+
+struct edid_prescan {
+        /* Arena bytes for everything but edid_info itself */
+        size_t payload_size;
+        size_t hdr_dmd_size;
+        /* edid_n_ext_blks() of this parse */
+        u_int8_t n_blks;
+        u_int16_t n_db;
+        /* Upper bound of the mode index entries */
+        u_int16_t n_modes;
+};
+
+static void
+edid_prescan(u_int8_t *raw_edid, u_int32_t flags, struct edid_prescan *ps)
+{
+        /* Viewed payloads need no room, but for the dynamic HDR metadata
+         * blocks, copied together when there is more than one
+         */
+        bool views = flags & EDID_PARSE_VIEWS;
+        size_t total = 0, db_size;
+        unsigned int n_std, n_did, n_did_vics, n_dtds, blk;
+        struct edid_blk_reader r;
+
+        memset(ps, 0, sizeof(*ps));
+        ps->n_blks = edid_n_ext_blks(raw_edid, flags);
+        for_each_ext_blk(r, raw_edid, ps->n_blks, blk) {
+                u_int8_t *cea = &raw_edid[blk * CEA_EXTN_BLK_SIZE];
+                struct edid_db_range ranges[EDID_MAX_DB_RANGES];
+                int n_ranges = edid_blk_db_ranges(cea, ranges);
+                int r;
+
+                for (r = 0; r < n_ranges; r++) {
+                        unsigned int start = ranges[r].start;
+
+                        while (start < ranges[r].end) {
+                                u_int8_t dblen = CEA_EXT_BLK_DATA_LEN(cea[start]);
+                                u_int8_t tag = CEA_EXT_BLK_TAG(cea[start]);
+
+                                /* Every SVD can be a VIC, and its fractional variant */
+                                if (tag == CEA_DATA_BLOCK_VIDEO)
+                                        ps->n_modes += 2 * dblen;
+                                else if (tag == CEA_DATA_BLOCK_EXTENDED && dblen &&
+                                                cea[start + 1] == CEA_DATA_BLOCK_EXT_YCBCR420_VDB)
+                                        ps->n_modes += 2 * (dblen - 1);
+
+                                db_size = edid_prescan_db_size(&cea[start], dblen,
+                                                               &ps->hdr_dmd_size);
+                                if (!views)
+                                        total += db_size;
+                                start += dblen + 1;
+                                ps->n_db++;
+                        }
+                }
+
+        }
+
+        /* The CEA DTDs, in one array, and the per block records */
+        n_dtds = edid_cea_n_dtds(raw_edid, ps->n_blks);
+        total += EDID_ARENA_ALIGN(n_dtds * sizeof(struct detailed_mode));
+        ps->n_modes += n_dtds;
+        total += EDID_ARENA_ALIGN(ps->n_blks * sizeof(struct edid_ext_blk));
+
+        /* The DisplayID timings, and the VICs of the DisplayID blocks */
+        n_did = edid_displayid_n_modes(raw_edid, ps->n_blks, &n_did_vics);
+        total += EDID_ARENA_ALIGN(n_did * sizeof(struct detailed_mode));
+        ps->n_modes += n_did + 2 * n_did_vics;
+
+        /* Plus the 4 DTDs, and the established and standard timings, of the base block */
+        n_std = edid_bb_n_std_modes(raw_edid);
+        total += EDID_ARENA_ALIGN(n_std * sizeof(struct detailed_mode));
+        ps->n_modes += 4 + n_std;
+        /* The mode index, sorted and ranked, and its dedup table */
+        total += 2 * EDID_ARENA_ALIGN(ps->n_modes * sizeof(struct edid_mode_entry));
+        total += EDID_ARENA_ALIGN(edid_mode_hash_size(ps->n_modes) *
+                (sizeof(u_int32_t) + sizeof(u_int16_t)));
+        total += EDID_ARENA_ALIGN(ps->n_db * sizeof(struct edid_db_entry));
+        ps->payload_size = total + EDID_ARENA_ALIGN(ps->hdr_dmd_size);
+}
+
+size_t libedid_edid_size(u_int8_t *raw_edid)
+{
+        if (!raw_edid)
+                return 0;
+
+        return (edid_n_ext_blks(raw_edid, 0) + 1) * CEA_EXTN_BLK_SIZE;
+}
+
+size_t libedid_edid_info_size(u_int8_t *raw_edid)
+{
+        struct edid_prescan ps;
+        unsigned int bad_blk;
+
+        if (!raw_edid || edid_validate(raw_edid, edid_base_size(raw_edid),
+                                       EDID_PARSE_BASE_COUNT, &bad_blk))
+                return 0;
+
+        edid_prescan(raw_edid, EDID_PARSE_BASE_COUNT, &ps);
+        return EDID_ARENA_ALIGN(sizeof(struct edid_info)) + ps.payload_size;
+}
+
+void libedid_destroy_edid_info(struct edid_info *info)
+{
+        struct edid_tags *etags;
+
+        if (!info)
+                return;
+
+        /* Everything lives in the arena, and the caller owns its buffer */
+        if (info->flags & EDID_PARSE_CALLER_BUF)
+                return;
+
+        if (info->flags & EDID_PARSE_OWN_RAW)
+                free(info->raw_edid);
+
+        if (info->flags & EDID_PARSE_ARENA) {
+                free(info);
+                return;
+        }
+
+        etags = &info->cea_blks;
+
+        if (etags->ifdb.data) {
+                free(etags->ifdb.data);
+                etags->ifdb.data = NULL;
+        }
+
+        if (etags->hdr_dmd.data) {
+                free(etags->hdr_dmd.data);
+                etags->hdr_dmd.data = NULL;
+        }
+
+        if (etags->vsdb.data) {
+                free(etags->vsdb.data);
+                etags->vsdb.data = NULL;
+        }
+
+        if (etags->vsvdb.data) {
+                free(etags->vsvdb.data);
+                etags->vsvdb.data = NULL;
+        }
+
+        if (info->base_blk.std_modes) {
+                free(info->base_blk.std_modes);
+                info->base_blk.std_modes = NULL;
+        }
+
+        if (etags->dtd.d_modes) {
                 free(etags->dtd.d_modes);
                 etags->dtd.d_modes = NULL;
         }
 
+        if (info->displayid.modes) {
+                free(info->displayid.modes);
+                info->displayid.modes = NULL;
+        }
+
+        if (info->db_index.entries) {
+                free(info->db_index.entries);
+                info->db_index.entries = NULL;
+        }
+
+        if (info->ext_blks) {
+                free(info->ext_blks);
+                info->ext_blks = NULL;
+        }
+
+        if (info->mode_index.modes) {
+                free(info->mode_index.modes);
+                info->mode_index.modes = NULL;
+        }
+
+        if (info->mode_index.ranked) {
+                free(info->mode_index.ranked);
+                info->mode_index.ranked = NULL;
+        }
+
         free(info);
 }
 
+static struct edid_info
+*edid_parse_into(struct edid_info *info, u_int8_t *raw_edid, struct edid_prescan *ps)
+{
+        /* Validated already. Unless strict, that may have let data blocks out
+         * of bounds through: the block walkers leave them out.
+         */
+        info->raw_edid = raw_edid;
+        info->cea_blks.n_cea_ext_blks = ps->n_blks;
+
+        if (edid_build_db_index(info, ps->n_db)) {
+                edid_error("Failed to index CEA data blocks\n");
+                return NULL;
+        }
+
+        /* Lazy handles stop here, and decode on first use */
+        if (info->flags & EDID_PARSE_LAZY)
+                return info;
+
+        if (libedid_decode_groups(info, EDID_DECODE_ALL))
+                return NULL;
+
+        return info;
+}
+
+static void
+edid_arena_init(struct edid_info *info, size_t size, size_t hdr_dmd_size)
+{
+        size_t hdr = EDID_ARENA_ALIGN(sizeof(struct edid_info));
+
+        info->arena.base = (u_int8_t *)info + hdr;
+        info->arena.size = size - hdr;
+        info->arena.used = 0;
+        info->arena.hdr_dmd_size = hdr_dmd_size;
+}
+
 struct edid_info
-*libedid_process_edid_info(u_int8_t *raw_edid)
+*libedid_process_edid_info_buf(u_int8_t *raw_edid, void *buf, size_t size)
 {
-        struct edid_info *info;
+        struct edid_info *info = buf;
+        struct edid_diags diags = { 0 };
+        struct edid_prescan ps;
 
-        info = malloc(sizeof(struct edid_info));
-        if (!info) {
-                edid_error("Out ot memory\n");
+        if (!raw_edid || !buf) {
+                edid_error("No EDID or buffer found in input\n");
+                edid_report(NULL, EDID_DIAG_ERROR, EDID_DIAG_NO_EDID, 0, 0, 0);
+                return NULL;
+        }
+
+        if ((uintptr_t)buf & 7) {
+                edid_error("EDID info buffer must be 8 byte aligned\n");
+                edid_report(NULL, EDID_DIAG_ERROR, EDID_DIAG_BAD_BUFFER, 0, 0, 0);
+                return NULL;
+        }
+
+        if (edid_validate_report(raw_edid, edid_base_size(raw_edid), EDID_PARSE_BASE_COUNT,
+                                 &diags)) {
+                edid_error("Corrupt EDID, rejecting\n");
+                return NULL;
+        }
+
+        edid_prescan(raw_edid, EDID_PARSE_BASE_COUNT, &ps);
+        if (size < EDID_ARENA_ALIGN(sizeof(struct edid_info)) + ps.payload_size) {
+                edid_error("EDID info buffer too small (%zu bytes)\n", size);
+                edid_report(NULL, EDID_DIAG_ERROR, EDID_DIAG_BAD_BUFFER, 0, 0, 1);
                 return NULL;
         }
 
         memset(info, 0, sizeof(struct edid_info));
-        info->raw_edid = raw_edid;
+        info->flags = EDID_PARSE_ARENA | EDID_PARSE_CALLER_BUF | EDID_PARSE_BASE_COUNT;
+        info->diags = diags;
+        edid_arena_init(info, size, ps.hdr_dmd_size);
 
-        if (process_edid_base_block(raw_edid, info)) {
-                edid_error("Failed to process base edid blocks\n");
-                goto error_free_info;
+        if (!edid_parse_into(info, raw_edid, &ps)) {
+                edid_error("Failed to process EDID\n");
+                return NULL;
         }
 
-        if (process_edid_cea_extension_blocks(raw_edid, info)) {
-                edid_error("Failed to process CEA extension blocks\n");
-                goto error_free_info;
+        return info;
+}
+
+struct edid_info
+*libedid_process_edid_info_len(u_int8_t *raw_edid, size_t len, u_int32_t flags)
+{
+        struct edid_info *info;
+        struct edid_diags diags = { 0 };
+        struct edid_prescan ps;
+        size_t size = sizeof(struct edid_info);
+        int ret;
+
+        if (!raw_edid) {
+                edid_error("No EDID found in input\n");
+                edid_report(NULL, EDID_DIAG_ERROR, EDID_DIAG_NO_EDID, 0, 0, 0);
+                return NULL;
+        }
+
+        /* Reject truncated (and with EDID_PARSE_STRICT, corrupt) EDIDs before
+         * allocating anything
+         */
+        if (!(flags & EDID_PARSE_VALIDATED)) {
+                ret = edid_validate_report(raw_edid, len, flags, &diags);
+                if (ret) {
+                        edid_error("Corrupt EDID (%d), rejecting\n", ret);
+                        return NULL;
+                }
+        }
+
+        /* Internal flags: caller buffers go through libedid_process_edid_info_buf(),
+         * and shared instances are marked by the parse cache.
+         */
+        flags &= ~(EDID_PARSE_CALLER_BUF | EDID_PARSE_SHARED);
+
+        /* With no payload copies, the DTDs go to the arena too */
+        if (flags & EDID_PARSE_VIEWS)
+                flags |= EDID_PARSE_ARENA;
+
+        edid_prescan(raw_edid, flags, &ps);
+        if (flags & EDID_PARSE_ARENA)
+                size = EDID_ARENA_ALIGN(sizeof(struct edid_info)) + ps.payload_size;
+
+        /* Cache line aligned, for the caps */
+        info = aligned_alloc(64, (size + 63) & ~(size_t)63);
+        if (!info) {
+                edid_error("Out ot memory\n");
+                edid_report(NULL, EDID_DIAG_ERROR, EDID_DIAG_NO_MEMORY, 0, 0, 0);
+                return NULL;
         }
 
+        memset(info, 0, sizeof(struct edid_info));
+        info->flags = flags;
+        info->diags = diags;
+        if (flags & EDID_PARSE_ARENA)
+                edid_arena_init(info, size, ps.hdr_dmd_size);
+        else
+                info->arena.hdr_dmd_size = ps.hdr_dmd_size;
+
+        if (!edid_parse_into(info, raw_edid, &ps))
+                goto error_free_info;
+
         return info;
 
 error_free_info:
-        free(info);
+        /* The raw EDID stays with the caller when parsing fails */
+        info->flags &= ~EDID_PARSE_OWN_RAW;
+        libedid_destroy_edid_info(info);
         edid_error("Failed to process EDID\n");
         return NULL;
-}
\ No newline at end of file
+}
+
+struct edid_info
+*libedid_process_edid_info_flags(u_int8_t *raw_edid, u_int32_t flags)
+{
+        if (!raw_edid) {
+                edid_error("No EDID found in input\n");
+                edid_report(NULL, EDID_DIAG_ERROR, EDID_DIAG_NO_EDID, 0, 0, 0);
+                return NULL;
+        }
+
+        return libedid_process_edid_info_len(raw_edid, edid_base_size(raw_edid),
+                                             flags | EDID_PARSE_BASE_COUNT);
+}
+
+struct edid_info
+*libedid_process_edid_info(u_int8_t *raw_edid)
+{
+        return libedid_process_edid_info_flags(raw_edid, 0);
+}
+
+#define EDID_COMPACT_BIT(bits, bit) (((bits) & (bit)) ? 1 : 0)
+
+void libedid_compact_edid_info(struct edid_info *info, struct edid_compact *compact)
+{
+        struct edid_tags *etags = &info->cea_blks;
+        struct edid_base_blk *bb = &info->base_blk;
+        struct vsdb_phy *phy = &etags->hdmi_vsdb.phy;
+
+        libedid_decode_groups(info, EDID_DECODE_CAPS);
+
+        memset(compact, 0, sizeof(*compact));
+        compact->bits = info->caps.bits;
+        compact->sno = bb->sno;
+        compact->pid = bb->pid;
+        compact->vendor = (bb->vendor[0] & 0x1F) << 10 | (bb->vendor[1] & 0x1F) << 5 |
+                (bb->vendor[2] & 0x1F);
+        compact->phy = phy->a << 12 | phy->b << 8 | phy->c << 4 | phy->d;
+        compact->hdmi_max_tmds = etags->hdmi_vsdb.max_tmds_clock_mhz / 5;
+        compact->hf_max_tmds = etags->hfvsdb.max_tmds_rate_mhz / 5;
+        compact->hf_version = etags->hfvsdb.version;
+        compact->n_lum_cv = etags->hdr_smd.n_lum_cv;
+        memcpy(compact->lum_cv, etags->hdr_smd.lum_cv, sizeof(compact->lum_cv));
+        /* Only digital inputs get their gamma decoded */
+        compact->digital = bb->gamma_x100 != 0;
+        if (compact->digital)
+                compact->gamma = bb->gamma_x100 - 100;
+        compact->base_bpc = bb->clr_depth;
+        compact->max_frl_rate = etags->hfvsdb.max_frl_rate;
+        compact->pt = etags->vcap.pt;
+        compact->it = etags->vcap.it;
+        compact->ce = etags->vcap.ce;
+        compact->standby = bb->standby;
+        compact->suspend = bb->suspend;
+        compact->active_off = bb->active_off;
+}
+
+struct edid_info
+*libedid_expand_compact_info(const struct edid_compact *compact)
+{
+        struct edid_info *info;
+        struct edid_tags *etags;
+        struct edid_base_blk *bb;
+        u_int64_t bits = compact->bits;
+
+        info = aligned_alloc(64, (sizeof(struct edid_info) + 63) & ~(size_t)63);
+        if (!info) {
+                edid_error("Out ot memory\n");
+                return NULL;
+        }
+
+        memset(info, 0, sizeof(struct edid_info));
+        etags = &info->cea_blks;
+        bb = &info->base_blk;
+
+        bb->sno = compact->sno;
+        bb->pid = compact->pid;
+        bb->vendor[0] = ((compact->vendor >> 10) & 0x1F) + '@';
+        bb->vendor[1] = ((compact->vendor >> 5) & 0x1F) + '@';
+        bb->vendor[2] = (compact->vendor & 0x1F) + '@';
+        if (compact->digital)
+                edid_set_gamma(bb, compact->gamma);
+        bb->clr_depth = compact->base_bpc;
+        bb->srgb_default = EDID_COMPACT_BIT(bits, EDID_CAP_SRGB_DEFAULT);
+        bb->standby = compact->standby;
+        bb->suspend = compact->suspend;
+        bb->active_off = compact->active_off;
+        bb->clr_formats.clr_format_rgb444 = EDID_COMPACT_BIT(bits, EDID_CAP_RGB444);
+        bb->clr_formats.clr_format_ycbcr444 = EDID_COMPACT_BIT(bits, EDID_CAP_YCBCR444);
+        bb->clr_formats.clr_format_ycbcr422 = EDID_COMPACT_BIT(bits, EDID_CAP_YCBCR422);
+        bb->clr_formats.clr_format_ycbcr420 = EDID_COMPACT_BIT(bits, EDID_CAP_YCBCR420);
+
+        etags->audio = EDID_COMPACT_BIT(bits, EDID_CAP_AUDIO);
+        etags->it_underscan = EDID_COMPACT_BIT(bits, EDID_CAP_UNDERSCAN);
+        etags->vcap.quant_range_selectable_rgb = EDID_COMPACT_BIT(bits, EDID_CAP_QS_RGB);
+        etags->vcap.quant_range_selectable_ycc = EDID_COMPACT_BIT(bits, EDID_CAP_QS_YCC);
+        etags->vcap.pt = compact->pt;
+        etags->vcap.it = compact->it;
+        etags->vcap.ce = compact->ce;
+
+        etags->colorimetry.opRGB = EDID_COMPACT_BIT(bits, EDID_CAP_OPRGB);
+        etags->colorimetry.opYCC_601 = EDID_COMPACT_BIT(bits, EDID_CAP_OPYCC_601);
+        etags->colorimetry.sYCC_601 = EDID_COMPACT_BIT(bits, EDID_CAP_SYCC_601);
+        etags->colorimetry.xvYCC_601 = EDID_COMPACT_BIT(bits, EDID_CAP_XVYCC_601);
+        etags->colorimetry.xvYCC_709 = EDID_COMPACT_BIT(bits, EDID_CAP_XVYCC_709);
+        etags->colorimetry.BT2020_RGB = EDID_COMPACT_BIT(bits, EDID_CAP_BT2020_RGB);
+        etags->colorimetry.BT2020_YCC = EDID_COMPACT_BIT(bits, EDID_CAP_BT2020_YCC);
+        etags->colorimetry.BT2020_CYCC = EDID_COMPACT_BIT(bits, EDID_CAP_BT2020_CYCC);
+        etags->colorimetry.DCIP3 = EDID_COMPACT_BIT(bits, EDID_CAP_DCIP3);
+
+        etags->hdr_smd.gamma_sdr = EDID_COMPACT_BIT(bits, EDID_CAP_EOTF_SDR);
+        etags->hdr_smd.gamma_hdr = EDID_COMPACT_BIT(bits, EDID_CAP_EOTF_HDR);
+        etags->hdr_smd.gamma_st2084 = EDID_COMPACT_BIT(bits, EDID_CAP_EOTF_ST2084);
+        etags->hdr_smd.gamma_hlg = EDID_COMPACT_BIT(bits, EDID_CAP_EOTF_HLG);
+        etags->hdr_smd.static_md_type_1 = EDID_COMPACT_BIT(bits, EDID_CAP_HDR_STATIC_MD1);
+        etags->hdr_smd.n_lum_cv = compact->n_lum_cv;
+        memcpy(etags->hdr_smd.lum_cv, compact->lum_cv, sizeof(compact->lum_cv));
+        cea_hdr_smd_lums(&etags->hdr_smd);
+
+        etags->hdmi_vsdb.dc_30_bpc = EDID_COMPACT_BIT(bits, EDID_CAP_DC_30);
+        etags->hdmi_vsdb.dc_36_bpc = EDID_COMPACT_BIT(bits, EDID_CAP_DC_36);
+        etags->hdmi_vsdb.dc_48_bpc = EDID_COMPACT_BIT(bits, EDID_CAP_DC_48);
+        etags->hdmi_vsdb.dc_ycbcr444 = EDID_COMPACT_BIT(bits, EDID_CAP_DC_Y444);
+        etags->hdmi_vsdb.ai = EDID_COMPACT_BIT(bits, EDID_CAP_HDMI_AI);
+        etags->hdmi_vsdb.dvi_dual = EDID_COMPACT_BIT(bits, EDID_CAP_DVI_DUAL);
+        etags->hdmi_vsdb.max_tmds_clock_mhz = compact->hdmi_max_tmds * 5;
+        etags->hdmi_vsdb.phy.a = (compact->phy >> 12) & 0xF;
+        etags->hdmi_vsdb.phy.b = (compact->phy >> 8) & 0xF;
+        etags->hdmi_vsdb.phy.c = (compact->phy >> 4) & 0xF;
+        etags->hdmi_vsdb.phy.d = compact->phy & 0xF;
+
+        etags->hfvsdb.version = compact->hf_version;
+        etags->hfvsdb.max_tmds_rate_mhz = compact->hf_max_tmds * 5;
+        etags->hfvsdb.scdc = EDID_COMPACT_BIT(bits, EDID_CAP_SCDC);
+        etags->hfvsdb.rr = EDID_COMPACT_BIT(bits, EDID_CAP_SCDC_RR);
+        etags->hfvsdb.scrambling_340mhz = EDID_COMPACT_BIT(bits, EDID_CAP_SCRAMBLING_340);
+        etags->hfvsdb.iv = EDID_COMPACT_BIT(bits, EDID_CAP_3D_IV);
+        etags->hfvsdb.dv = EDID_COMPACT_BIT(bits, EDID_CAP_3D_DV);
+        etags->hfvsdb.osd_3d = EDID_COMPACT_BIT(bits, EDID_CAP_3D_OSD);
+        etags->hfvsdb.max_frl_rate = compact->max_frl_rate;
+        etags->hfvsdb.dc_30_420 = EDID_COMPACT_BIT(bits, EDID_CAP_DC420_30);
+        etags->hfvsdb.dc_36_420 = EDID_COMPACT_BIT(bits, EDID_CAP_DC420_36);
+        etags->hfvsdb.dc_48_420 = EDID_COMPACT_BIT(bits, EDID_CAP_DC420_48);
+
+        /* Nothing left to decode, the blocks are gone. The tiling and
+         * dynamic HDR metadata bits have no struct to go to, keep them in
+         * the caps.
+         */
+        edid_build_caps(info);
+        info->caps.bits = bits;
+        info->decoded = EDID_DECODE_ALL;
+        return info;
+}
@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2022 Shashank Sharma (contactshashanksharma@gmail.com)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sub license,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the
+ * next paragraph) shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Fuzz target for the EDID parser.
+ *
+ * Built with -D LIBEDID_LIBFUZZER this is a libFuzzer target ("make fuzz"),
+ * which reports its own execs/sec. Otherwise it has a main(), which either
+ * runs the given files once each (for AFL: afl-fuzz ... -- ./fuzz_edidlib @@),
+ * or feeds synthetic EDIDs from the generator to the target, and reports
+ * execs/sec:
+ *
+ * Usage: fuzz_edidlib [-s seed] [-T seconds] [-m percent_malformed] [file...]
+ */
+
+#include <sys/types.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "libedid.h"
+#include "libedid-api.h"
+#include "edid-gen.h"
+
+/* Largest EDID the extension count can describe */
+#define FUZZ_MAX_EDID_SIZE (256 * 128)
+
+/* Diagnostics of a parsed EDID must point into it */
+static void fuzz_check_diag(const struct edid_diag *diag, void *data)
+{
+        size_t size = *(size_t *)data;
+
+        if (diag->code > EDID_DIAG_MODE_LIMIT || diag->severity > EDID_DIAG_ERROR)
+                abort();
+        if (diag->code > EDID_DIAG_BAD_BUFFER && diag->offset >= size)
+                abort();
+}
+
+int LLVMFuzzerTestOneInput(const u_int8_t *data, size_t size)
+{
+        struct edid_info *info;
+        u_int8_t *raw;
+        void *handle;
+
+        if (!size || size > FUZZ_MAX_EDID_SIZE)
+                return 0;
+
+        libedid_register_diag_handler(fuzz_check_diag, &size);
+
+        /* Exactly as big as the blob, so the sanitizers catch reads past its end */
+        raw = malloc(size);
+        if (!raw)
+                return 0;
+        memcpy(raw, data, size);
+
+        /* Copying parse */
+        info = libedid_process_edid_info_len(raw, size, 0);
+        libedid_destroy_edid_info(info);
+
+        /* Strict parse, rejects what the lenient one parses around */
+        info = libedid_process_edid_info_len(raw, size, EDID_PARSE_STRICT);
+        libedid_destroy_edid_info(info);
+
+        /* Borrowed views into the blob, decoded one group at a time */
+        info = libedid_process_edid_info_len(raw, size, EDID_PARSE_BORROW_RAW | EDID_PARSE_LAZY);
+        if (info) {
+                libedid_decode_groups(info, EDID_DECODE_VIDEO);
+                libedid_decode_groups(info, EDID_DECODE_ALL);
+                libedid_destroy_edid_info(info);
+        }
+
+        /* Handle API, walking all the data blocks */
+        handle = libedid_init_len(raw, size, 0);
+        if (handle) {
+                struct libedid_data_block db;
+                struct libedid_ext_blk ext;
+                const struct libedid_diag *diags;
+                struct libedid_compact compact[2];
+                void *expanded;
+                const struct libedid_indexed_mode *ranked;
+                struct libedid_detailed_mode timing;
+                struct libedid_tile_group groups[2];
+                struct libedid_tile tiles[2];
+                void *tiled[2] = { handle, handle };
+                unsigned int iter = 0;
+
+                while (libedid_next_data_block(handle, &iter, &db))
+                        ;
+                for (iter = 1; libedid_get_ext_blk(handle, iter, &ext); iter++)
+                        ;
+                if (libedid_get_diags(handle, &diags, NULL) > 32)
+                        abort();
+                libedid_display_deepest_420_color_depth(handle);
+                libedid_get_caps(handle);
+                libedid_compact(handle, &compact[0]);
+                expanded = libedid_expand_compact(&compact[0]);
+                if (expanded) {
+                        /* The compact form must survive a round trip */
+                        libedid_compact(expanded, &compact[1]);
+                        if (memcmp(&compact[0], &compact[1], sizeof(compact[0])))
+                                abort();
+                        libedid_destroy(expanded);
+                }
+                libedid_find_nearest_mode(handle, 3840, 2160, 60000);
+                if (libedid_get_ranked_modes(handle, &ranked))
+                        libedid_get_mode_timing(handle, &ranked[0], &timing);
+                libedid_group_tiles(tiled, 2, groups, tiles);
+                libedid_destroy(handle);
+        }
+
+        libedid_register_diag_handler(NULL, NULL);
+        free(raw);
+        return 0;
+}
+
+#ifndef LIBEDID_LIBFUZZER
+static double now_secs(void)
+{
+        struct timespec ts;
+
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int run_file(const char *path)
+{
+        static u_int8_t data[FUZZ_MAX_EDID_SIZE];
+        size_t size;
+        FILE *f = fopen(path, "rb");
+
+        if (!f) {
+                printf("Error: Could not open %s\n", path);
+                return -1;
+        }
+
+        size = fread(data, 1, sizeof(data), f);
+        fclose(f);
+        return LLVMFuzzerTestOneInput(data, size);
+}
+
+int main(int argc, char **argv)
+{
+        u_int8_t buf[EDID_GEN_MAX_SIZE];
+        unsigned long long seed = 1;
+        unsigned long execs = 0;
+        unsigned int malformed = 50;
+        double seconds = 10;
+        double start, last;
+        struct edid_gen gen;
+        int opt;
+
+        while ((opt = getopt(argc, argv, "s:T:m:")) != -1) {
+                switch (opt) {
+                case 's':
+                        seed = strtoull(optarg, NULL, 0);
+                        break;
+                case 'T':
+                        seconds = atof(optarg);
+                        break;
+                case 'm':
+                        malformed = atoi(optarg);
+                        break;
+                default:
+                        printf("Usage: %s [-s seed] [-T seconds] [-m percent_malformed] [file...]\n",
+                                argv[0]);
+                        return -1;
+                }
+        }
+
+        if (optind < argc) {
+                for (; optind < argc; optind++)
+                        run_file(argv[optind]);
+                return 0;
+        }
+
+        edid_gen_seed(&gen, seed);
+        start = last = now_secs();
+        while (1) {
+                /* Which blobs get malformed is decided by the seed as well */
+                u_int32_t flags = (gen.state >> 32) % 100 < malformed ? EDID_GEN_MALFORMED : 0;
+                size_t len = edid_gen_blob(&gen, flags, buf);
+                double now;
+
+                LLVMFuzzerTestOneInput(buf, len);
+                if (++execs % 1024)
+                        continue;
+
+                now = now_secs();
+                if (now - last >= 1 || now - start >= seconds) {
+                        fprintf(stderr, "#%lu execs, %.0f execs/sec\n", execs, execs / (now - start));
+                        last = now;
+                }
+
+                if (now - start >= seconds)
+                        break;
+        }
+
+        return 0;
+}
+#endif
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2022 Shashank Sharma (contactshashanksharma@gmail.com)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sub license,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the
+ * next paragraph) shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Writes synthetic EDIDs into a directory, one blob per file, named after
+ * the seed so that any of them can be generated again.
+ *
+ * Usage: gen_edidlib [-s seed] [-n count] [-m] [-x] out_dir
+ *      -m: generate malformed EDIDs
+ *      -x: generate EDIDs with the max number of extension blocks
+ */
+
+#include <sys/types.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "edid-gen.h"
+
+int main(int argc, char **argv)
+{
+        u_int8_t buf[EDID_GEN_MAX_SIZE];
+        unsigned long long seed = 1;
+        u_int32_t flags = 0;
+        struct timespec start, end;
+        struct edid_gen gen;
+        long count = 16;
+        double secs;
+        long i;
+        int opt;
+
+        while ((opt = getopt(argc, argv, "s:n:mx")) != -1) {
+                switch (opt) {
+                case 's':
+                        seed = strtoull(optarg, NULL, 0);
+                        break;
+                case 'n':
+                        count = atol(optarg);
+                        break;
+                case 'm':
+                        flags |= EDID_GEN_MALFORMED;
+                        break;
+                case 'x':
+                        flags |= EDID_GEN_MAX_BLKS;
+                        break;
+                default:
+                        printf("Usage: %s [-s seed] [-n count] [-m] [-x] out_dir\n", argv[0]);
+                        return -1;
+                }
+        }
+
+        if (optind != argc - 1) {
+                printf("Usage: %s [-s seed] [-n count] [-m] [-x] out_dir\n", argv[0]);
+                return -1;
+        }
+
+        edid_gen_seed(&gen, seed);
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (i = 0; i < count; i++) {
+                size_t len = edid_gen_blob(&gen, flags, buf);
+                char path[512];
+                FILE *f;
+
+                snprintf(path, sizeof(path), "%s/gen-%llu-%ld%s.bin", argv[optind],
+                        seed, i, flags & EDID_GEN_MALFORMED ? "-bad" : "");
+                f = fopen(path, "wb");
+                if (!f) {
+                        printf("Error: Could not create %s\n", path);
+                        return -1;
+                }
+
+                fwrite(buf, 1, len, f);
+                fclose(f);
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        secs = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+        printf("Generated %ld EDIDs in %s/ (%.0f EDIDs/sec)\n", count, argv[optind],
+                secs > 0 ? count / secs : 0);
+        return 0;
+}
@@ -24,235 +24,1038 @@
 #include <sys/types.h>
 #include <stdio.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
 
 #include "libedid-api.h"
 #include "libedid.h"
 
-char *libedid_get_display_vendor(void *edid_info)
+/* Decode the groups an accessor needs, lazy handles do it on first use */
+static inline struct edid_info *
+libedid_decoded(void *edid_info, unsigned int groups)
 {
     struct edid_info *info = edid_info;
 
+    if ((info->decoded & groups) != groups)
+        libedid_decode_groups(info, groups);
+
+    return info;
+}
+
+char *libedid_get_display_vendor(void *edid_info)
+{
+    struct edid_info *info = libedid_decoded(edid_info, EDID_DECODE_BASE);
+
     return (char*)&info->base_blk.vendor;
 }
 
 unsigned int libedid_get_display_productid(void *edid_info)
 {
-    struct edid_info *info = edid_info;
+    struct edid_info *info = libedid_decoded(edid_info, EDID_DECODE_BASE);
 
     return info->base_blk.pid;
 }
 
 unsigned int libedid_get_display_sno(void *edid_info)
 {
-    struct edid_info *info = edid_info;
+    struct edid_info *info = libedid_decoded(edid_info, EDID_DECODE_BASE);
 
     return info->base_blk.sno;
 }
 
 struct libedid_detailed_mode *libedid_get_preferred_mode(void *edid_info)
 {
-    struct edid_info *info = edid_info;
+    struct edid_info *info = libedid_decoded(edid_info, EDID_DECODE_DTD);
+
+    struct edid_displayid *did = &info->displayid;
+
+    /* DisplayID 2.0 EDIDs may keep their timings in the DisplayID blocks only */
+    if (!info->base_blk.dmodes[0].pixel_clock_khz && did->preferred < did->n_modes)
+        return (struct libedid_detailed_mode *)&did->modes[did->preferred];
 
     /* First detailed mode of EDID is supposed to be preferred */
     return (struct libedid_detailed_mode *)&info->base_blk.dmodes[0];
 }
 
-bool libedid_display_supports_ycbcr(void *edid_info)
+unsigned int libedid_get_std_modes(void *edid_info,
+        const struct libedid_detailed_mode **modes)
 {
-    struct edid_info *info = edid_info;
+    struct edid_info *info = libedid_decoded(edid_info, EDID_DECODE_DTD);
+
+    *modes = (const struct libedid_detailed_mode *)info->base_blk.std_modes;
+    return info->base_blk.n_std_modes;
+}
 
-    return info->base_blk.clr_formats.clr_format_ycbcr420 ||
-            info->base_blk.clr_formats.clr_format_ycbcr422 ||
-            info->base_blk.clr_formats.clr_format_ycbcr444;
+unsigned int libedid_get_displayid_modes(void *edid_info,
+        const struct libedid_detailed_mode **modes, int *preferred)
+{
+    struct edid_info *info = libedid_decoded(edid_info, EDID_DECODE_DTD);
+    struct edid_displayid *did = &info->displayid;
 
+    *modes = (const struct libedid_detailed_mode *)did->modes;
+    if (preferred)
+        *preferred = did->preferred < did->n_modes ? did->preferred : -1;
+    return did->n_modes;
 }
 
-bool libedid_display_supports_ycbcr444(void *edid_info)
+void libedid_get_timing_range(void *edid_info, struct libedid_timing_range *range)
 {
-    struct edid_info *info = edid_info;
+    struct edid_info *info = libedid_decoded(edid_info, EDID_DECODE_MISC);
+    const struct edid_timing_range *r = &info->displayid.range;
 
-    return info->base_blk.clr_formats.clr_format_ycbcr444;
+    range->min_pixel_clock_khz = r->min_pixel_clock_khz;
+    range->max_pixel_clock_khz = r->max_pixel_clock_khz;
+    range->min_refresh_hz = r->min_refresh_hz;
+    range->max_refresh_hz = r->max_refresh_hz;
+    range->seamless = r->seamless;
 }
 
-bool libedid_display_supports_ycbcr422(void *edid_info)
+/* VICs with a timing in libedid_vic_timing(): 1-127 and 193-219 */
+static const u_int64_t libedid_known_vics[4] = {
+    ~0ULL, ~0ULL >> 1, 0, (1ULL << 27) - 1,
+};
+
+static void
+libedid_fill_vic_mode(struct libedid_detailed_mode *mode,
+        const struct edid_vic_timing *timing, bool fractional)
 {
-    struct edid_info *info = edid_info;
+    memset(mode, 0, sizeof(*mode));
+    mode->pixel_clock_khz = fractional ? timing->frac_pixel_clock_khz :
+        timing->pixel_clock_khz;
+    mode->hactive = timing->hactive;
+    mode->hblank = timing->hblank;
+    mode->hfrontp = timing->hfrontp;
+    mode->hsync = timing->hsync;
+    mode->vactive = timing->vactive;
+    mode->vblank = timing->vblank;
+    mode->vfrontp = timing->vfrontp;
+    mode->vsync = timing->vsync;
+    mode->interlaced = !!(timing->flags & EDID_VIC_INTERLACED);
+    mode->stereo = EDID_STEREO_MODE_NONE;
+}
+
+int libedid_get_mode_list(void *edid_info, unsigned int lists,
+        struct libedid_detailed_mode *modes, unsigned int max_modes)
+{
+    struct edid_info *info = libedid_decoded(edid_info, EDID_DECODE_VIDEO);
+    struct edid_tags *etags = &info->cea_blks;
+    unsigned int count = 0;
+    u_int64_t vics[4];
+    int word;
+
+    for (word = 0; word < 4; word++) {
+        vics[word] = 0;
+        if (lists & LIBEDID_MODES_VDB)
+            vics[word] |= etags->vics[word];
+        if (lists & LIBEDID_MODES_420_ONLY)
+            vics[word] |= etags->vics_420_only[word];
+        if (lists & LIBEDID_MODES_420_ALSO)
+            vics[word] |= etags->vics_420_also[word];
+        vics[word] &= libedid_known_vics[word];
+    }
+
+    /* Without the fractional variants, every set bit is exactly one mode */
+    if (!modes && !(lists & LIBEDID_MODES_FRACTIONAL)) {
+        for (word = 0; word < 4; word++)
+            count += __builtin_popcountll(vics[word]);
+        return count;
+    }
+
+    for (word = 0; word < 4; word++) {
+        u_int64_t bits = vics[word];
+
+        while (bits) {
+            u_int8_t vic = word * 64 + __builtin_ctzll(bits) + 1;
+            const struct edid_vic_timing *timing = libedid_vic_timing(vic);
+
+            bits &= bits - 1;
+            if (!timing)
+                continue;
 
-    return info->base_blk.clr_formats.clr_format_ycbcr422;
+            if (modes && count < max_modes)
+                libedid_fill_vic_mode(&modes[count], timing, false);
+            count++;
+
+            if (!(lists & LIBEDID_MODES_FRACTIONAL) ||
+                    !(timing->flags & EDID_VIC_FRACTIONAL))
+                continue;
+
+            if (modes && count < max_modes)
+                libedid_fill_vic_mode(&modes[count], timing, true);
+            count++;
+        }
+    }
+
+    return count;
 }
 
-bool libedid_display_supports_ycbcr420(void *edid_info)
+/* Sort key of the mode index: hactive, vactive, then refresh */
+static inline u_int64_t
+libedid_mode_key(unsigned int hactive, unsigned int vactive, unsigned int refresh_mhz)
+{
+    return (u_int64_t)hactive << 48 | (u_int64_t)vactive << 32 | refresh_mhz;
+}
+
+/* First indexed mode whose key is not below key */
+static unsigned int
+libedid_mode_lower_bound(const struct edid_mode_index *idx, u_int64_t key)
+{
+    unsigned int lo = 0, hi = idx->n_modes;
+
+    while (lo < hi) {
+        unsigned int mid = (lo + hi) / 2;
+        const struct edid_mode_entry *m = &idx->modes[mid];
+
+        if (libedid_mode_key(m->hactive, m->vactive, m->refresh_mhz) < key)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return lo;
+}
+
+unsigned int libedid_get_n_modes(void *edid_info)
+{
+    struct edid_info *info = libedid_decoded(edid_info, EDID_DECODE_MODES);
+
+    return info->mode_index.n_modes;
+}
+
+const struct libedid_indexed_mode *libedid_get_indexed_mode(void *edid_info, unsigned int mode)
+{
+    struct edid_info *info = libedid_decoded(edid_info, EDID_DECODE_MODES);
+
+    if (mode >= info->mode_index.n_modes)
+        return NULL;
+
+    return (const struct libedid_indexed_mode *)&info->mode_index.modes[mode];
+}
+
+unsigned int libedid_get_ranked_modes(void *edid_info,
+        const struct libedid_indexed_mode **modes)
+{
+    struct edid_info *info = libedid_decoded(edid_info, EDID_DECODE_MODES);
+
+    *modes = (const struct libedid_indexed_mode *)info->mode_index.ranked;
+    return info->mode_index.n_modes;
+}
+
+int libedid_get_indexed_mode_timing(void *edid_info, unsigned int mode,
+        struct libedid_detailed_mode *timing)
+{
+    struct edid_info *info = libedid_decoded(edid_info, EDID_DECODE_MODES);
+
+    if (mode >= info->mode_index.n_modes)
+        return -1;
+
+    libedid_get_mode_timing(info,
+        (const struct libedid_indexed_mode *)&info->mode_index.modes[mode], timing);
+    return 0;
+}
+
+void libedid_get_mode_timing(void *edid_info, const struct libedid_indexed_mode *mode,
+        struct libedid_detailed_mode *timing)
 {
     struct edid_info *info = edid_info;
+    const struct edid_mode_entry *m = (const struct edid_mode_entry *)mode;
+
+    if (m->vic)
+        libedid_fill_vic_mode(timing, libedid_vic_timing(m->vic),
+            m->flags & EDID_MODE_FRACTIONAL);
+    else if (m->flags & EDID_MODE_BASE_DTD)
+        memcpy(timing, &info->base_blk.dmodes[m->dtd], sizeof(*timing));
+    else if (m->flags & EDID_MODE_STD)
+        memcpy(timing, &info->base_blk.std_modes[m->dtd], sizeof(*timing));
+    else if (m->flags & EDID_MODE_DISPLAYID)
+        memcpy(timing, &info->displayid.modes[m->dtd], sizeof(*timing));
+    else
+        memcpy(timing, &info->cea_blks.dtd.d_modes[m->dtd], sizeof(*timing));
+}
 
-    return info->base_blk.clr_formats.clr_format_ycbcr420;
+int libedid_generate_timing(const struct libedid_timing_req *req,
+        struct libedid_detailed_mode *mode)
+{
+    struct edid_timing_req ereq = {
+        .formula = req->formula,
+        .flags = req->flags,
+        .rb3_hblank_extra = req->rb3_hblank_extra,
+        .hactive = req->hactive,
+        .vactive = req->vactive,
+        .refresh_mhz = req->refresh_mhz,
+        .gtf = {
+            .start_khz = req->gtf.start_khz,
+            .m = req->gtf.m,
+            .c_x2 = req->gtf.c_x2,
+            .k = req->gtf.k,
+            .j_x2 = req->gtf.j_x2,
+        },
+    };
+
+    return libedid_timing_mode(&ereq, (struct detailed_mode *)mode);
+}
+
+int libedid_find_mode(void *edid_info, unsigned int hactive, unsigned int vactive,
+        unsigned int refresh_mhz)
+{
+    struct edid_info *info = libedid_decoded(edid_info, EDID_DECODE_MODES);
+    struct edid_mode_index *idx = &info->mode_index;
+    unsigned int i;
+
+    i = libedid_mode_lower_bound(idx, libedid_mode_key(hactive, vactive, refresh_mhz));
+    if (i < idx->n_modes && idx->modes[i].hactive == hactive &&
+            idx->modes[i].vactive == vactive && idx->modes[i].refresh_mhz == refresh_mhz)
+        return i;
+
+    return -1;
+}
+
+unsigned int libedid_find_modes(void *edid_info, unsigned int hactive, unsigned int vactive,
+        unsigned int min_refresh_mhz, unsigned int max_refresh_mhz, unsigned int *first)
+{
+    struct edid_info *info = libedid_decoded(edid_info, EDID_DECODE_MODES);
+    struct edid_mode_index *idx = &info->mode_index;
+    unsigned int start, end;
+
+    if (min_refresh_mhz > max_refresh_mhz)
+        return 0;
+
+    /* One past max_refresh_mhz carries over into the next vactive */
+    start = libedid_mode_lower_bound(idx,
+        libedid_mode_key(hactive, vactive, min_refresh_mhz));
+    end = libedid_mode_lower_bound(idx,
+        libedid_mode_key(hactive, vactive, max_refresh_mhz) + 1);
+
+    if (first)
+        *first = start;
+    return end - start;
+}
+
+static unsigned int libedid_diff(unsigned int a, unsigned int b)
+{
+    return a > b ? a - b : b - a;
+}
+
+int libedid_find_nearest_mode(void *edid_info, unsigned int hactive, unsigned int vactive,
+        unsigned int refresh_mhz)
+{
+    struct edid_info *info = libedid_decoded(edid_info, EDID_DECODE_MODES);
+    struct edid_mode_index *idx = &info->mode_index;
+    u_int64_t area = (u_int64_t)hactive * vactive;
+    u_int64_t best_area = ~0ULL;
+    unsigned int best_refresh = ~0U;
+    unsigned int first, n, i;
+    int best = -1;
+
+    /* At this resolution, the closest refresh is next to the lower bound */
+    n = libedid_find_modes(info, hactive, vactive, 0, ~0U, &first);
+    if (n) {
+        i = libedid_mode_lower_bound(idx,
+            libedid_mode_key(hactive, vactive, refresh_mhz));
+        if (i == first + n)
+            return i - 1;
+        if (i > first && libedid_diff(idx->modes[i - 1].refresh_mhz, refresh_mhz) <=
+                libedid_diff(idx->modes[i].refresh_mhz, refresh_mhz))
+            return i - 1;
+        return i;
+    }
+
+    /* Otherwise the closest number of pixels, then the closest refresh */
+    for (i = 0; i < idx->n_modes; i++) {
+        const struct edid_mode_entry *m = &idx->modes[i];
+        u_int64_t m_area = (u_int64_t)m->hactive * m->vactive;
+        u_int64_t d_area = m_area > area ? m_area - area : area - m_area;
+        unsigned int d_refresh = libedid_diff(m->refresh_mhz, refresh_mhz);
+
+        if (d_area < best_area || (d_area == best_area && d_refresh < best_refresh)) {
+            best_area = d_area;
+            best_refresh = d_refresh;
+            best = i;
+        }
+    }
+
+    return best;
+}
+
+const struct libedid_vic_caps *libedid_get_vic_caps(void *edid_info, unsigned char vic)
+{
+    struct edid_info *info = libedid_decoded(edid_info, EDID_DECODE_VIDEO);
+
+    return (const struct libedid_vic_caps *)&info->cea_blks.vic_caps[vic];
+}
+
+/* struct libedid_caps mirrors struct edid_caps */
+_Static_assert(sizeof(struct libedid_caps) == sizeof(struct edid_caps) &&
+        LIBEDID_CAP_3D_DV == EDID_CAP_3D_DV, "struct libedid_caps out of sync");
+
+const struct libedid_caps *libedid_get_caps(void *edid_info)
+{
+    struct edid_info *info = libedid_decoded(edid_info, EDID_DECODE_CAPS);
+
+    return (const struct libedid_caps *)&info->caps;
+}
+
+_Static_assert(sizeof(struct libedid_compact) == sizeof(struct edid_compact),
+        "struct libedid_compact out of sync");
+
+void libedid_compact(void *edid_info, struct libedid_compact *compact)
+{
+    libedid_compact_edid_info(edid_info, (struct edid_compact *)compact);
+}
+
+void *libedid_expand_compact(const struct libedid_compact *compact)
+{
+    return libedid_expand_compact_info((const struct edid_compact *)compact);
+}
+
+void libedid_get_chromaticity(void *edid_info, struct libedid_chromaticity *chroma)
+{
+    struct edid_info *info = libedid_decoded(edid_info, EDID_DECODE_BASE);
+
+    memcpy(chroma, &info->base_blk.chroma, sizeof(*chroma));
+}
+
+/* struct libedid_diag mirrors struct edid_diag */
+_Static_assert(sizeof(struct libedid_diag) == sizeof(struct edid_diag) &&
+        (int)LIBEDID_DIAG_MODE_LIMIT == (int)EDID_DIAG_MODE_LIMIT &&
+        (int)LIBEDID_DIAG_ERROR == (int)EDID_DIAG_ERROR, "struct libedid_diag out of sync");
+
+unsigned int libedid_get_diags(void *edid_info, const struct libedid_diag **diags,
+        unsigned int *n_dropped)
+{
+    struct edid_info *info = libedid_decoded(edid_info, EDID_DECODE_ALL);
+
+    *diags = (const struct libedid_diag *)info->diags.diag;
+    if (n_dropped)
+        *n_dropped = info->diags.n_dropped;
+
+    return info->diags.n_diags;
+}
+
+/* The callback and its data travel together, as the handler data */
+struct libedid_diag_sink {
+    libedid_diag_callback cb;
+    void *data;
+};
+
+static struct libedid_diag_sink libedid_diag_sink;
+
+static void
+libedid_diag_trampoline(const struct edid_diag *diag, void *data)
+{
+    const struct libedid_diag_sink *sink = data;
+
+    sink->cb((const struct libedid_diag *)diag, sink->data);
+}
+
+void libedid_set_diag_callback(libedid_diag_callback cb, void *data)
+{
+    libedid_diag_sink.cb = cb;
+    libedid_diag_sink.data = data;
+    libedid_register_diag_handler(cb ? libedid_diag_trampoline : NULL, &libedid_diag_sink);
+}
+
+/* Any of the EDID_CAP_* bits in mask, which all come from groups. The caps
+ * bits of a group are set as soon as it is decoded, so lazy handles only
+ * decode that one.
+ */
+static bool
+libedid_caps_any(void *edid_info, u_int64_t mask, unsigned int groups)
+{
+    struct edid_info *info = libedid_decoded(edid_info, groups);
+
+    return info->caps.bits & mask;
+}
+
+bool libedid_display_supports_ycbcr(void *edid_info)
+{
+    return libedid_caps_any(edid_info, EDID_CAP_YCBCR, EDID_DECODE_BASE);
+}
+
+bool libedid_display_supports_ycbcr444(void *edid_info)
+{
+    return libedid_caps_any(edid_info, EDID_CAP_YCBCR444, EDID_DECODE_BASE);
+}
+
+bool libedid_display_supports_ycbcr422(void *edid_info)
+{
+    return libedid_caps_any(edid_info, EDID_CAP_YCBCR422, EDID_DECODE_BASE);
+}
+
+bool libedid_display_supports_ycbcr420(void *edid_info)
+{
+    return libedid_caps_any(edid_info, EDID_CAP_YCBCR420, EDID_DECODE_BASE);
 }
 
 bool libedid_display_supports_dcip3(void *edid_info)
 {
-    struct edid_info *info = edid_info;
-    
-    return info->cea_blks.colorimetry.DCIP3;
+    return libedid_caps_any(edid_info, EDID_CAP_DCIP3, EDID_DECODE_COLORIMETRY);
 }
 
 bool libedid_display_supports_bt2020(void *edid_info)
 {
-    struct edid_info *info = edid_info;
-    
-    return info->cea_blks.colorimetry.BT2020_RGB ||
-            info->cea_blks.colorimetry.BT2020_YCC ||
-            info->cea_blks.colorimetry.BT2020_CYCC;
+    return libedid_caps_any(edid_info, EDID_CAP_BT2020,
+            EDID_DECODE_COLORIMETRY);
 }
 
 bool libedid_display_supports_dc(void *edid_info)
 {
-    struct edid_info *info = edid_info;
-
-    return info->cea_blks.hdmi_vsdb.dc_30_bpc ||
-            info->cea_blks.hdmi_vsdb.dc_36_bpc ||
-            info->cea_blks.hdmi_vsdb.dc_48_bpc;
+    return libedid_caps_any(edid_info, EDID_CAP_DC, EDID_DECODE_VSDB);
 }
 
 bool libedid_display_supports_dc_10bpc(void *edid_info)
 {
-    struct edid_info *info = edid_info;
-
-    return info->cea_blks.hdmi_vsdb.dc_30_bpc;
+    return libedid_caps_any(edid_info, EDID_CAP_DC_30, EDID_DECODE_VSDB);
 }
 
 bool libedid_display_supports_dc_12bpc(void *edid_info)
 {
-    struct edid_info *info = edid_info;
-
-    return info->cea_blks.hdmi_vsdb.dc_36_bpc;
+    return libedid_caps_any(edid_info, EDID_CAP_DC_36, EDID_DECODE_VSDB);
 }
 
 bool libedid_display_supports_dc_16bpc(void *edid_info)
 {
-    struct edid_info *info = edid_info;
-
-    return info->cea_blks.hdmi_vsdb.dc_48_bpc;
+    return libedid_caps_any(edid_info, EDID_CAP_DC_48, EDID_DECODE_VSDB);
 }
 
 bool libedid_display_supports_dc420(void *edid_info)
 {
-    struct edid_info *info = edid_info;
-
-    return info->cea_blks.hfvsdb.dc_30_420 ||
-            info->cea_blks.hfvsdb.dc_36_420 ||
-            info->cea_blks.hfvsdb.dc_48_420;
+    return libedid_caps_any(edid_info, EDID_CAP_DC420, EDID_DECODE_VSDB);
 }
 
 unsigned char libedid_display_deepest_420_color_depth(void *edid_info)
 {
-    struct edid_info *info = edid_info;
+    struct edid_info *info = libedid_decoded(edid_info, EDID_DECODE_VSDB);
 
-    if (info->cea_blks.hfvsdb.dc_48_420)
-        return 16;
-    if (info->cea_blks.hfvsdb.dc_36_420)
-        return 12;
-    if (info->cea_blks.hfvsdb.dc_30_420)
-        return 10;
     /* 0 indicates no deep color support in hf_vsdb */
-    return 0;
+    return info->caps.max_420_bpc;
 }
 
 bool libedid_display_supports_dc420_10bpc(void *edid_info)
 {
-    struct edid_info *info = edid_info;
-
-    return info->cea_blks.hfvsdb.dc_30_420;
+    return libedid_caps_any(edid_info, EDID_CAP_DC420_30, EDID_DECODE_VSDB);
 }
 
 bool libedid_display_supports_dc420_12bpc(void *edid_info)
 {
-    struct edid_info *info = edid_info;
-
-    return info->cea_blks.hfvsdb.dc_36_420;
+    return libedid_caps_any(edid_info, EDID_CAP_DC420_36, EDID_DECODE_VSDB);
 }
 
 bool libedid_display_supports_dc420_16bpc(void *edid_info)
 {
-    struct edid_info *info = edid_info;
-
-    return info->cea_blks.hfvsdb.dc_48_420;
+    return libedid_caps_any(edid_info, EDID_CAP_DC420_48, EDID_DECODE_VSDB);
 }
 
 unsigned int libedid_display_max_tmds_clk_mhz(void *edid_info)
 {
-    struct edid_info *info = edid_info;
+    struct edid_info *info = libedid_decoded(edid_info, EDID_DECODE_VSDB);
 
     /* HF-VSDB value gets the priority */
-    if (info->cea_blks.hfvsdb.max_tmds_rate_mhz)
-        return info->cea_blks.hfvsdb.max_tmds_rate_mhz;
-
-    return info->cea_blks.hdmi_vsdb.max_tmds_clock_mhz;
+    return info->caps.max_tmds_clk_mhz;
 }
 
 bool libedid_display_supports_audio(void *edid_info)
 {
-    struct edid_info *info = edid_info;
-
-    return info->cea_blks.audio;
+    return libedid_caps_any(edid_info, EDID_CAP_AUDIO, EDID_DECODE_CEA_HDR);
 }
 
 double libedid_display_hdr_max_lum(void *edid_info)
 {
-    struct edid_info *info = edid_info;
+    struct edid_info *info = libedid_decoded(edid_info, EDID_DECODE_HDR);
 
-    return info->cea_blks.hdr_smd.content_max_lum;
+    return info->cea_blks.hdr_smd.content_max_lum_fx / 4294967296.0;
 }
 
 double libedid_display_hdr_min_lum(void *edid_info)
 {
-    struct edid_info *info = edid_info;
+    struct edid_info *info = libedid_decoded(edid_info, EDID_DECODE_HDR);
 
-    return info->cea_blks.hdr_smd.content_min_lum;
+    return info->cea_blks.hdr_smd.content_min_lum_fx / 4294967296.0;
 }
 
 bool libedid_display_supports_hdr_output(void *edid_info)
 {
-    struct edid_info *info = edid_info;
-
-    return info->cea_blks.hdr_smd.gamma_hdr ||
-        info->cea_blks.hdr_smd.gamma_hlg ||
-        info->cea_blks.hdr_smd.gamma_st2084;
+    return libedid_caps_any(edid_info, EDID_CAP_HDR, EDID_DECODE_HDR);
 }
 
 bool libedid_display_supports_hdr_gamma(void *edid_info)
 {
-    struct edid_info *info = edid_info;
-
-    return info->cea_blks.hdr_smd.gamma_hdr;
+    return libedid_caps_any(edid_info, EDID_CAP_EOTF_HDR, EDID_DECODE_HDR);
 }
 
 bool libedid_display_supports_hdr_st2084(void *edid_info)
+{
+    return libedid_caps_any(edid_info, EDID_CAP_EOTF_ST2084, EDID_DECODE_HDR);
+}
+
+bool libedid_display_supports_hdr_hlg(void *edid_info)
+{
+    return libedid_caps_any(edid_info, EDID_CAP_EOTF_HLG, EDID_DECODE_HDR);
+}
+
+static void
+libedid_fill_data_block(struct edid_info *info, const struct edid_db_entry *entry,
+                struct libedid_data_block *db)
+{
+    /* Skip the tag byte, and the extended tag byte if there is one */
+    unsigned char hdr = (entry->tag == CEA_DATA_BLOCK_EXTENDED && entry->len) ? 2 : 1;
+
+    db->ext_blk = entry->ext_blk;
+    db->tag = entry->tag;
+    db->ext_tag = entry->ext_tag;
+    db->len = entry->len + 1 - hdr;
+    db->data = &info->raw_edid[entry->offset + hdr];
+}
+
+bool libedid_next_data_block(void *edid_info, unsigned int *iter,
+                struct libedid_data_block *db)
 {
     struct edid_info *info = edid_info;
 
-    return info->cea_blks.hdr_smd.gamma_st2084;
+    if (!info || !iter || *iter >= info->db_index.n_entries)
+        return false;
+
+    libedid_fill_data_block(info, &info->db_index.entries[(*iter)++], db);
+    return true;
 }
 
-bool libedid_display_supports_hdr_hlg(void *edid_info)
+bool libedid_find_data_block(void *edid_info, unsigned char tag, unsigned char ext_tag,
+                unsigned int *iter, struct libedid_data_block *db)
 {
     struct edid_info *info = edid_info;
+    const struct edid_db_entry *entry;
 
-    return info->cea_blks.hdr_smd.gamma_hlg;
+    if (!info || !iter)
+        return false;
+
+    /* *iter is the last returned entry + 1, 0 to start */
+    if (!*iter)
+        entry = libedid_find_db(info, tag, ext_tag);
+    else
+        entry = libedid_next_db(info, &info->db_index.entries[*iter - 1]);
+
+    if (!entry)
+        return false;
+
+    *iter = entry - info->db_index.entries + 1;
+    libedid_fill_data_block(info, entry, db);
+    return true;
 }
 
-void *libedid_init(unsigned char *raw_edid)
+bool libedid_get_ext_blk(void *edid_info, unsigned int blk, struct libedid_ext_blk *ext)
+{
+    struct edid_info *info = libedid_decoded(edid_info, EDID_DECODE_DTD | EDID_DECODE_CEA_HDR);
+    const struct edid_ext_blk *rec;
+
+    if (!blk || blk > info->cea_blks.n_cea_ext_blks)
+        return false;
+
+    rec = &info->ext_blks[blk - 1];
+    ext->tag = rec->tag;
+    ext->revision = rec->revision;
+    ext->underscan = rec->flags & EDID_EXT_BLK_UNDERSCAN;
+    ext->audio = rec->flags & EDID_EXT_BLK_AUDIO;
+    ext->ycbcr444 = rec->flags & EDID_EXT_BLK_YCBCR444;
+    ext->ycbcr422 = rec->flags & EDID_EXT_BLK_YCBCR422;
+    ext->n_native_dtds = rec->n_native_dtds;
+    ext->n_dtds = rec->n_dtds;
+    ext->dtds = rec->n_dtds ? (const struct libedid_detailed_mode *)
+        &info->cea_blks.dtd.d_modes[rec->first_dtd] : NULL;
+    ext->first_db = rec->first_db;
+    ext->n_db = rec->n_db;
+    return true;
+}
+
+/*
+ * Process wide parse cache: identical EDIDs share one parsed edid_info.
+ * Entries are keyed by a hash of the raw EDID, and a hash hit is always
+ * confirmed with a full compare. Cached instances own a copy of the raw
+ * EDID, are fully decoded and never modified, so they can be shared by
+ * any number of handles and threads. Unused entries stay around in LRU
+ * order until the size cap needs their slot.
+ */
+struct edid_cache_entry {
+    u_int64_t hash;
+    size_t len;
+    unsigned int refcnt;
+    struct edid_info *info;
+
+    /* Hash bucket chain */
+    struct edid_cache_entry *hnext;
+
+    /* Idle (refcnt 0) list, least recently used first */
+    struct edid_cache_entry *prev;
+    struct edid_cache_entry *next;
+};
+
+static struct {
+    pthread_mutex_t lock;
+    bool enabled;
+    unsigned int max_entries;
+    unsigned int n_entries;
+    unsigned int n_buckets;
+    struct edid_cache_entry **buckets;
+    struct edid_cache_entry *idle_head;
+    struct edid_cache_entry *idle_tail;
+    struct libedid_cache_stats stats;
+} edid_cache = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+static u_int64_t libedid_cache_hash(const unsigned char *data, size_t len)
+{
+    u_int64_t h = 0x9E3779B97F4A7C15ULL ^ len;
+    size_t i;
+
+    /* EDIDs come in 128 byte blocks, so 8 bytes at a time is all it takes */
+    for (i = 0; i + 8 <= len; i += 8) {
+        u_int64_t k;
+
+        memcpy(&k, &data[i], 8);
+        h ^= k;
+        h *= 0xFF51AFD7ED558CCDULL;
+        h ^= h >> 32;
+    }
+
+    for (; i < len; i++)
+        h = (h ^ data[i]) * 0x100000001B3ULL;
+
+    return h ^ (h >> 29);
+}
+
+static void libedid_cache_idle_remove(struct edid_cache_entry *e)
+{
+    if (e->prev)
+        e->prev->next = e->next;
+    else
+        edid_cache.idle_head = e->next;
+
+    if (e->next)
+        e->next->prev = e->prev;
+    else
+        edid_cache.idle_tail = e->prev;
+
+    e->prev = e->next = NULL;
+}
+
+static void libedid_cache_idle_add(struct edid_cache_entry *e)
+{
+    e->next = NULL;
+    e->prev = edid_cache.idle_tail;
+    if (edid_cache.idle_tail)
+        edid_cache.idle_tail->next = e;
+    else
+        edid_cache.idle_head = e;
+    edid_cache.idle_tail = e;
+}
+
+static struct edid_cache_entry **libedid_cache_slot(struct edid_cache_entry *e)
+{
+    struct edid_cache_entry **slot;
+
+    slot = &edid_cache.buckets[e->hash & (edid_cache.n_buckets - 1)];
+    while (*slot != e)
+        slot = &(*slot)->hnext;
+
+    return slot;
+}
+
+/* Unlink and free an entry, the caller has made sure it's unused */
+static void libedid_cache_free_entry(struct edid_cache_entry *e)
+{
+    struct edid_cache_entry **slot = libedid_cache_slot(e);
+
+    *slot = e->hnext;
+    libedid_cache_idle_remove(e);
+    libedid_destroy_edid_info(e->info);
+    free(e);
+    edid_cache.n_entries--;
+}
+
+static void libedid_cache_evict(unsigned int keep)
+{
+    while (edid_cache.n_entries > keep && edid_cache.idle_head) {
+        libedid_cache_free_entry(edid_cache.idle_head);
+        edid_cache.stats.evictions++;
+    }
+}
+
+static int libedid_cache_resize(unsigned int n_buckets)
+{
+    struct edid_cache_entry **buckets;
+    unsigned int i;
+
+    buckets = calloc(n_buckets, sizeof(*buckets));
+    if (!buckets)
+        return -1;
+
+    /* Rehash the entries which are still around */
+    for (i = 0; i < edid_cache.n_buckets; i++) {
+        struct edid_cache_entry *e = edid_cache.buckets[i];
+
+        while (e) {
+            struct edid_cache_entry *next = e->hnext;
+
+            e->hnext = buckets[e->hash & (n_buckets - 1)];
+            buckets[e->hash & (n_buckets - 1)] = e;
+            e = next;
+        }
+    }
+
+    free(edid_cache.buckets);
+    edid_cache.buckets = buckets;
+    edid_cache.n_buckets = n_buckets;
+    return 0;
+}
+
+int libedid_cache_enable(unsigned int max_entries)
+{
+    unsigned int n_buckets = 16;
+    int ret = 0;
+
+    if (!max_entries)
+        return -1;
+
+    /* Keep the load factor at or below 0.5 */
+    while (n_buckets < max_entries * 2)
+        n_buckets <<= 1;
+
+    pthread_mutex_lock(&edid_cache.lock);
+    if (n_buckets != edid_cache.n_buckets)
+        ret = libedid_cache_resize(n_buckets);
+
+    if (!ret) {
+        edid_cache.max_entries = max_entries;
+        edid_cache.stats.max_entries = max_entries;
+        __atomic_store_n(&edid_cache.enabled, true, __ATOMIC_RELAXED);
+        libedid_cache_evict(max_entries);
+    }
+    pthread_mutex_unlock(&edid_cache.lock);
+    return ret;
+}
+
+void libedid_cache_disable(void)
+{
+    pthread_mutex_lock(&edid_cache.lock);
+    __atomic_store_n(&edid_cache.enabled, false, __ATOMIC_RELAXED);
+    /* Entries still in use go away with their last libedid_destroy() */
+    libedid_cache_evict(0);
+    pthread_mutex_unlock(&edid_cache.lock);
+}
+
+void libedid_cache_get_stats(struct libedid_cache_stats *stats)
+{
+    pthread_mutex_lock(&edid_cache.lock);
+    *stats = edid_cache.stats;
+    stats->entries = edid_cache.n_entries;
+    pthread_mutex_unlock(&edid_cache.lock);
+}
+
+static struct edid_info *libedid_cache_parse(unsigned char *raw_edid, size_t len,
+                                             u_int32_t parse_flags)
+{
+    struct edid_info *info;
+    unsigned char *raw;
+
+    raw = malloc(len);
+    if (!raw)
+        return NULL;
+
+    /* The cached instance owns its copy, and is decoded once for all */
+    memcpy(raw, raw_edid, len);
+    info = libedid_process_edid_info_len(raw, len,
+                                         EDID_PARSE_OWN_RAW | (parse_flags &
+                                         (EDID_PARSE_VALIDATED | EDID_PARSE_BASE_COUNT)));
+    if (!info) {
+        free(raw);
+        return NULL;
+    }
+
+    /* Never lazy: readers share it without locking */
+    info->flags |= EDID_PARSE_SHARED;
+
+    return info;
+}
+
+/* Take a reference on the entry for this EDID, with the lock held */
+static struct edid_cache_entry *libedid_cache_lookup(const unsigned char *raw_edid,
+                                                     size_t len, u_int64_t hash)
+{
+    struct edid_cache_entry *e;
+
+    for (e = edid_cache.buckets[hash & (edid_cache.n_buckets - 1)]; e; e = e->hnext) {
+        if (e->hash != hash || e->len != len ||
+                memcmp(e->info->raw_edid, raw_edid, len))
+            continue;
+
+        if (!e->refcnt++)
+            libedid_cache_idle_remove(e);
+        return e;
+    }
+
+    return NULL;
+}
+
+/*
+ * Returns a shared edid_info for this EDID, or NULL when the cache is not
+ * enabled or full, or when parsing failed: the caller then parses a private
+ * instance, which reports why. Misses parse without the lock, so two threads
+ * missing on the same EDID may both parse it: the second one to get the lock
+ * back drops its instance, and takes the first one's. len is the size of the
+ * blocks the parse covers, so EDIDs parsed with and without their HF-EEODB
+ * blocks don't share an entry.
+ */
+static struct edid_info *libedid_cache_get(unsigned char *raw_edid, size_t len,
+                                           u_int32_t parse_flags)
+{
+    struct edid_cache_entry *e, *new;
+    struct edid_info *info;
+    u_int64_t hash;
+    bool full;
+
+    if (!__atomic_load_n(&edid_cache.enabled, __ATOMIC_RELAXED))
+        return NULL;
+
+    hash = libedid_cache_hash(raw_edid, len);
+
+    pthread_mutex_lock(&edid_cache.lock);
+    if (!edid_cache.enabled) {
+        pthread_mutex_unlock(&edid_cache.lock);
+        return NULL;
+    }
+
+    e = libedid_cache_lookup(raw_edid, len, hash);
+    if (e)
+        edid_cache.stats.hits++;
+    else
+        edid_cache.stats.misses++;
+    full = !e && edid_cache.n_entries >= edid_cache.max_entries && !edid_cache.idle_head;
+    pthread_mutex_unlock(&edid_cache.lock);
+
+    if (e)
+        return e->info;
+
+    /* Every entry is in use, hand out a private instance */
+    if (full)
+        return NULL;
+
+    new = calloc(1, sizeof(*new));
+    info = new ? libedid_cache_parse(raw_edid, len, parse_flags) : NULL;
+    if (!info) {
+        free(new);
+        return NULL;
+    }
+
+    new->hash = hash;
+    new->len = len;
+    new->refcnt = 1;
+    new->info = info;
+    info->cache_entry = new;
+
+    pthread_mutex_lock(&edid_cache.lock);
+    /* Cached by another miss meanwhile */
+    e = edid_cache.enabled ? libedid_cache_lookup(raw_edid, len, hash) : NULL;
+    if (!e && edid_cache.enabled) {
+        libedid_cache_evict(edid_cache.max_entries - 1);
+        if (edid_cache.n_entries < edid_cache.max_entries) {
+            new->hnext = edid_cache.buckets[hash & (edid_cache.n_buckets - 1)];
+            edid_cache.buckets[hash & (edid_cache.n_buckets - 1)] = new;
+            edid_cache.n_entries++;
+            pthread_mutex_unlock(&edid_cache.lock);
+            return info;
+        }
+    }
+    pthread_mutex_unlock(&edid_cache.lock);
+
+    libedid_destroy_edid_info(info);
+    free(new);
+    if (e)
+        return e->info;
+
+    /* Disabled, or every entry is in use: hand out a private instance */
+    return NULL;
+}
+
+/* Drop a reference if this is a cached instance, false if it is not */
+static bool libedid_cache_put(struct edid_info *info)
+{
+    struct edid_cache_entry *e = info->cache_entry;
+
+    if (!(info->flags & EDID_PARSE_SHARED))
+        return false;
+
+    pthread_mutex_lock(&edid_cache.lock);
+    if (!--e->refcnt) {
+        if (edid_cache.enabled)
+            libedid_cache_idle_add(e);
+        else
+            libedid_cache_free_entry(e);
+    }
+    pthread_mutex_unlock(&edid_cache.lock);
+    return true;
+}
+
+/* parse_flags is EDID_PARSE_BASE_COUNT when there is no length, len then
+ * covers the blocks the base block counts
+ */
+static void *libedid_init_parse(unsigned char *raw_edid, size_t len, unsigned int flags,
+                                u_int32_t parse_flags)
 {
     struct edid_info *info;
 
+    if (flags & LIBEDID_INIT_VALIDATED)
+        parse_flags |= EDID_PARSE_VALIDATED;
+
+    /* Cached instances may come from lenient parses, so check here */
+    if ((flags & LIBEDID_INIT_STRICT) && !(flags & LIBEDID_INIT_VALIDATED)) {
+        if (libedid_validate_edid_flags(raw_edid, len, parse_flags))
+            return NULL;
+        parse_flags |= EDID_PARSE_VALIDATED;
+    }
+
+    /* Shared instances are always decoded up front, lazy or not */
+    info = libedid_cache_get(raw_edid, len, parse_flags);
+    if (info)
+        return info;
+
+    if (flags & LIBEDID_INIT_LAZY)
+        parse_flags |= EDID_PARSE_LAZY;
+
+    info = libedid_process_edid_info_len(raw_edid, len, parse_flags);
+    return info;
+}
+
+void *libedid_init_len(unsigned char *raw_edid, size_t len, unsigned int flags)
+{
+    /* The cache hashes the whole EDID, so the blob must be all there. The
+     * size can depend on the first extension block (HF-EEODB), so check
+     * that one is there before asking for it.
+     */
+    if (!raw_edid || len < 128 || len < (raw_edid[126] + 1) * 128u ||
+            len < libedid_edid_size(raw_edid))
+        return NULL;
+
+    return libedid_init_parse(raw_edid, libedid_edid_size(raw_edid), flags, 0);
+}
+
+void *libedid_init_flags(unsigned char *raw_edid, unsigned int flags)
+{
     if (!raw_edid)
         return NULL;
 
-    info = libedid_process_edid_info(raw_edid);
-    return info; 
+    /* No length to check the HF-EEODB count against */
+    return libedid_init_parse(raw_edid, (raw_edid[126] + 1) * 128u, flags,
+                              EDID_PARSE_BASE_COUNT);
+}
+
+void *libedid_init(unsigned char *raw_edid)
+{
+    return libedid_init_flags(raw_edid, 0);
 }
 
 void libedid_destroy(void *info)
 {
-    if (info)
+    if (info && !libedid_cache_put(info))
         libedid_destroy_edid_info((struct edid_info *)info);
 }
\ No newline at end of file
@@ -56,6 +56,17 @@ struct libedid_detailed_mode {
         enum edid_stereo_type stereo;
 };
 
+/* A CEA data block, data points to the payload after the tag byte, and
+ * after the extended tag byte for extended blocks (len excludes both).
+ */
+struct libedid_data_block {
+        unsigned char ext_blk;
+        unsigned char tag;
+        unsigned char ext_tag;
+        unsigned char len;
+        const unsigned char *data;
+};
+
 char *libedid_get_display_vendor(void *edid_info);
 
 unsigned int libedid_get_display_productid(void *edid_info);
@@ -64,6 +75,192 @@ unsigned int libedid_get_display_sno(void *edid_info);
 
 struct libedid_detailed_mode *libedid_get_preferred_mode(void *edid_info);
 
+/* Established timings, then standard timings (including those of the 0xFA
+ * descriptors) of the base block, as detailed modes: DMT timings, or CVT
+ * ones for standard timings which are not in DMT. Then the CVT timings of
+ * the CVT 3 byte codes of 0xF8 descriptors. Returns how many.
+ */
+unsigned int libedid_get_std_modes(void *edid_info,
+                const struct libedid_detailed_mode **modes);
+
+/* Timings of the DisplayID extension blocks (detailed, CVT/formula based and
+ * DMT code ones), in EDID order. Returns how many, *preferred is the index of
+ * the preferred one, or -1.
+ */
+unsigned int libedid_get_displayid_modes(void *edid_info,
+                const struct libedid_detailed_mode **modes, int *preferred);
+
+/* Video timing range limits of a DisplayID block, max_pixel_clock_khz is 0
+ * without one.
+ */
+struct libedid_timing_range {
+        unsigned int min_pixel_clock_khz;
+        unsigned int max_pixel_clock_khz;
+        unsigned short min_refresh_hz;
+        unsigned short max_refresh_hz;
+        /* Refresh rate changes without a modeset */
+        bool seamless;
+};
+
+void libedid_get_timing_range(void *edid_info, struct libedid_timing_range *range);
+
+/* VIC bitmaps for libedid_get_mode_list(), OR them together */
+enum libedid_mode_lists {
+        /* VICs from the video data blocks */
+        LIBEDID_MODES_VDB = (1 << 0),
+        LIBEDID_MODES_420_ONLY = (1 << 1),
+        LIBEDID_MODES_420_ALSO = (1 << 2),
+        LIBEDID_MODES_ALL = LIBEDID_MODES_VDB | LIBEDID_MODES_420_ONLY |
+                LIBEDID_MODES_420_ALSO,
+        /* Also list the refresh / 1.001 variant after each VIC which has one */
+        LIBEDID_MODES_FRACTIONAL = (1 << 3),
+};
+
+enum libedid_vic_caps_flags {
+        /* Listed in a video data block */
+        LIBEDID_VIC_SUPPORTED = (1 << 0),
+        LIBEDID_VIC_420_ONLY = (1 << 1),
+        LIBEDID_VIC_420_ALSO = (1 << 2),
+        LIBEDID_VIC_NATIVE = (1 << 3),
+};
+
+/* What the EDID says about one VIC */
+struct libedid_vic_caps {
+        /* enum libedid_vic_caps_flags */
+        unsigned char flags;
+        /* In the video format preference block, 1 is the most preferred,
+         * 0 means not listed
+         */
+        unsigned char pref_rank;
+        /* Extension block and data block (index of the data block, as
+         * in libedid_next_data_block()) first listing this VIC, ext_blk
+         * is 0 if none does
+         */
+        unsigned char ext_blk;
+        unsigned short db;
+};
+
+/* Caps of a VIC, the returned pointer is valid until libedid_destroy() */
+const struct libedid_vic_caps *libedid_get_vic_caps(void *edid_info, unsigned char vic);
+
+/* Expand the VICs of these lists (enum libedid_mode_lists) into their
+ * CTA-861 timings, in VIC order, a VIC in several lists appears once.
+ * Fills up to max_modes modes, and returns how many there are in total,
+ * so passing NULL modes returns the count.
+ */
+int libedid_get_mode_list(void *edid_info, unsigned int lists,
+                struct libedid_detailed_mode *modes, unsigned int max_modes);
+
+/* struct libedid_caps bits, same as the EDID_CAP_* ones of libedid.h */
+#define LIBEDID_CAP_YCBCR444            (1ULL << 0)
+#define LIBEDID_CAP_YCBCR422            (1ULL << 1)
+#define LIBEDID_CAP_YCBCR420            (1ULL << 2)
+#define LIBEDID_CAP_DC_30               (1ULL << 3)
+#define LIBEDID_CAP_DC_36               (1ULL << 4)
+#define LIBEDID_CAP_DC_48               (1ULL << 5)
+#define LIBEDID_CAP_DC_Y444             (1ULL << 6)
+#define LIBEDID_CAP_DC420_30            (1ULL << 7)
+#define LIBEDID_CAP_DC420_36            (1ULL << 8)
+#define LIBEDID_CAP_DC420_48            (1ULL << 9)
+#define LIBEDID_CAP_BT2020_RGB          (1ULL << 10)
+#define LIBEDID_CAP_BT2020_YCC          (1ULL << 11)
+#define LIBEDID_CAP_BT2020_CYCC         (1ULL << 12)
+#define LIBEDID_CAP_DCIP3               (1ULL << 13)
+#define LIBEDID_CAP_XVYCC_601           (1ULL << 14)
+#define LIBEDID_CAP_XVYCC_709           (1ULL << 15)
+#define LIBEDID_CAP_SYCC_601            (1ULL << 16)
+#define LIBEDID_CAP_OPYCC_601           (1ULL << 17)
+#define LIBEDID_CAP_OPRGB               (1ULL << 18)
+#define LIBEDID_CAP_EOTF_SDR            (1ULL << 19)
+#define LIBEDID_CAP_EOTF_HDR            (1ULL << 20)
+#define LIBEDID_CAP_EOTF_ST2084         (1ULL << 21)
+#define LIBEDID_CAP_EOTF_HLG            (1ULL << 22)
+#define LIBEDID_CAP_HDR_STATIC_MD1      (1ULL << 23)
+#define LIBEDID_CAP_HDR_DYNAMIC_MD      (1ULL << 24)
+#define LIBEDID_CAP_AUDIO               (1ULL << 25)
+#define LIBEDID_CAP_UNDERSCAN           (1ULL << 26)
+#define LIBEDID_CAP_HDMI_AI             (1ULL << 27)
+#define LIBEDID_CAP_DVI_DUAL            (1ULL << 28)
+#define LIBEDID_CAP_SCDC                (1ULL << 29)
+#define LIBEDID_CAP_SCDC_RR             (1ULL << 30)
+#define LIBEDID_CAP_SCRAMBLING_340      (1ULL << 31)
+#define LIBEDID_CAP_FRL                 (1ULL << 32)
+#define LIBEDID_CAP_3D_OSD              (1ULL << 33)
+#define LIBEDID_CAP_QS_RGB              (1ULL << 34)
+#define LIBEDID_CAP_QS_YCC              (1ULL << 35)
+#define LIBEDID_CAP_SRGB_DEFAULT        (1ULL << 36)
+#define LIBEDID_CAP_TILED               (1ULL << 37)
+#define LIBEDID_CAP_RGB444              (1ULL << 38)
+#define LIBEDID_CAP_3D_IV               (1ULL << 39)
+#define LIBEDID_CAP_3D_DV               (1ULL << 40)
+
+#define LIBEDID_CAP_YCBCR (LIBEDID_CAP_YCBCR444 | LIBEDID_CAP_YCBCR422 | LIBEDID_CAP_YCBCR420)
+#define LIBEDID_CAP_DC (LIBEDID_CAP_DC_30 | LIBEDID_CAP_DC_36 | LIBEDID_CAP_DC_48)
+#define LIBEDID_CAP_DC420 (LIBEDID_CAP_DC420_30 | LIBEDID_CAP_DC420_36 | LIBEDID_CAP_DC420_48)
+#define LIBEDID_CAP_BT2020 (LIBEDID_CAP_BT2020_RGB | LIBEDID_CAP_BT2020_YCC | \
+                LIBEDID_CAP_BT2020_CYCC)
+#define LIBEDID_CAP_HDR (LIBEDID_CAP_EOTF_HDR | LIBEDID_CAP_EOTF_ST2084 | LIBEDID_CAP_EOTF_HLG)
+
+/* Capability profile of the display, one cache line, hot fields first.
+ * Test several capabilities at once with (caps->bits & mask) == mask.
+ */
+struct libedid_caps {
+        /* LIBEDID_CAP_* */
+        unsigned long long bits;
+        unsigned int max_tmds_clk_mhz;
+        /* HDR static metadata, in cd/m2 */
+        float hdr_max_lum;
+        float hdr_fav_lum;
+        float hdr_min_lum;
+        /* HDMI 2.1 FRL: 0 for TMDS only, up to 6: 4 lanes at 12 Gbps */
+        unsigned char max_frl_rate;
+        /* Deepest bpc, 8 without deep color */
+        unsigned char max_bpc;
+        /* Deepest 4:2:0 bpc, 0 without 4:2:0 deep color */
+        unsigned char max_420_bpc;
+        /* Base block color depth, 0 if undefined */
+        unsigned char base_bpc;
+
+        unsigned int pid;
+        unsigned int sno;
+        char vendor[4];
+        unsigned char n_ext_blks;
+        unsigned char reserved[23];
+};
+
+/* Valid until libedid_destroy() */
+const struct libedid_caps *libedid_get_caps(void *edid_info);
+
+/* CIE 1931 chromaticity of the base block, in units of 1/1024 */
+struct libedid_chromaticity {
+        unsigned short red_x;
+        unsigned short red_y;
+        unsigned short green_x;
+        unsigned short green_y;
+        unsigned short blue_x;
+        unsigned short blue_y;
+        unsigned short white_x;
+        unsigned short white_y;
+};
+
+void libedid_get_chromaticity(void *edid_info, struct libedid_chromaticity *chroma);
+
+/* 32 byte compact form of a display, to keep many of them around: the
+ * LIBEDID_CAP_* bits, and the numeric fields as the EDID codes them.
+ */
+struct libedid_compact {
+        unsigned long long bits;
+        unsigned char packed[24];
+};
+
+void libedid_compact(void *edid_info, struct libedid_compact *compact);
+
+/* A handle for the libedid_display_*() and libedid_get_caps() APIs, rebuilt
+ * from a compact form: it has no modes and no data blocks. Free it with
+ * libedid_destroy().
+ */
+void *libedid_expand_compact(const struct libedid_compact *compact);
+
 bool libedid_display_supports_ycbcr(void *edid_info);
 
 bool libedid_display_supports_ycbcr444(void *edid_info);
@@ -98,6 +295,9 @@ unsigned int libedid_display_max_tmds_clk_mhz(void *edid_info);
 
 bool libedid_display_supports_audio(void *edid_info);
 
+/* HDR static metadata luminances in cd/m2, converted from the exact 32.32
+ * fixed point values the parser keeps
+ */
 double libedid_display_hdr_max_lum(void *edid_info);
 
 double libedid_display_hdr_min_lum(void *edid_info);
@@ -110,8 +310,441 @@ bool libedid_display_supports_hdr_hlg(void *edid_info);
 
 bool libedid_display_supports_hdr_output(void *edid_info);
 
+/* Walk all CEA data blocks in EDID order, start with *iter = 0 */
+bool libedid_next_data_block(void *edid_info, unsigned int *iter,
+                struct libedid_data_block *db);
+
+/* Walk the CEA data blocks with this tag (and extended tag, for extended
+ * blocks), start with *iter = 0. Every step is a single index lookup.
+ */
+bool libedid_find_data_block(void *edid_info, unsigned char tag, unsigned char ext_tag,
+                unsigned int *iter, struct libedid_data_block *db);
+
+/* What one extension block holds. The merged view (libedid_display_supports_*
+ * and friends) ORs the CEA header bits of all the blocks, and takes the first
+ * VSDB/VSVDB/IFDB of a kind, in block order.
+ */
+struct libedid_ext_blk {
+        unsigned char tag;
+        unsigned char revision;
+        bool underscan;
+        bool audio;
+        bool ycbcr444;
+        bool ycbcr422;
+        unsigned char n_native_dtds;
+        /* Its DTDs, a slice of the CEA DTDs of all the blocks */
+        const struct libedid_detailed_mode *dtds;
+        unsigned char n_dtds;
+        /* Its data blocks, first_db is an *iter for libedid_next_data_block() */
+        unsigned int first_db;
+        unsigned int n_db;
+};
+
+/* blk counts from 1, returns false past the last extension block */
+bool libedid_get_ext_blk(void *edid_info, unsigned int blk, struct libedid_ext_blk *ext);
+
+/* What the parser found wrong in an EDID */
+enum libedid_diag_code {
+        LIBEDID_DIAG_NONE = 0,
+        /* No EDID, or no buffer, was passed */
+        LIBEDID_DIAG_NO_EDID,
+        /* Rejected by validation */
+        LIBEDID_DIAG_TRUNCATED,
+        LIBEDID_DIAG_HEADER,
+        LIBEDID_DIAG_CHECKSUM,
+        LIBEDID_DIAG_DB_BOUNDS,
+        /* Caller buffer misaligned (detail 0) or too small (detail 1) */
+        LIBEDID_DIAG_BAD_BUFFER,
+        LIBEDID_DIAG_NO_MEMORY,
+        /* CEA extension block with a DTD offset below 4, detail is the offset */
+        LIBEDID_DIAG_BAD_EXT_BLK,
+        /* Data block length invalid for its type, detail is its payload length */
+        LIBEDID_DIAG_BAD_DB_LEN,
+        /* Reserved VIC, detail is the VIC */
+        LIBEDID_DIAG_BAD_VIC,
+        /* 4:2:0 capability map without a video data block */
+        LIBEDID_DIAG_CMDB_NO_VDB,
+        /* 4:2:0 capability map bit past the SVDs, detail is the bit */
+        LIBEDID_DIAG_CMDB_NO_SVD,
+        /* More dynamic HDR metadata blocks than the parser keeps */
+        LIBEDID_DIAG_DB_LIMIT,
+        /* Data block with no parser, detail is tag << 8 | extended tag */
+        LIBEDID_DIAG_UNHANDLED_DB,
+        /* Data block the parser skips, detail is tag << 8 | extended tag */
+        LIBEDID_DIAG_UNSUPPORTED_DB,
+        /* DisplayID section with a bad checksum, skipped */
+        LIBEDID_DIAG_SECTION_CHECKSUM,
+        /* Standard, CVT 3 byte code or DisplayID timing which gives no mode,
+         * detail is the DisplayID data block tag (0 in the base block)
+         */
+        LIBEDID_DIAG_BAD_TIMING,
+        /* More modes than the mode index keeps, detail is how many were
+         * left out
+         */
+        LIBEDID_DIAG_MODE_LIMIT,
+};
+
+enum libedid_diag_severity {
+        LIBEDID_DIAG_INFO = 0,
+        LIBEDID_DIAG_WARN,
+        LIBEDID_DIAG_ERROR,
+};
+
+struct libedid_diag {
+        /* enum libedid_diag_code */
+        unsigned char code;
+        /* enum libedid_diag_severity */
+        unsigned char severity;
+        /* Block number, 0 is the base block */
+        unsigned char blk;
+        unsigned char reserved;
+        /* Byte offset in the EDID, of the tag byte for data blocks */
+        unsigned short offset;
+        unsigned short detail;
+};
+
+/* Diagnostics of this EDID (all of them, a lazy handle gets fully decoded
+ * first), in the order the parser found them. Valid until libedid_destroy().
+ * Up to 32 are kept, *n_dropped (if not NULL) gets the number of the others.
+ */
+unsigned int libedid_get_diags(void *edid_info, const struct libedid_diag **diags,
+                unsigned int *n_dropped);
+
+typedef void (*libedid_diag_callback)(const struct libedid_diag *diag, void *data);
+
+/* Call cb for every diagnostic, on the thread which parses, NULL turns it
+ * off. Failures which leave no handle (corrupt EDID, out of memory ...) are
+ * only reported this way. Process wide and not synchronized: set it before
+ * parsing anything, never while another thread parses. The parser itself
+ * never logs (but in VERBOSE builds) nor does any I/O.
+ */
+void libedid_set_diag_callback(libedid_diag_callback cb, void *data);
+
+enum libedid_indexed_mode_flags {
+        LIBEDID_MODE_INTERLACED = (1 << 0),
+        /* The refresh / 1.001 variant of the VIC */
+        LIBEDID_MODE_FRACTIONAL = (1 << 1),
+        /* dtd is an index in the base block DTDs, else in the CEA DTDs */
+        LIBEDID_MODE_BASE_DTD = (1 << 2),
+        /* An established or standard timing, dtd is an index in
+         * libedid_get_std_modes()
+         */
+        LIBEDID_MODE_STD = (1 << 3),
+        /* A DisplayID timing, dtd is an index in libedid_get_displayid_modes() */
+        LIBEDID_MODE_DISPLAYID = (1 << 4),
+};
+
+/* A mode of the display mode index */
+struct libedid_indexed_mode {
+        unsigned short hactive;
+        /* Lines per frame, interlaced modes too */
+        unsigned short vactive;
+        unsigned int refresh_mhz;
+        unsigned int pixel_clock_khz;
+        /* 0 for a DTD or a standard timing */
+        unsigned char vic;
+        /* enum libedid_indexed_mode_flags */
+        unsigned char flags;
+        unsigned char dtd;
+};
+
+/*
+ * Mode index: every DTD, established and standard timing, and VIC of the
+ * display, fractional variants included, once per distinct timing, sorted by
+ * hactive, vactive, refresh rate (in mHz) and pixel clock. Lookups are binary
+ * searches, and return indexes in it.
+ */
+unsigned int libedid_get_n_modes(void *edid_info);
+
+const struct libedid_indexed_mode *libedid_get_indexed_mode(void *edid_info, unsigned int mode);
+
+/* Full timing of an indexed mode, -1 if there is no such mode */
+int libedid_get_indexed_mode_timing(void *edid_info, unsigned int mode,
+                struct libedid_detailed_mode *timing);
+
+/* The same modes in one array, most preferred first: the video format
+ * preference block (VICs and DTDs) in its order, then the native VICs, the
+ * first DTD, the other DTDs, the VICs, DisplayID and standard timings.
+ * Returns how many.
+ */
+unsigned int libedid_get_ranked_modes(void *edid_info,
+                const struct libedid_indexed_mode **modes);
+
+/* Full timing of a mode of libedid_get_ranked_modes() or of the index */
+void libedid_get_mode_timing(void *edid_info, const struct libedid_indexed_mode *mode,
+                struct libedid_detailed_mode *timing);
+
+/* Index of the mode with exactly this resolution and refresh, or -1 */
+int libedid_find_mode(void *edid_info, unsigned int hactive, unsigned int vactive,
+                unsigned int refresh_mhz);
+
+/* Closest refresh at this resolution, or if the display has none, the
+ * closest number of pixels then the closest refresh. -1 without modes.
+ */
+int libedid_find_nearest_mode(void *edid_info, unsigned int hactive, unsigned int vactive,
+                unsigned int refresh_mhz);
+
+/* Modes at this resolution with a refresh within [min, max] mHz, as a
+ * run of *first, *first + 1 ... in increasing refresh. Returns how many,
+ * so the highest refresh at a resolution is the last of (0, ~0U).
+ */
+unsigned int libedid_find_modes(void *edid_info, unsigned int hactive, unsigned int vactive,
+                unsigned int min_refresh_mhz, unsigned int max_refresh_mhz,
+                unsigned int *first);
+
+enum libedid_timing_formula {
+        /* VESA CVT, standard (CRT) blanking */
+        LIBEDID_TIMING_CVT = 0,
+        /* CVT reduced blanking v1, v2 and v3 */
+        LIBEDID_TIMING_CVT_RB,
+        LIBEDID_TIMING_CVT_RB2,
+        LIBEDID_TIMING_CVT_RB3,
+        /* VESA GTF, default curve */
+        LIBEDID_TIMING_GTF,
+        /* GTF with the secondary curve in libedid_timing_req.gtf */
+        LIBEDID_TIMING_GTF2,
+};
+
+enum libedid_timing_flags {
+        /* CVT and GTF only */
+        LIBEDID_TIMING_INTERLACED = (1 << 0),
+        /* CVT-RB v2/v3: pixel clock * 1000 / 1001, for 59.94 Hz and such */
+        LIBEDID_TIMING_VIDEO_OPTIMIZED = (1 << 1),
+        /* CVT-RB v3: vsync right after the active lines */
+        LIBEDID_TIMING_EARLY_VSYNC = (1 << 2),
+};
+
+struct libedid_timing_req {
+        /* enum libedid_timing_formula */
+        unsigned char formula;
+        /* enum libedid_timing_flags */
+        unsigned char flags;
+        unsigned short hactive;
+        /* Lines and frames per second (in mHz) of the whole frame,
+         * interlaced modes too
+         */
+        unsigned short vactive;
+        unsigned int refresh_mhz;
+        /* CVT-RB v3: extra horizontal blanking, 0-120 pixels by 8 */
+        unsigned char rb3_hblank_extra;
+        /* GTF2: the secondary curve starts at start_khz, C and J are
+         * doubled, like in the range limits descriptor
+         */
+        struct {
+                unsigned short start_khz;
+                unsigned char c_x2;
+                unsigned short m;
+                unsigned char k;
+                unsigned char j_x2;
+        } gtf;
+};
+
+/* Timing of any mode with the CVT or GTF formulas, with integer math.
+ * Results are memoized per thread. Returns -1 if the request makes no sense.
+ */
+int libedid_generate_timing(const struct libedid_timing_req *req,
+                struct libedid_detailed_mode *mode);
+
+enum libedid_pixel_format {
+        LIBEDID_FMT_RGB = 0,
+        LIBEDID_FMT_YCBCR444,
+        LIBEDID_FMT_YCBCR422,
+        LIBEDID_FMT_YCBCR420,
+        LIBEDID_N_FMTS,
+};
+
+enum libedid_bpc {
+        LIBEDID_BPC_8 = 0,
+        LIBEDID_BPC_10,
+        LIBEDID_BPC_12,
+        LIBEDID_BPC_16,
+        LIBEDID_N_BPCS,
+};
+
+/* Bit of a (format, bpc) in libedid_feasibility_mask() */
+#define LIBEDID_FEASIBLE(fmt, bpc) (1 << ((fmt) * LIBEDID_N_BPCS + (bpc)))
+
+/* How libedid_best_config() picks a configuration */
+enum libedid_config_policy {
+        /* Deepest color first, then RGB, 4:4:4, 4:2:2, 4:2:0 */
+        LIBEDID_POLICY_MAX_BPC = 0,
+        /* RGB at any depth before YCbCr, then the deepest color */
+        LIBEDID_POLICY_PREFER_RGB,
+        /* Fewest bits per pixel on the link */
+        LIBEDID_POLICY_MIN_BANDWIDTH,
+        LIBEDID_N_POLICIES,
+};
+
+/* A DP link: 1, 2 or 4 lanes, at 1620, 2700, 5400, 8100 Mbps (8b/10b),
+ * or 10000, 13500, 20000 Mbps (128b/132b) per lane
+ */
+struct libedid_dp_link {
+        unsigned int lanes;
+        unsigned int link_rate_mbps;
+};
+
+struct libedid_feasibility;
+
+/* Check every mode of the display (DTDs first, then the VICs in VIC order)
+ * in every format and color depth against what the sink supports, its
+ * HDMI TMDS/FRL limits, and the DP link if dp isn't NULL. Compute it once
+ * per display (and link), and free it with libedid_feasibility_destroy().
+ */
+struct libedid_feasibility *libedid_feasibility_create(void *edid_info,
+                const struct libedid_dp_link *dp);
+
+void libedid_feasibility_destroy(struct libedid_feasibility *fz);
+
+unsigned int libedid_feasibility_n_modes(const struct libedid_feasibility *fz);
+
+/* Timing of a mode, and its VIC (0 for DTDs) */
+const struct libedid_detailed_mode *libedid_feasibility_mode(
+                const struct libedid_feasibility *fz, unsigned int mode, unsigned char *vic);
+
+/* LIBEDID_FEASIBLE() bits of all the feasible configurations of a mode */
+unsigned short libedid_feasibility_mask(const struct libedid_feasibility *fz,
+                unsigned int mode);
+
+bool libedid_mode_feasible(const struct libedid_feasibility *fz, unsigned int mode,
+                enum libedid_pixel_format fmt, enum libedid_bpc bpc);
+
+/* Best feasible configuration of a mode under policy, -1 if there is none */
+int libedid_best_config(const struct libedid_feasibility *fz, unsigned int mode,
+                enum libedid_config_policy policy, enum libedid_pixel_format *fmt,
+                enum libedid_bpc *bpc);
+
+/* 8, 10, 12 or 16 */
+unsigned int libedid_bpc_value(enum libedid_bpc bpc);
+
 void *libedid_init(unsigned char *raw_edid);
 
+enum libedid_init_flags {
+        /* Only validate and index the EDID in libedid_init_flags(), and
+         * decode what each accessor needs on its first call. The first
+         * calls must not race with each other on the same handle.
+         */
+        LIBEDID_INIT_LAZY = (1 << 0),
+        /* raw_edid already passed libedid_validate_edid(), skip that */
+        LIBEDID_INIT_VALIDATED = (1 << 1),
+        /* Reject EDIDs with a bad checksum or data blocks out of bounds,
+         * instead of parsing what is in bounds and reporting the rest as
+         * diagnostics.
+         */
+        LIBEDID_INIT_STRICT = (1 << 2),
+};
+
+void *libedid_init_flags(unsigned char *raw_edid, unsigned int flags);
+
+/* Same as above, for a raw_edid of len bytes. Truncated EDIDs (and with
+ * LIBEDID_INIT_STRICT, corrupt ones) are rejected (NULL) before anything
+ * is allocated.
+ */
+void *libedid_init_len(unsigned char *raw_edid, size_t len, unsigned int flags);
+
+struct libedid_cache_stats {
+        unsigned long long hits;
+        unsigned long long misses;
+        unsigned long long evictions;
+        unsigned int entries;
+        unsigned int max_entries;
+};
+
+/* Share one parsed, read-only instance between all the libedid_init() calls
+ * with identical EDID bytes, keeping up to max_entries distinct EDIDs.
+ * Calling it again changes the cap. Handles are still freed with
+ * libedid_destroy(), which drops a reference on shared instances.
+ */
+int libedid_cache_enable(unsigned int max_entries);
+
+/* Stop caching and free the unused entries, shared handles stay valid */
+void libedid_cache_disable(void);
+
+void libedid_cache_get_stats(struct libedid_cache_stats *stats);
+
+struct libedid_blob {
+        const unsigned char *data;
+        size_t len;
+};
+
+/* Per item status of libedid_process_batch() */
+enum libedid_status {
+        LIBEDID_OK = 0,
+        /* NULL blob, or shorter than the base block */
+        LIBEDID_ERR_INVALID = -1,
+        /* Shorter than the extension count in the base block says */
+        LIBEDID_ERR_TRUNCATED = -2,
+        /* Rejected by the parser */
+        LIBEDID_ERR_PARSE = -3,
+        /* Bad header, checksum or data block bounds */
+        LIBEDID_ERR_CORRUPT = -4,
+};
+
+/* Parse n_blobs EDIDs with n_workers threads (0 means one per CPU).
+ * handles[i] and status[i] get the libedid_init() handle (or NULL) and
+ * the enum libedid_status of blobs[i], the same for any worker count.
+ * Blobs must stay around as long as their handles. Returns the number
+ * of failed items, or -1 if the batch could not be started.
+ */
+int libedid_process_batch(const struct libedid_blob *blobs, size_t n_blobs,
+                void **handles, int *status, unsigned int n_workers);
+
+/* One connector of a tiled display, see libedid_group_tiles() */
+struct libedid_tile {
+        /* Index of its handle in the array given to libedid_group_tiles() */
+        unsigned int handle;
+        /* Location in the grid of tiles, 0, 0 is the top left one */
+        unsigned char hloc;
+        unsigned char vloc;
+        /* Top left pixel of the tile in the combined surface, bezels left out */
+        unsigned int x;
+        unsigned int y;
+        unsigned short hsize;
+        unsigned short vsize;
+        /* In pixels */
+        unsigned short bezel_top;
+        unsigned short bezel_bottom;
+        unsigned short bezel_right;
+        unsigned short bezel_left;
+        /* Mode index entry of the tile at the refresh rate of the group,
+         * see libedid_get_indexed_mode(), or -1 if it doesn't have one.
+         */
+        int mode;
+};
+
+/* The connectors of one tiled display */
+struct libedid_tile_group {
+        /* Topology ID of the display, from its DisplayID blocks */
+        char vendor[4];
+        unsigned short product;
+        unsigned int serial;
+        unsigned char n_htiles;
+        unsigned char n_vtiles;
+        bool single_enclosure;
+        /* Its tiles are tiles[first_tile] to tiles[first_tile + n_tiles - 1],
+         * in handle order.
+         */
+        unsigned int first_tile;
+        unsigned int n_tiles;
+        /* Every tile of the grid was found, once */
+        bool complete;
+        /* Native mode of the whole display: the combined surface, at the
+         * highest refresh rate (in mHz) all the tiles have at their size.
+         */
+        unsigned int hactive;
+        unsigned int vactive;
+        unsigned int refresh_mhz;
+};
+
+/*
+ * Group the handles of the connectors of tiled displays (one per
+ * connector, NULL ones are skipped) by their DisplayID tiled topology,
+ * and the vendor, product and serial of their base block. groups and
+ * tiles need room for n entries. Handles without a tiled topology are
+ * left out. Returns the number of groups, or 0 if out of memory.
+ */
+unsigned int libedid_group_tiles(void *const *edid_infos, unsigned int n,
+                struct libedid_tile_group *groups, struct libedid_tile *tiles);
+
 void libedid_destroy(void *info);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2022 Shashank Sharma (contactshashanksharma@gmail.com)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sub license,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the
+ * next paragraph) shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <sys/types.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "libedid-api.h"
+#include "libedid.h"
+
+/*
+ * Batch parsing: the items are split in one contiguous range per worker.
+ * A worker claims items from the front of its own range, and once that
+ * runs dry it claims from the other ranges, so a worker stuck on a few
+ * big EDIDs gets helped by the others. Claims are atomic increments of
+ * the range cursor, so each item is parsed exactly once, and its result
+ * always lands at its own index whatever the number of workers.
+ */
+struct libedid_batch_range {
+    size_t next;
+    size_t end;
+} __attribute__((aligned(64)));
+
+struct libedid_batch {
+    const struct libedid_blob *blobs;
+    void **handles;
+    int *status;
+    unsigned int n_workers;
+    struct libedid_batch_range *ranges;
+};
+
+struct libedid_batch_worker {
+    struct libedid_batch *batch;
+    unsigned int id;
+};
+
+static int libedid_batch_parse_one(const struct libedid_blob *blob, void **handle)
+{
+    *handle = NULL;
+    if (!blob->data || blob->len < 128)
+        return LIBEDID_ERR_INVALID;
+
+    /* Validate once here, the parser trusts the result */
+    switch (libedid_validate_edid(blob->data, blob->len)) {
+    case EDID_VALIDATE_OK:
+        break;
+
+    case EDID_VALIDATE_TRUNCATED:
+        return LIBEDID_ERR_TRUNCATED;
+
+    default:
+        return LIBEDID_ERR_CORRUPT;
+    }
+
+    *handle = libedid_init_len((unsigned char *)blob->data, blob->len, LIBEDID_INIT_VALIDATED);
+    return *handle ? LIBEDID_OK : LIBEDID_ERR_PARSE;
+}
+
+static bool libedid_batch_claim(struct libedid_batch_range *range, size_t *item)
+{
+    if (__atomic_load_n(&range->next, __ATOMIC_RELAXED) >= range->end)
+        return false;
+
+    *item = __atomic_fetch_add(&range->next, 1, __ATOMIC_RELAXED);
+    return *item < range->end;
+}
+
+static void *libedid_batch_worker(void *data)
+{
+    struct libedid_batch_worker *worker = data;
+    struct libedid_batch *batch = worker->batch;
+    unsigned int victim;
+    size_t item;
+
+    /* Own range first, then steal from the others, round robin */
+    for (victim = 0; victim < batch->n_workers; victim++) {
+        struct libedid_batch_range *range =
+            &batch->ranges[(worker->id + victim) % batch->n_workers];
+
+        while (libedid_batch_claim(range, &item))
+            batch->status[item] = libedid_batch_parse_one(&batch->blobs[item],
+                                                          &batch->handles[item]);
+    }
+
+    return NULL;
+}
+
+int libedid_process_batch(const struct libedid_blob *blobs, size_t n_blobs,
+                void **handles, int *status, unsigned int n_workers)
+{
+    struct libedid_batch_worker *workers;
+    pthread_t *threads;
+    struct libedid_batch batch;
+    unsigned int i, started;
+    int failed = 0;
+    size_t item;
+
+    if (!blobs || !handles || !status)
+        return -1;
+
+    if (!n_workers) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+        n_workers = cpus > 0 ? cpus : 1;
+    }
+
+    if (n_workers > n_blobs)
+        n_workers = n_blobs ? n_blobs : 1;
+
+    batch.blobs = blobs;
+    batch.handles = handles;
+    batch.status = status;
+    batch.n_workers = n_workers;
+    batch.ranges = aligned_alloc(64, n_workers * sizeof(*batch.ranges));
+    workers = calloc(n_workers, sizeof(*workers));
+    threads = calloc(n_workers, sizeof(*threads));
+    if (!batch.ranges || !workers || !threads) {
+        free(batch.ranges);
+        free(workers);
+        free(threads);
+        return -1;
+    }
+
+    for (i = 0; i < n_workers; i++) {
+        batch.ranges[i].next = n_blobs * i / n_workers;
+        batch.ranges[i].end = n_blobs * (i + 1) / n_workers;
+        workers[i].batch = &batch;
+        workers[i].id = i;
+    }
+
+    /* The calling thread is worker 0 */
+    for (started = 1; started < n_workers; started++)
+        if (pthread_create(&threads[started], NULL, libedid_batch_worker, &workers[started]))
+            break;
+
+    libedid_batch_worker(&workers[0]);
+
+    for (i = 1; i < started; i++)
+        pthread_join(threads[i], NULL);
+
+    /* Worker 0 has stolen everything the missing threads left behind */
+    for (item = 0; item < n_blobs; item++)
+        if (status[item] != LIBEDID_OK)
+            failed++;
+
+    free(batch.ranges);
+    free(workers);
+    free(threads);
+    return failed;
+}
@@ -0,0 +1,353 @@
+/*
+ * Copyright (c) 2022 Shashank Sharma (contactshashanksharma@gmail.com)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sub license,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the
+ * next paragraph) shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <sys/types.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libedid-api.h"
+#include "libedid.h"
+
+/*
+ * Mode feasibility: for every mode of a display (its DTDs and VICs) and
+ * every pixel format and color depth, check once whether the sink can
+ * take it, whether it fits the HDMI TMDS (or FRL) limits of the sink,
+ * and the DP link if one is given. The result is a 16 bit mask per mode
+ * (LIBEDID_FEASIBLE() bits), so modeset checks are a load and a bit test.
+ */
+#define HDMI_IEEE_OUI 0x000C03
+
+/* TMDS limit of HDMI sinks which don't give one in their VSDB */
+#define HDMI_DEFAULT_TMDS_MHZ 165
+
+static const unsigned char libedid_bpc_values[LIBEDID_N_BPCS] = { 8, 10, 12, 16 };
+
+/* FRL link rate in Gbps (lanes x rate per lane) of each Max_FRL_Rate */
+static const unsigned char libedid_frl_gbps[] = { 0, 9, 18, 24, 32, 40, 48 };
+
+/* Candidates in policy order, as LIBEDID_FEASIBLE() bit numbers */
+#define FZ_CAND(fmt, bpc) ((fmt) * LIBEDID_N_BPCS + LIBEDID_BPC_##bpc)
+#define RGB(bpc) FZ_CAND(LIBEDID_FMT_RGB, bpc)
+#define YUV444(bpc) FZ_CAND(LIBEDID_FMT_YCBCR444, bpc)
+#define YUV422(bpc) FZ_CAND(LIBEDID_FMT_YCBCR422, bpc)
+#define YUV420(bpc) FZ_CAND(LIBEDID_FMT_YCBCR420, bpc)
+
+static const unsigned char libedid_policy_order[][LIBEDID_N_FMTS * LIBEDID_N_BPCS] = {
+    [LIBEDID_POLICY_MAX_BPC] = {
+        RGB(16), YUV444(16), YUV422(16), YUV420(16),
+        RGB(12), YUV444(12), YUV422(12), YUV420(12),
+        RGB(10), YUV444(10), YUV422(10), YUV420(10),
+        RGB(8), YUV444(8), YUV422(8), YUV420(8),
+    },
+    [LIBEDID_POLICY_PREFER_RGB] = {
+        RGB(16), RGB(12), RGB(10), RGB(8),
+        YUV444(16), YUV444(12), YUV444(10), YUV444(8),
+        YUV422(16), YUV422(12), YUV422(10), YUV422(8),
+        YUV420(16), YUV420(12), YUV420(10), YUV420(8),
+    },
+    /* By bits per pixel, 4:2:0 8 bpc (12 bpp) first */
+    [LIBEDID_POLICY_MIN_BANDWIDTH] = {
+        YUV420(8), YUV420(10), YUV422(8), YUV420(12),
+        YUV422(10), RGB(8), YUV444(8), YUV420(16),
+        YUV422(12), RGB(10), YUV444(10), RGB(12),
+        YUV444(12), RGB(16), YUV444(16), YUV422(16),
+    },
+};
+
+struct libedid_feasibility {
+    unsigned int n_modes;
+    struct libedid_detailed_mode *modes;
+    /* VIC of each mode, 0 for DTDs */
+    unsigned char *vics;
+    /* LIBEDID_FEASIBLE(format, bpc) of each mode */
+    unsigned short *masks;
+};
+
+static bool libedid_sink_is_hdmi(struct edid_info *info)
+{
+    const struct edid_db_entry *entry;
+
+    for (entry = libedid_find_db(info, CEA_DATA_BLOCK_VENDOR, 0); entry;
+            entry = libedid_next_db(info, entry)) {
+        u_int8_t *oui = &info->raw_edid[entry->offset + 1];
+
+        if (entry->len >= 3 && (u_int32_t)(oui[2] << 16 | oui[1] << 8 | oui[0]) ==
+                HDMI_IEEE_OUI)
+            return true;
+    }
+
+    return false;
+}
+
+/* Formats and depths the sink can decode, whatever the bandwidth */
+static unsigned short libedid_sink_formats(struct edid_info *info, bool hdmi,
+        u_int8_t vic_flags)
+{
+    struct edid_tags *etags = &info->cea_blks;
+    struct edid_supp_clr_formats *clr = &info->base_blk.clr_formats;
+    unsigned short depths = 1 << 0;
+    unsigned short depths_444;
+    unsigned short mask = 0;
+    int fmt;
+
+    if (hdmi) {
+        depths |= etags->hdmi_vsdb.dc_30_bpc << 1 |
+            etags->hdmi_vsdb.dc_36_bpc << 2 |
+            etags->hdmi_vsdb.dc_48_bpc << 3;
+        depths_444 = etags->hdmi_vsdb.dc_ycbcr444 ? depths : 1 << 0;
+    } else {
+        /* Digital input color depth of the base block */
+        if (info->base_blk.clr_depth >= 10)
+            depths |= 1 << 1;
+        if (info->base_blk.clr_depth >= 12)
+            depths |= 1 << 2;
+        if (info->base_blk.clr_depth >= 16)
+            depths |= 1 << 3;
+        depths_444 = depths;
+    }
+
+    if (!(vic_flags & EDID_VIC_CAP_420_ONLY)) {
+        mask |= depths << (LIBEDID_FMT_RGB * LIBEDID_N_BPCS);
+        if (clr->clr_format_ycbcr444 || etags->ycbcr444)
+            mask |= depths_444 << (LIBEDID_FMT_YCBCR444 * LIBEDID_N_BPCS);
+        /* 4:2:2 always has 12 bit components, it can't go past that */
+        if (clr->clr_format_ycbcr422 || etags->ycbcr422)
+            mask |= 0x7 << (LIBEDID_FMT_YCBCR422 * LIBEDID_N_BPCS);
+    }
+
+    if (vic_flags & (EDID_VIC_CAP_420_ONLY | EDID_VIC_CAP_420_ALSO)) {
+        fmt = LIBEDID_FMT_YCBCR420;
+        mask |= LIBEDID_FEASIBLE(fmt, 0) |
+            etags->hfvsdb.dc_30_420 * LIBEDID_FEASIBLE(fmt, 1) |
+            etags->hfvsdb.dc_36_420 * LIBEDID_FEASIBLE(fmt, 2) |
+            etags->hfvsdb.dc_48_420 * LIBEDID_FEASIBLE(fmt, 3);
+    }
+
+    return mask;
+}
+
+/* Twice the bits per pixel on the link, hdmi sends 4:2:2 in 24 bits */
+static unsigned int libedid_bpp_x2(int fmt, unsigned int bpc, bool hdmi)
+{
+    switch (fmt) {
+    case LIBEDID_FMT_YCBCR422:
+        return hdmi ? 48 : 4 * bpc;
+    case LIBEDID_FMT_YCBCR420:
+        return 3 * bpc;
+    default:
+        return 6 * bpc;
+    }
+}
+
+/* Formats and depths of a mode which fit the sink's TMDS and FRL limits */
+static unsigned short libedid_hdmi_fit(struct edid_info *info, u_int32_t clock_khz)
+{
+    struct edid_tags *etags = &info->cea_blks;
+    unsigned int tmds_mhz = etags->hfvsdb.max_tmds_rate_mhz;
+    unsigned long long frl_kbps = 0;
+    unsigned short mask = 0;
+    int fmt, bpc;
+
+    if (!tmds_mhz)
+        tmds_mhz = etags->hdmi_vsdb.max_tmds_clock_mhz;
+    if (!tmds_mhz)
+        tmds_mhz = HDMI_DEFAULT_TMDS_MHZ;
+
+    /* FRL carries 16 bits of data per 18 bits of link */
+    if (etags->hfvsdb.max_frl_rate < sizeof(libedid_frl_gbps))
+        frl_kbps = libedid_frl_gbps[etags->hfvsdb.max_frl_rate] * 1000000ULL * 16 / 18;
+
+    for (fmt = 0; fmt < LIBEDID_N_FMTS; fmt++) {
+        for (bpc = 0; bpc < LIBEDID_N_BPCS; bpc++) {
+            unsigned int bpp_x2 = libedid_bpp_x2(fmt, libedid_bpc_values[bpc], true);
+            /* TMDS character rate is the pixel clock at 24 bits per pixel */
+            unsigned long long tmds_khz = (unsigned long long)clock_khz * bpp_x2 / 48;
+
+            if (tmds_khz <= tmds_mhz * 1000ULL ||
+                    (unsigned long long)clock_khz * bpp_x2 / 2 <= frl_kbps)
+                mask |= LIBEDID_FEASIBLE(fmt, bpc);
+        }
+    }
+
+    return mask;
+}
+
+/* Formats and depths of a mode which fit this DP link */
+static unsigned short libedid_dp_fit(const struct libedid_dp_link *dp, u_int32_t clock_khz)
+{
+    unsigned long long link_kbps = (unsigned long long)dp->lanes * dp->link_rate_mbps * 1000;
+    unsigned short mask = 0;
+    int fmt, bpc;
+
+    /* 128b/132b channel coding for UHBR rates, 8b/10b below */
+    if (dp->link_rate_mbps >= 10000)
+        link_kbps = link_kbps * 128 / 132;
+    else
+        link_kbps = link_kbps * 8 / 10;
+
+    for (fmt = 0; fmt < LIBEDID_N_FMTS; fmt++) {
+        for (bpc = 0; bpc < LIBEDID_N_BPCS; bpc++) {
+            unsigned int bpp_x2 = libedid_bpp_x2(fmt, libedid_bpc_values[bpc], false);
+
+            if ((unsigned long long)clock_khz * bpp_x2 / 2 <= link_kbps)
+                mask |= LIBEDID_FEASIBLE(fmt, bpc);
+        }
+    }
+
+    return mask;
+}
+
+struct libedid_feasibility *libedid_feasibility_create(void *edid_info,
+        const struct libedid_dp_link *dp)
+{
+    struct edid_info *info = edid_info;
+    struct libedid_feasibility *fz;
+    unsigned int n_dtds = 0, n_vics, n, i;
+    bool hdmi;
+    char *mem;
+
+    if (!info)
+        return NULL;
+
+    libedid_decode_groups(info, EDID_DECODE_BASE | EDID_DECODE_DTD |
+        EDID_DECODE_CEA_HDR | EDID_DECODE_VIDEO | EDID_DECODE_VSDB);
+
+    for (i = 0; i < 4; i++)
+        if (info->base_blk.dmodes[i].pixel_clock_khz)
+            n_dtds++;
+    n_dtds += info->cea_blks.dtd.n_dtd_modes;
+    n_vics = libedid_get_mode_list(info, LIBEDID_MODES_ALL, NULL, 0);
+    n = n_dtds + n_vics;
+
+    mem = malloc(sizeof(*fz) + n * (sizeof(*fz->modes) + sizeof(*fz->masks) +
+        sizeof(*fz->vics)));
+    if (!mem)
+        return NULL;
+
+    fz = (struct libedid_feasibility *)mem;
+    fz->n_modes = n;
+    fz->modes = (struct libedid_detailed_mode *)(mem + sizeof(*fz));
+    fz->masks = (unsigned short *)(fz->modes + n);
+    fz->vics = (unsigned char *)(fz->masks + n);
+
+    /* Same layout, see libedid_get_preferred_mode() */
+    n = 0;
+    for (i = 0; i < 4; i++) {
+        if (info->base_blk.dmodes[i].pixel_clock_khz)
+            memcpy(&fz->modes[n++], &info->base_blk.dmodes[i], sizeof(*fz->modes));
+    }
+    for (i = 0; i < info->cea_blks.dtd.n_dtd_modes; i++)
+        memcpy(&fz->modes[n++], &info->cea_blks.dtd.d_modes[i], sizeof(*fz->modes));
+    memset(fz->vics, 0, n);
+    libedid_get_mode_list(info, LIBEDID_MODES_ALL, &fz->modes[n], n_vics);
+
+    /* VICs come back in VIC order, walk the bitmaps the same way */
+    for (i = 1; i < 256 && n < fz->n_modes; i++) {
+        if (libedid_vic_timing(i) &&
+                (info->cea_blks.vic_caps[i].flags & (EDID_VIC_CAP_SUPPORTED |
+                EDID_VIC_CAP_420_ONLY | EDID_VIC_CAP_420_ALSO)))
+            fz->vics[n++] = i;
+    }
+
+    hdmi = libedid_sink_is_hdmi(info);
+    for (i = 0; i < fz->n_modes; i++) {
+        u_int8_t vic_flags = fz->vics[i] ?
+            info->cea_blks.vic_caps[fz->vics[i]].flags : 0;
+        u_int32_t clock_khz = fz->modes[i].pixel_clock_khz;
+        unsigned short mask = libedid_sink_formats(info, hdmi, vic_flags);
+
+        if (hdmi)
+            mask &= libedid_hdmi_fit(info, clock_khz);
+        if (dp)
+            mask &= libedid_dp_fit(dp, clock_khz);
+        fz->masks[i] = mask;
+    }
+
+    return fz;
+}
+
+void libedid_feasibility_destroy(struct libedid_feasibility *fz)
+{
+    free(fz);
+}
+
+unsigned int libedid_feasibility_n_modes(const struct libedid_feasibility *fz)
+{
+    return fz->n_modes;
+}
+
+const struct libedid_detailed_mode *libedid_feasibility_mode(
+        const struct libedid_feasibility *fz, unsigned int mode, unsigned char *vic)
+{
+    if (mode >= fz->n_modes)
+        return NULL;
+
+    if (vic)
+        *vic = fz->vics[mode];
+    return &fz->modes[mode];
+}
+
+unsigned short libedid_feasibility_mask(const struct libedid_feasibility *fz,
+        unsigned int mode)
+{
+    return mode < fz->n_modes ? fz->masks[mode] : 0;
+}
+
+bool libedid_mode_feasible(const struct libedid_feasibility *fz, unsigned int mode,
+        enum libedid_pixel_format fmt, enum libedid_bpc bpc)
+{
+    if (mode >= fz->n_modes || fmt >= LIBEDID_N_FMTS || bpc >= LIBEDID_N_BPCS)
+        return false;
+
+    return fz->masks[mode] & LIBEDID_FEASIBLE(fmt, bpc);
+}
+
+int libedid_best_config(const struct libedid_feasibility *fz, unsigned int mode,
+        enum libedid_config_policy policy, enum libedid_pixel_format *fmt,
+        enum libedid_bpc *bpc)
+{
+    const unsigned char *order;
+    unsigned short mask;
+    int i;
+
+    if (mode >= fz->n_modes || policy >= LIBEDID_N_POLICIES)
+        return -1;
+
+    mask = fz->masks[mode];
+    order = libedid_policy_order[policy];
+    for (i = 0; i < LIBEDID_N_FMTS * LIBEDID_N_BPCS; i++) {
+        if (mask & (1 << order[i])) {
+            *fmt = order[i] / LIBEDID_N_BPCS;
+            *bpc = order[i] % LIBEDID_N_BPCS;
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+unsigned int libedid_bpc_value(enum libedid_bpc bpc)
+{
+    return bpc < LIBEDID_N_BPCS ? libedid_bpc_values[bpc] : 0;
+}
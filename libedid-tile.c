@@ -0,0 +1,261 @@
+/*
+ * Copyright (c) 2022 Shashank Sharma (contactshashanksharma@gmail.com)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sub license,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the
+ * next paragraph) shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <sys/types.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libedid-api.h"
+#include "libedid.h"
+
+/*
+ * Tiled displays: some 5K and 8K monitors are driven over two or more
+ * connectors, with one EDID each, tied together by the tiled topology
+ * block of their DisplayID extensions. The connectors are grouped in one
+ * pass over the handles, with open addressing hash tables keyed by the
+ * topology ID and the product details of the base block.
+ */
+
+struct tile_key {
+    char vendor[4];
+    u_int16_t product;
+    u_int32_t serial;
+    char bb_vendor[4];
+    u_int16_t bb_pid;
+    u_int32_t bb_sno;
+};
+
+struct tile_table {
+    /* Power of 2, at least twice the number of handles */
+    unsigned int size;
+    /* Group + 1 of each slot, 0 if empty */
+    unsigned int *groups;
+    /* (group + 1, vloc, hloc) of each slot, 0 if empty */
+    u_int64_t *locs;
+    struct tile_key *keys;
+    /* Distinct locations seen, per group */
+    unsigned int *n_locs;
+    /* Group of each handle, or -1 */
+    int *handle_group;
+};
+
+/* FNV-1a */
+static unsigned int tile_hash(const void *data, size_t len)
+{
+    const unsigned char *p = data;
+    u_int32_t h = 2166136261u;
+
+    while (len--)
+        h = (h ^ *p++) * 16777619u;
+
+    return h;
+}
+
+static void tile_table_free(struct tile_table *t)
+{
+    free(t->groups);
+    free(t->locs);
+    free(t->keys);
+    free(t->n_locs);
+    free(t->handle_group);
+}
+
+static int tile_table_init(struct tile_table *t, unsigned int n)
+{
+    t->size = 8;
+    while (t->size < 2 * n)
+        t->size <<= 1;
+
+    t->groups = calloc(t->size, sizeof(*t->groups));
+    t->locs = calloc(t->size, sizeof(*t->locs));
+    t->keys = calloc(n, sizeof(*t->keys));
+    t->n_locs = calloc(n, sizeof(*t->n_locs));
+    t->handle_group = malloc(n * sizeof(*t->handle_group));
+    if (!t->groups || !t->locs || !t->keys || !t->n_locs || !t->handle_group) {
+        tile_table_free(t);
+        return -1;
+    }
+
+    return 0;
+}
+
+/* Group of this key, a new one if it is not there yet */
+static unsigned int tile_find_group(struct tile_table *t, const struct tile_key *key,
+        unsigned int *n_groups, bool *new_group)
+{
+    unsigned int h = tile_hash(key, sizeof(*key)) & (t->size - 1);
+
+    *new_group = false;
+    while (t->groups[h]) {
+        unsigned int g = t->groups[h] - 1;
+
+        if (!memcmp(&t->keys[g], key, sizeof(*key)))
+            return g;
+
+        h = (h + 1) & (t->size - 1);
+    }
+
+    t->keys[*n_groups] = *key;
+    t->groups[h] = ++*n_groups;
+    *new_group = true;
+    return *n_groups - 1;
+}
+
+/* True the first time a location of a group is seen */
+static bool tile_new_loc(struct tile_table *t, unsigned int g, const struct edid_tile *tile)
+{
+    u_int64_t loc = (u_int64_t)(g + 1) << 16 | tile->vloc << 8 | tile->hloc;
+    unsigned int h = tile_hash(&loc, sizeof(loc)) & (t->size - 1);
+
+    while (t->locs[h]) {
+        if (t->locs[h] == loc)
+            return false;
+
+        h = (h + 1) & (t->size - 1);
+    }
+
+    t->locs[h] = loc;
+    return true;
+}
+
+/* Highest refresh rate of a display at this size, 0 if it has no such mode */
+static unsigned int tile_max_refresh(void *edid_info, unsigned int hsize, unsigned int vsize)
+{
+    unsigned int first;
+    unsigned int n = libedid_find_modes(edid_info, hsize, vsize, 0, ~0U, &first);
+
+    if (!n)
+        return 0;
+
+    return libedid_get_indexed_mode(edid_info, first + n - 1)->refresh_mhz;
+}
+
+unsigned int libedid_group_tiles(void *const *edid_infos, unsigned int n,
+        struct libedid_tile_group *groups, struct libedid_tile *tiles)
+{
+    struct tile_table t;
+    unsigned int n_groups = 0, n_tiles = 0;
+    unsigned int i, g;
+
+    if (!edid_infos || !groups || !tiles || !n)
+        return 0;
+
+    if (tile_table_init(&t, n))
+        return 0;
+
+    for (i = 0; i < n; i++) {
+        struct edid_info *info = edid_infos[i];
+        const struct edid_tile *tile;
+        struct libedid_tile_group *group;
+        struct tile_key key;
+        unsigned int refresh;
+        bool new_group;
+
+        t.handle_group[i] = -1;
+        if (!info)
+            continue;
+
+        libedid_decode_groups(info, EDID_DECODE_BASE | EDID_DECODE_MISC);
+        tile = &info->displayid.tile;
+        if (!tile->n_htiles)
+            continue;
+
+        /* Padding too, keys are compared and hashed as bytes */
+        memset(&key, 0, sizeof(key));
+        memcpy(key.vendor, tile->vendor, sizeof(key.vendor));
+        key.product = tile->product;
+        key.serial = tile->serial;
+        memcpy(key.bb_vendor, info->base_blk.vendor, sizeof(key.bb_vendor));
+        key.bb_pid = info->base_blk.pid;
+        key.bb_sno = info->base_blk.sno;
+
+        g = tile_find_group(&t, &key, &n_groups, &new_group);
+        group = &groups[g];
+        if (new_group) {
+            memset(group, 0, sizeof(*group));
+            memcpy(group->vendor, tile->vendor, sizeof(group->vendor));
+            group->product = tile->product;
+            group->serial = tile->serial;
+            group->n_htiles = tile->n_htiles;
+            group->n_vtiles = tile->n_vtiles;
+            group->single_enclosure = tile->single_enclosure;
+            group->hactive = tile->n_htiles * tile->hsize;
+            group->vactive = tile->n_vtiles * tile->vsize;
+            group->refresh_mhz = ~0U;
+        }
+
+        t.handle_group[i] = g;
+        group->n_tiles++;
+        if (tile->hloc < group->n_htiles && tile->vloc < group->n_vtiles &&
+                tile_new_loc(&t, g, tile))
+            t.n_locs[g]++;
+
+        refresh = tile_max_refresh(info, tile->hsize, tile->vsize);
+        if (refresh < group->refresh_mhz)
+            group->refresh_mhz = refresh;
+    }
+
+    /* Tiles of a group are contiguous, in handle order */
+    for (g = 0; g < n_groups; g++) {
+        struct libedid_tile_group *group = &groups[g];
+
+        group->first_tile = n_tiles;
+        n_tiles += group->n_tiles;
+        group->complete = t.n_locs[g] == group->n_tiles &&
+            group->n_tiles == (unsigned int)group->n_htiles * group->n_vtiles;
+        group->n_tiles = 0;
+    }
+
+    for (i = 0; i < n; i++) {
+        struct edid_info *info = edid_infos[i];
+        const struct edid_tile *tile;
+        struct libedid_tile_group *group;
+        struct libedid_tile *out;
+
+        if (t.handle_group[i] < 0)
+            continue;
+
+        tile = &info->displayid.tile;
+        group = &groups[t.handle_group[i]];
+        out = &tiles[group->first_tile + group->n_tiles++];
+        out->handle = i;
+        out->hloc = tile->hloc;
+        out->vloc = tile->vloc;
+        /* All the tiles of a display have the same size */
+        out->x = tile->hloc * tile->hsize;
+        out->y = tile->vloc * tile->vsize;
+        out->hsize = tile->hsize;
+        out->vsize = tile->vsize;
+        out->bezel_top = tile->bezel_top;
+        out->bezel_bottom = tile->bezel_bottom;
+        out->bezel_right = tile->bezel_right;
+        out->bezel_left = tile->bezel_left;
+        out->mode = group->refresh_mhz ?
+            libedid_find_mode(info, tile->hsize, tile->vsize, group->refresh_mhz) : -1;
+    }
+
+    tile_table_free(&t);
+    return n_groups;
+}
@@ -25,6 +25,7 @@
 #define LIB_EDID_H
 
 #include <sys/types.h>
+#include <stdbool.h>
 
 enum video_scanning {
         alwyas_underscanned = 1,
@@ -76,6 +77,8 @@ enum cea_data_block_extended_tags {
         CEA_DATA_BLOCK_EXT_SPKR_LOC_DB,
         /* InfoFrame Data Block (includes one or more Short InfoFrame Descriptors) */
         CEA_DATA_BLOCK_EXT_IFDB = 32,
+        /* HDMI Forum EDID Extension Override Data Block */
+        CEA_DATA_BLOCK_EXT_HF_EEODB = 0x78,
 };
 
 enum cea_data_block_tags {
@@ -89,12 +92,37 @@ enum cea_data_block_tags {
         CEA_DATA_BLOCK_EXTENDED,
 };
 
+/* DisplayID 1.3 and 2.0 data blocks */
+enum displayid_data_block_tags {
+        DISPLAYID_TIMING_TYPE_1 = 0x03,
+        DISPLAYID_TIMING_TYPE_3 = 0x05,
+        DISPLAYID_TIMING_TYPE_4 = 0x06,
+        DISPLAYID_VESA_TIMINGS = 0x07,
+        DISPLAYID_CEA_TIMINGS = 0x08,
+        DISPLAYID_TIMING_RANGE = 0x09,
+        DISPLAYID_TILED_TOPOLOGY = 0x12,
+        DISPLAYID_2_TIMING_TYPE_7 = 0x22,
+        DISPLAYID_2_TIMING_TYPE_8 = 0x23,
+        DISPLAYID_2_TIMING_TYPE_9 = 0x24,
+        DISPLAYID_2_DYNAMIC_RANGE = 0x25,
+        DISPLAYID_2_TILED_TOPOLOGY = 0x28,
+        /* Payload is a CTA-861 data block collection */
+        DISPLAYID_CTA_DATA = 0x81,
+};
+
+/* A payload inside the raw EDID blob, see libedid_view_data() */
+struct edid_view {
+        u_int16_t offset;
+        u_int16_t len;
+};
+
 struct cea_vsdb {
         u_int32_t oui;
         u_int8_t datalen;
 
-        /* free this */
+        /* free this, unless parsed with EDID_PARSE_BORROW_RAW/OWN_RAW */
         u_int8_t *data;
+        struct edid_view view;
 };
 
 struct cea_colorimetry {
@@ -121,10 +149,20 @@ struct cea_colorimetry {
 
 };
 
+#define EDID_MAX_HDR_DMD_VIEWS 4
+
 struct cea_dynamic_hdr_md {
-        u_int8_t size;
-        /* free this */
+        /* All the blocks together, up to the 32K of payload an EDID can have */
+        u_int16_t size;
+        /* free this, unless parsed with EDID_PARSE_BORROW_RAW/OWN_RAW.
+         * All the blocks one after the other, in every mode: in those two
+         * a single block points into raw_edid, more of them are copied.
+         */
         u_int8_t *data;
+
+        /* One view per dynamic HDR metadata block */
+        u_int8_t n_views;
+        struct edid_view views[EDID_MAX_HDR_DMD_VIEWS];
 };
 
 struct cea_static_hdr_md {
@@ -152,13 +190,27 @@ struct cea_static_hdr_md {
 
         /* Sink supports static metadata type 1 */
         u_int8_t static_md_type_1;
+
+        /* The luminance code values as in the block, max, max frame
+         * average and min, n_lum_cv of them are present
+         */
+        u_int8_t n_lum_cv;
+        u_int8_t lum_cv[3];
+
+        /* The luminances above in cd/m2, 32.32 fixed point. The floats
+         * are converted from these.
+         */
+        u_int64_t content_max_lum_fx;
+        u_int64_t content_fav_lum_fx;
+        u_int64_t content_min_lum_fx;
 };
 
 struct cea_ifdb {
         u_int8_t data_len;
         u_int8_t num_vsif;
-        /* free this */
+        /* free this, unless parsed with EDID_PARSE_BORROW_RAW/OWN_RAW */
         u_int8_t *data;
+        struct edid_view view;
 };
 
 struct cea_video_caps {
@@ -209,6 +261,11 @@ struct hf_vsdb {
         u_int8_t dv;
         u_int8_t osd_3d;
 
+        /* HDMI 2.1 FRL: 0 for TMDS only, 1: 3 lanes at 3 Gbps, 2: 3 at 6,
+         * 3: 4 lanes at 6 Gbps, 4: 4 at 8, 5: 4 at 10, 6: 4 at 12
+         */
+        u_int8_t max_frl_rate;
+
         /* Deep color support in YCBCR 4:2:0 mode */
         u_int8_t dc_48_420;
         u_int8_t dc_36_420;
@@ -251,8 +308,64 @@ struct dtd_blk {
         struct detailed_mode *d_modes;
 };
 
+/* struct edid_vic_caps flags */
+enum edid_vic_caps_flags {
+        /* Listed in a video data block */
+        EDID_VIC_CAP_SUPPORTED = (1 << 0),
+        EDID_VIC_CAP_420_ONLY = (1 << 1),
+        EDID_VIC_CAP_420_ALSO = (1 << 2),
+        EDID_VIC_CAP_NATIVE = (1 << 3),
+};
+
+/* Everything the CEA blocks say about one VIC */
+struct edid_vic_caps {
+        /* enum edid_vic_caps_flags */
+        u_int8_t flags;
+        /* Position in the video format preference block, 1 is the most
+         * preferred, 0 if not listed.
+         */
+        u_int8_t pref_rank;
+        /* Extension block, and db_index entry, of the first data block
+         * listing this VIC. ext_blk is 0 if no block lists it.
+         */
+        u_int8_t ext_blk;
+        u_int16_t db;
+};
+
+/* struct edid_ext_blk flags, from byte 3 of a CEA block */
+enum edid_ext_blk_flags {
+        EDID_EXT_BLK_UNDERSCAN = (1 << 0),
+        EDID_EXT_BLK_AUDIO = (1 << 1),
+        EDID_EXT_BLK_YCBCR444 = (1 << 2),
+        EDID_EXT_BLK_YCBCR422 = (1 << 3),
+};
+
+/* What one extension block holds, see edid_info.ext_blks */
+struct edid_ext_blk {
+        /* 0x02 for CEA, 0x70 for DisplayID, 0xF0 for a block map ... */
+        u_int8_t tag;
+        u_int8_t revision;
+        /* enum edid_ext_blk_flags (EDID_DECODE_CEA_HDR) */
+        u_int8_t flags;
+        /* Native DTD count of a CEA block */
+        u_int8_t n_native_dtds;
+        /* Its DTDs are cea_blks.dtd.d_modes[first_dtd] onwards (EDID_DECODE_DTD) */
+        u_int8_t first_dtd;
+        u_int8_t n_dtds;
+        /* Its data blocks are db_index.entries[first_db] onwards */
+        u_int16_t first_db;
+        u_int16_t n_db;
+};
+
+/*
+ * The CEA extension blocks, merged in block order: the flags below are set
+ * if any block sets them, n_dtd_blks and the DTDs add up, the first VSDB,
+ * VSVDB and IFDB are kept (the others are in the db index), and the dynamic
+ * HDR metadata of all the blocks is concatenated.
+ */
 struct edid_tags {
         u_int8_t revision;
+        /* All the extension blocks, as counted by the HF-EEODB if there is one */
         u_int8_t n_cea_ext_blks;
         u_int8_t n_dtd_blks;
         u_int8_t audio;
@@ -285,6 +398,9 @@ struct edid_tags {
          */
         u_int8_t vics_preferred[10];
 
+        /* Same information as above, per VIC, indexed by the VIC */
+        struct edid_vic_caps vic_caps[256];
+
         /* Vendor specific data dynamic ptr, free .data ptr in this */
         struct cea_vsdb vsdb;
 
@@ -324,6 +440,18 @@ struct edid_supp_clr_formats {
         u_int8_t clr_format_ycbcr420;
 };
 
+/* CIE 1931 x and y of the primaries and of the white point */
+struct edid_chromaticity {
+        u_int16_t red_x;
+        u_int16_t red_y;
+        u_int16_t green_x;
+        u_int16_t green_y;
+        u_int16_t blue_x;
+        u_int16_t blue_y;
+        u_int16_t white_x;
+        u_int16_t white_y;
+};
+
 struct edid_base_blk {
         u_int8_t srgb_default;
         u_int8_t standby;
@@ -334,17 +462,747 @@ struct edid_base_blk {
         char vendor[4];
         enum edid_clr_depth clr_depth;
         struct edid_supp_clr_formats clr_formats;
+        /* gamma * 100, 0 if not in the base block, gamma is converted from it */
+        u_int16_t gamma_x100;
         float gamma;
+        /* Chromaticity coordinates, in units of 1/1024 */
+        struct edid_chromaticity chroma;
         struct detailed_mode dmodes[4];
+
+        /* Established timings, then standard timings (the 8 of the base
+         * block, then those of 0xFA descriptors), then the modes of the
+         * CVT 3 byte codes of 0xF8 descriptors, in EDID order. Free this
+         * unless parsed into an arena.
+         */
+        u_int8_t n_std_modes;
+        struct detailed_mode *std_modes;
+};
+
+/* DisplayID tiled display topology, n_htiles is 0 without one */
+struct edid_tile {
+        /* Capabilities byte, as is */
+        u_int8_t caps;
+        /* All the tiles are in one enclosure */
+        u_int8_t single_enclosure;
+        u_int8_t n_htiles;
+        u_int8_t n_vtiles;
+        /* Location of this tile, 0, 0 is the top left one */
+        u_int8_t hloc;
+        u_int8_t vloc;
+        u_int16_t hsize;
+        u_int16_t vsize;
+        /* Bezel sizes, in pixels */
+        u_int16_t bezel_top;
+        u_int16_t bezel_bottom;
+        u_int16_t bezel_right;
+        u_int16_t bezel_left;
+        /* Topology ID, the same for all the tiles of a display */
+        char vendor[4];
+        u_int16_t product;
+        u_int32_t serial;
+};
+
+/* DisplayID video timing range limits, max_pixel_clock_khz is 0 without */
+struct edid_timing_range {
+        u_int32_t min_pixel_clock_khz;
+        u_int32_t max_pixel_clock_khz;
+        u_int16_t min_refresh_hz;
+        u_int16_t max_refresh_hz;
+        /* Refresh rate changes without a modeset */
+        u_int8_t seamless;
+};
+
+/* DisplayID extension blocks */
+struct edid_displayid {
+        /* Of the first section, 0x12/0x13 for 1.x, 0x20 for 2.0, 0 if none */
+        u_int8_t version;
+        /* 1.x product type, or 2.0 display primary use case */
+        u_int8_t product_type;
+        u_int8_t n_sections;
+
+        /* Timings of all the sections, in EDID order. Free this unless
+         * parsed into an arena.
+         */
+        u_int8_t n_modes;
+        struct detailed_mode *modes;
+        /* First one flagged as preferred, or 0xFF */
+        u_int8_t preferred;
+
+        struct edid_timing_range range;
+        struct edid_tile tile;
+};
+
+/* Parse modes, see libedid_process_edid_info_flags() */
+enum edid_parse_flags {
+        /* Keep edid_info and all of its payloads in one allocation */
+        EDID_PARSE_ARENA = (1 << 0),
+        /* Set internally when the arena is a buffer owned by the caller */
+        EDID_PARSE_CALLER_BUF = (1 << 1),
+        /* Caller keeps raw_edid alive until libedid_destroy_edid_info().
+         * Payloads are not copied, and point into raw_edid instead.
+         * Implies EDID_PARSE_ARENA.
+         */
+        EDID_PARSE_BORROW_RAW = (1 << 2),
+        /* Same as above, but libedid_destroy_edid_info() frees raw_edid.
+         * Ownership is only taken when parsing succeeds.
+         */
+        EDID_PARSE_OWN_RAW = (1 << 3),
+        /* Only validate and index the EDID, decode groups on first use,
+         * see libedid_decode_groups(). Not safe for concurrent first use.
+         */
+        EDID_PARSE_LAZY = (1 << 4),
+        /* Set internally on read-only instances owned by the parse cache */
+        EDID_PARSE_SHARED = (1 << 5),
+        /* raw_edid already passed libedid_validate_edid(), don't do it again */
+        EDID_PARSE_VALIDATED = (1 << 6),
+        /* Reject EDIDs with a bad checksum or data blocks out of bounds. By
+         * default those are reported as diagnostics, and what is in bounds
+         * is parsed.
+         */
+        EDID_PARSE_STRICT = (1 << 7),
+        /* Set by the entry points which get no length: only the extension
+         * count of the base block is trusted, not the HF-EEODB one.
+         */
+        EDID_PARSE_BASE_COUNT = (1 << 8),
+};
+
+/* Data block handler, see libedid_register_db_handler(). db is the payload
+ * after the tag byte (and after the extended tag byte for extended blocks),
+ * dblen its length. data is what the handler was registered with.
+ */
+struct edid_info;
+typedef void (*libedid_db_handler)(struct edid_info *info, u_int8_t *db,
+                u_int8_t dblen, void *data);
+
+/* libedid_validate_edid() results */
+enum edid_validate_status {
+        EDID_VALIDATE_OK = 0,
+        /* Shorter than the base block, or than its extension count says */
+        EDID_VALIDATE_TRUNCATED = -1,
+        EDID_VALIDATE_HEADER = -2,
+        /* A block doesn't add up to 0 */
+        EDID_VALIDATE_CHECKSUM = -3,
+        /* A CEA DTD offset, or a data block, is out of its bounds */
+        EDID_VALIDATE_DB_BOUNDS = -4,
+};
+
+/* struct edid_diag codes */
+enum edid_diag_code {
+        EDID_DIAG_NONE = 0,
+        /* No raw EDID, or no buffer, was passed */
+        EDID_DIAG_NO_EDID,
+        /* Validation failures, see enum edid_validate_status */
+        EDID_DIAG_TRUNCATED,
+        EDID_DIAG_HEADER,
+        EDID_DIAG_CHECKSUM,
+        EDID_DIAG_DB_BOUNDS,
+        /* Caller buffer misaligned (detail 0) or too small (detail 1) */
+        EDID_DIAG_BAD_BUFFER,
+        /* An allocation failed, detail is the enum edid_decode_groups it was for */
+        EDID_DIAG_NO_MEMORY,
+        /* CEA extension block with a DTD offset below 4, detail is the offset */
+        EDID_DIAG_BAD_EXT_BLK,
+        /* Data block too short or too long for its type, detail is its payload
+         * length (after the tag bytes)
+         */
+        EDID_DIAG_BAD_DB_LEN,
+        /* Reserved VIC in a data block, detail is the VIC */
+        EDID_DIAG_BAD_VIC,
+        /* 4:2:0 capability map without a video data block */
+        EDID_DIAG_CMDB_NO_VDB,
+        /* 4:2:0 capability map bit past the SVDs, detail is the bit */
+        EDID_DIAG_CMDB_NO_SVD,
+        /* More dynamic HDR metadata blocks than the parser keeps */
+        EDID_DIAG_DB_LIMIT,
+        /* No parser for this data block, detail is tag << 8 | extended tag */
+        EDID_DIAG_UNHANDLED_DB,
+        /* Known data block the parser skips, detail is tag << 8 | extended tag */
+        EDID_DIAG_UNSUPPORTED_DB,
+        /* DisplayID section which doesn't add up, skipped, offset is its
+         * checksum byte
+         */
+        EDID_DIAG_SECTION_CHECKSUM,
+        /* Standard timing, CVT 3 byte code or DisplayID timing which gives no
+         * mode (reserved code, or no formula for it), offset is the timing,
+         * detail the DisplayID data block tag (0 in the base block)
+         */
+        EDID_DIAG_BAD_TIMING,
+        /* More modes than the mode index keeps, detail is how many were
+         * left out
+         */
+        EDID_DIAG_MODE_LIMIT,
+};
+
+enum edid_diag_severity {
+        EDID_DIAG_INFO = 0,
+        EDID_DIAG_WARN,
+        EDID_DIAG_ERROR,
+};
+
+/* One parser diagnostic */
+struct edid_diag {
+        /* enum edid_diag_code */
+        u_int8_t code;
+        /* enum edid_diag_severity */
+        u_int8_t severity;
+        /* Block number, 0 is the base block */
+        u_int8_t blk;
+        u_int8_t reserved;
+        /* Offset in raw_edid, of the data block tag byte for data blocks */
+        u_int16_t offset;
+        /* Code specific, see enum edid_diag_code */
+        u_int16_t detail;
+};
+
+/* Diagnostics kept per edid_info, the ones past that are only counted */
+#define EDID_MAX_DIAGS 32
+
+struct edid_diags {
+        u_int8_t n_diags;
+        /* Saturates at 255 */
+        u_int8_t n_dropped;
+        struct edid_diag diag[EDID_MAX_DIAGS];
+};
+
+/* Diagnostic handler, see libedid_register_diag_handler(). Called on the
+ * parsing thread, for every diagnostic, kept or dropped.
+ */
+typedef void (*libedid_diag_handler)(const struct edid_diag *diag, void *data);
+
+/* struct edid_vic_timing flags */
+enum edid_vic_flags {
+        EDID_VIC_INTERLACED = (1 << 0),
+        /* Every pixel is sent twice, hactive and the clock count the repeats */
+        EDID_VIC_PIXEL_REPEAT = (1 << 1),
+        EDID_VIC_HSYNC_POS = (1 << 2),
+        EDID_VIC_VSYNC_POS = (1 << 3),
+        /* The VIC also covers the same timing at refresh / 1.001 */
+        EDID_VIC_FRACTIONAL = (1 << 4),
+};
+
+enum edid_vic_aspect {
+        EDID_ASPECT_NONE = 0,
+        EDID_ASPECT_4_3,
+        EDID_ASPECT_16_9,
+        EDID_ASPECT_64_27,
+        EDID_ASPECT_256_135,
+};
+
+/* CTA-861 timing of a VIC. The vertical numbers of interlaced VICs are
+ * per field, like in a DTD. All of it is computed at build time.
+ */
+struct edid_vic_timing {
+        /* At the integer refresh rate */
+        u_int32_t pixel_clock_khz;
+        u_int32_t refresh_mhz;
+        /* At refresh / 1.001, 0 without EDID_VIC_FRACTIONAL */
+        u_int32_t frac_pixel_clock_khz;
+        u_int32_t frac_refresh_mhz;
+
+        u_int16_t hactive;
+        u_int16_t hfrontp;
+        u_int16_t hsync;
+        u_int16_t hblank;
+        u_int16_t vactive;
+        u_int16_t vfrontp;
+        u_int16_t vsync;
+        u_int16_t vblank;
+
+        /* enum edid_vic_flags */
+        u_int8_t flags;
+        /* enum edid_vic_aspect */
+        u_int8_t aspect;
+};
+
+/* struct edid_dmt_timing flags */
+enum edid_dmt_flags {
+        EDID_DMT_INTERLACED = (1 << 0),
+        EDID_DMT_HSYNC_POS = (1 << 1),
+        EDID_DMT_VSYNC_POS = (1 << 2),
+        /* CVT reduced blanking timing */
+        EDID_DMT_REDUCED_BLANKING = (1 << 3),
+};
+
+/* VESA DMT timing, or one of the few established timings which are not
+ * in DMT. Like VICs, interlaced timings have per field vertical numbers.
+ */
+struct edid_dmt_timing {
+        /* DMT ID, 0 for the established timings outside of DMT */
+        u_int8_t id;
+        /* Nominal refresh rate, the one standard timings are coded with */
+        u_int8_t refresh_hz;
+        /* enum edid_dmt_flags */
+        u_int8_t flags;
+        u_int32_t pixel_clock_khz;
+        u_int32_t refresh_mhz;
+
+        u_int16_t hactive;
+        u_int16_t hfrontp;
+        u_int16_t hsync;
+        u_int16_t hblank;
+        u_int16_t vactive;
+        u_int16_t vfrontp;
+        u_int16_t vsync;
+        u_int16_t vblank;
+};
+
+/* Formulas of libedid_timing_mode() */
+enum edid_timing_formula {
+        /* CVT, standard (CRT) blanking */
+        EDID_TIMING_CVT = 0,
+        /* CVT reduced blanking v1, v2 and v3 */
+        EDID_TIMING_CVT_RB,
+        EDID_TIMING_CVT_RB2,
+        EDID_TIMING_CVT_RB3,
+        /* GTF, default curve */
+        EDID_TIMING_GTF,
+        /* GTF, with the secondary curve of struct edid_timing_req.gtf */
+        EDID_TIMING_GTF2,
+        EDID_N_TIMING_FORMULAS,
+};
+
+/* struct edid_timing_req flags */
+enum edid_timing_req_flags {
+        /* CVT and GTF only */
+        EDID_TIMING_INTERLACED = (1 << 0),
+        /* CVT-RB v2/v3: pixel clock * 1000 / 1001, for 59.94 Hz and such */
+        EDID_TIMING_VIDEO_OPTIMIZED = (1 << 1),
+        /* CVT-RB v3: vsync right after the active lines, the extra
+         * vertical blanking goes to the back porch
+         */
+        EDID_TIMING_EARLY_VSYNC = (1 << 2),
+};
+
+/* GTF secondary curve, coded like in the range limits descriptor */
+struct edid_gtf_params {
+        /* Horizontal frequency the secondary curve starts at */
+        u_int16_t start_khz;
+        u_int16_t m;
+        /* 2 * C and 2 * J */
+        u_int8_t c_x2;
+        u_int8_t k;
+        u_int8_t j_x2;
+};
+
+/* A mode to compute the timing of, see libedid_timing_mode() */
+struct edid_timing_req {
+        /* enum edid_timing_formula */
+        u_int8_t formula;
+        /* enum edid_timing_req_flags */
+        u_int8_t flags;
+        /* CVT-RB v3: extra horizontal blanking, 0-120 pixels by 8 */
+        u_int8_t rb3_hblank_extra;
+        u_int16_t hactive;
+        /* Lines and frames per second (in mHz) of the whole frame,
+         * interlaced modes too
+         */
+        u_int16_t vactive;
+        u_int32_t refresh_mhz;
+        /* EDID_TIMING_GTF2 only */
+        struct edid_gtf_params gtf;
+};
+
+/* Independently decodable parts of edid_info */
+enum edid_decode_groups {
+        /* base_blk product details, input and color formats */
+        EDID_DECODE_BASE = (1 << 0),
+        /* base_blk.dmodes, base_blk.std_modes, cea_blks.dtd and displayid.modes */
+        EDID_DECODE_DTD = (1 << 1),
+        /* CEA extension header: audio, underscan, ycbcr444/422 */
+        EDID_DECODE_CEA_HDR = (1 << 2),
+        /* VICs (DisplayID ones too), 4:2:0 VDB/CMDB, video preference and
+         * capability
+         */
+        EDID_DECODE_VIDEO = (1 << 3),
+        /* HDMI VSDB, HF-VSDB, other VSDBs and VSVDB */
+        EDID_DECODE_VSDB = (1 << 4),
+        EDID_DECODE_COLORIMETRY = (1 << 5),
+        /* HDR static and dynamic metadata */
+        EDID_DECODE_HDR = (1 << 6),
+        /* IFDB, audio, speaker and VESA blocks, DisplayID header, range
+         * limits and tiled topology
+         */
+        EDID_DECODE_MISC = (1 << 7),
+        /* mode_index, decodes EDID_DECODE_DTD and EDID_DECODE_VIDEO too */
+        EDID_DECODE_MODES = (1 << 8),
+        /* caps, decodes the groups it is built from too. Without it, the
+         * caps bits of the groups decoded so far are set already.
+         */
+        EDID_DECODE_CAPS = (1 << 9),
+        EDID_DECODE_ALL = (1 << 10) - 1,
+};
+
+/* Single allocation backing store for the parsed payloads. The size
+ * is computed by a pre-scan of the extension blocks, so parsing never
+ * has to grow it.
+ */
+struct edid_arena {
+        u_int8_t *base;
+        size_t size;
+        size_t used;
+
+        /* Dynamic HDR metadata blocks are appended into one reservation, of
+         * this size. Set without EDID_PARSE_ARENA too.
+         */
+        size_t hdr_dmd_size;
+};
+
+#define EDID_DB_NONE 0xFFFF
+
+/* One CEA data block, as found by the indexing pass */
+struct edid_db_entry {
+        /* Extension block number, 1 is the first extension */
+        u_int8_t ext_blk;
+        /* enum cea_data_block_tags */
+        u_int8_t tag;
+        /* enum cea_data_block_extended_tags, for CEA_DATA_BLOCK_EXTENDED */
+        u_int8_t ext_tag;
+        /* Data block length, without the tag byte */
+        u_int8_t len;
+        /* Offset of the tag byte in raw_edid */
+        u_int16_t offset;
+        /* Next entry with the same (extended) tag, or EDID_DB_NONE */
+        u_int16_t next;
+};
+
+struct edid_db_index {
+        u_int16_t n_entries;
+        /* In EDID order, free this unless parsed into an arena */
+        struct edid_db_entry *entries;
+        /* First entry per tag and extended tag, or EDID_DB_NONE */
+        u_int16_t first_tag[CEA_DATA_BLOCK_EXTENDED + 1];
+        u_int16_t first_ext_tag[256];
+};
+
+/* struct edid_mode_entry flags */
+enum edid_mode_entry_flags {
+        EDID_MODE_INTERLACED = (1 << 0),
+        /* The refresh / 1.001 variant of a VIC */
+        EDID_MODE_FRACTIONAL = (1 << 1),
+        /* A DTD of the base block, else of the CEA extension */
+        EDID_MODE_BASE_DTD = (1 << 2),
+        /* An established or standard timing, dtd indexes base_blk.std_modes */
+        EDID_MODE_STD = (1 << 3),
+        /* A DisplayID timing, dtd indexes displayid.modes */
+        EDID_MODE_DISPLAYID = (1 << 4),
+};
+
+/* One mode of the display, see struct edid_mode_index */
+struct edid_mode_entry {
+        u_int16_t hactive;
+        /* Lines per frame, interlaced modes too */
+        u_int16_t vactive;
+        u_int32_t refresh_mhz;
+        u_int32_t pixel_clock_khz;
+        /* 0 for DTDs */
+        u_int8_t vic;
+        /* enum edid_mode_entry_flags */
+        u_int8_t flags;
+        /* Index in base_blk.dmodes, base_blk.std_modes, cea_blks.dtd.d_modes
+         * or displayid.modes, for everything but VICs
+         */
+        u_int8_t dtd;
+};
+
+/* All the DTDs, established, standard and DisplayID timings, and VICs
+ * (with their fractional variants), once per distinct timing.
+ */
+struct edid_mode_index {
+        u_int16_t n_modes;
+        /* Sorted by hactive, vactive, refresh_mhz and pixel_clock_khz for
+         * binary searches. Free this unless parsed into an arena.
+         */
+        struct edid_mode_entry *modes;
+        /* The same modes, most preferred first: video format preference
+         * block, native VICs, first DTD, then the others. Free this unless
+         * parsed into an arena.
+         */
+        struct edid_mode_entry *ranked;
+};
+
+/* struct edid_caps bits */
+#define EDID_CAP_YCBCR444               (1ULL << 0)
+#define EDID_CAP_YCBCR422               (1ULL << 1)
+#define EDID_CAP_YCBCR420               (1ULL << 2)
+/* HDMI VSDB deep color */
+#define EDID_CAP_DC_30                  (1ULL << 3)
+#define EDID_CAP_DC_36                  (1ULL << 4)
+#define EDID_CAP_DC_48                  (1ULL << 5)
+#define EDID_CAP_DC_Y444                (1ULL << 6)
+/* HF-VSDB 4:2:0 deep color */
+#define EDID_CAP_DC420_30               (1ULL << 7)
+#define EDID_CAP_DC420_36               (1ULL << 8)
+#define EDID_CAP_DC420_48               (1ULL << 9)
+/* Colorimetry data block */
+#define EDID_CAP_BT2020_RGB             (1ULL << 10)
+#define EDID_CAP_BT2020_YCC             (1ULL << 11)
+#define EDID_CAP_BT2020_CYCC            (1ULL << 12)
+#define EDID_CAP_DCIP3                  (1ULL << 13)
+#define EDID_CAP_XVYCC_601              (1ULL << 14)
+#define EDID_CAP_XVYCC_709              (1ULL << 15)
+#define EDID_CAP_SYCC_601               (1ULL << 16)
+#define EDID_CAP_OPYCC_601              (1ULL << 17)
+#define EDID_CAP_OPRGB                  (1ULL << 18)
+/* HDR static metadata EOTFs */
+#define EDID_CAP_EOTF_SDR               (1ULL << 19)
+#define EDID_CAP_EOTF_HDR               (1ULL << 20)
+#define EDID_CAP_EOTF_ST2084            (1ULL << 21)
+#define EDID_CAP_EOTF_HLG               (1ULL << 22)
+#define EDID_CAP_HDR_STATIC_MD1         (1ULL << 23)
+#define EDID_CAP_HDR_DYNAMIC_MD         (1ULL << 24)
+/* CEA extension header */
+#define EDID_CAP_AUDIO                  (1ULL << 25)
+#define EDID_CAP_UNDERSCAN              (1ULL << 26)
+/* HDMI VSDB and HF-VSDB */
+#define EDID_CAP_HDMI_AI                (1ULL << 27)
+#define EDID_CAP_DVI_DUAL               (1ULL << 28)
+#define EDID_CAP_SCDC                   (1ULL << 29)
+#define EDID_CAP_SCDC_RR                (1ULL << 30)
+#define EDID_CAP_SCRAMBLING_340         (1ULL << 31)
+#define EDID_CAP_FRL                    (1ULL << 32)
+#define EDID_CAP_3D_OSD                 (1ULL << 33)
+/* Video capability data block */
+#define EDID_CAP_QS_RGB                 (1ULL << 34)
+#define EDID_CAP_QS_YCC                 (1ULL << 35)
+/* Base block */
+#define EDID_CAP_SRGB_DEFAULT           (1ULL << 36)
+/* DisplayID tiled topology */
+#define EDID_CAP_TILED                  (1ULL << 37)
+#define EDID_CAP_RGB444                 (1ULL << 38)
+/* HF-VSDB 3D independent view and dual view */
+#define EDID_CAP_3D_IV                  (1ULL << 39)
+#define EDID_CAP_3D_DV                  (1ULL << 40)
+
+#define EDID_CAP_YCBCR (EDID_CAP_YCBCR444 | EDID_CAP_YCBCR422 | EDID_CAP_YCBCR420)
+#define EDID_CAP_DC (EDID_CAP_DC_30 | EDID_CAP_DC_36 | EDID_CAP_DC_48)
+#define EDID_CAP_DC420 (EDID_CAP_DC420_30 | EDID_CAP_DC420_36 | EDID_CAP_DC420_48)
+#define EDID_CAP_BT2020 (EDID_CAP_BT2020_RGB | EDID_CAP_BT2020_YCC | EDID_CAP_BT2020_CYCC)
+#define EDID_CAP_HDR (EDID_CAP_EOTF_HDR | EDID_CAP_EOTF_ST2084 | EDID_CAP_EOTF_HLG)
+
+/*
+ * Flat capability profile of the display, one cache line at the start of
+ * edid_info (which libedid allocates 64 byte aligned). Hot fields first.
+ */
+struct edid_caps {
+        /* EDID_CAP_* */
+        u_int64_t bits;
+        /* HF-VSDB max TMDS rate, else the HDMI VSDB one */
+        u_int32_t max_tmds_clk_mhz;
+        /* HDR static metadata, in cd/m2 */
+        float hdr_max_lum;
+        float hdr_fav_lum;
+        float hdr_min_lum;
+        /* HF-VSDB max_frl_rate */
+        u_int8_t max_frl_rate;
+        /* Deepest bpc, 8 without deep color */
+        u_int8_t max_bpc;
+        /* Deepest 4:2:0 bpc, 0 without 4:2:0 deep color */
+        u_int8_t max_420_bpc;
+        /* Base block color depth, 0 if undefined */
+        u_int8_t base_bpc;
+
+        /* Colder */
+        u_int32_t pid;
+        u_int32_t sno;
+        char vendor[4];
+        u_int8_t n_ext_blks;
+        u_int8_t reserved[23];
+};
+
+/*
+ * Compact form of what a display supports, see libedid_compact_edid_info().
+ * Booleans are the EDID_CAP_* bits, numbers are kept as the EDID codes
+ * them, so the structs they come from can be rebuilt exactly.
+ */
+struct edid_compact {
+        /* EDID_CAP_* */
+        u_int64_t bits;
+        u_int32_t sno;
+        u_int16_t pid;
+        /* Manufacturer ID, 3 letters of 5 bits as in the base block */
+        u_int16_t vendor;
+        /* HDMI VSDB physical address a.b.c.d, a nibble each */
+        u_int16_t phy;
+        /* HDMI VSDB and HF-VSDB max TMDS clocks, in units of 5 MHz */
+        u_int8_t hdmi_max_tmds;
+        u_int8_t hf_max_tmds;
+        u_int8_t hf_version;
+        /* HDR static metadata luminance code values */
+        u_int8_t lum_cv[3];
+        /* Gamma * 100 - 100, as in the base block, when digital */
+        u_int8_t gamma;
+        /* Base block color depth */
+        u_int8_t base_bpc;
+        u_int16_t n_lum_cv : 2;
+        u_int16_t max_frl_rate : 4;
+        /* enum video_scanning */
+        u_int16_t pt : 2;
+        u_int16_t it : 2;
+        u_int16_t ce : 2;
+        /* Display power management */
+        u_int16_t standby : 1;
+        u_int16_t suspend : 1;
+        u_int16_t active_off : 1;
+        /* Digital input, the fields of its byte are set */
+        u_int16_t digital : 1;
 };
 
 struct edid_info {
+        /* Keep first, see struct edid_caps. Needs EDID_DECODE_CAPS */
+        struct edid_caps caps;
+
         u_int8_t *raw_edid;
         struct edid_tags cea_blks;
         struct edid_base_blk base_blk;
+
+        /* enum edid_parse_flags */
+        u_int32_t flags;
+        /* enum edid_decode_groups already decoded */
+        u_int32_t decoded;
+        struct edid_arena arena;
+        /* Parse cache entry of an EDID_PARSE_SHARED instance */
+        void *cache_entry;
+
+        /* All CEA data blocks, see libedid_find_db() */
+        struct edid_db_index db_index;
+        /* db_index entry being parsed */
+        u_int16_t cur_db;
+
+        /* See EDID_DECODE_MODES */
+        struct edid_mode_index mode_index;
+
+        struct edid_displayid displayid;
+
+        /* One per extension block, ext_blks[n - 1] is block n. cea_blks is
+         * the merged view of the CEA ones.
+         */
+        struct edid_ext_blk *ext_blks;
+
+        /* Everything the parser found wrong, in the order it found it */
+        struct edid_diags diags;
 };
 
 void libedid_destroy_edid_info(struct edid_info *info);
 struct edid_info *libedid_process_edid_info(u_int8_t *raw_edid);
 
+/* Same as above, with parse mode flags (enum edid_parse_flags) */
+struct edid_info *libedid_process_edid_info_flags(u_int8_t *raw_edid, u_int32_t flags);
+
+/* Same as above, for a raw_edid of len bytes. The EDID is validated first
+ * (unless EDID_PARSE_VALIDATED): a truncated EDID, or one with a bad header,
+ * is rejected before allocating anything, and so is a bad checksum or data
+ * block with EDID_PARSE_STRICT. Only this one follows the HF-EEODB count,
+ * the other entry points parse the blocks the base block counts.
+ */
+struct edid_info *libedid_process_edid_info_len(u_int8_t *raw_edid, size_t len, u_int32_t flags);
+
+/* Check the header, the checksum of every block, and the bounds of every
+ * CEA data block, in one pass. Returns enum edid_validate_status. Once
+ * this passes, parsing needs no more bounds checks on raw_edid.
+ */
+int libedid_validate_edid(const u_int8_t *raw_edid, size_t len);
+
+/* Same as above, a failure also goes to the diagnostic handler */
+int libedid_validate_edid_diag(const u_int8_t *raw_edid, size_t len);
+
+/* Same as above, with parse mode flags. Only EDID_PARSE_BASE_COUNT makes a
+ * difference: the HF-EEODB count is ignored, and len only needs to hold the
+ * blocks the base block counts.
+ */
+int libedid_validate_edid_flags(const u_int8_t *raw_edid, size_t len, u_int32_t flags);
+
+/* libedid_validate_edid() on n blobs, status[i] gets the result of
+ * raw_edids[i]. Returns the number of invalid blobs.
+ */
+size_t libedid_validate_edids(const u_int8_t *const *raw_edids, const size_t *lens,
+                int *status, size_t n);
+
+/* First data block with this tag (ext_tag only matters for extended
+ * blocks), and the next one with the same tags. Both return NULL when
+ * there is no such block. The tag byte is at raw_edid[entry->offset].
+ */
+const struct edid_db_entry *libedid_find_db(struct edid_info *info, u_int8_t tag, u_int8_t ext_tag);
+const struct edid_db_entry *libedid_next_db(struct edid_info *info, const struct edid_db_entry *entry);
+
+/* Pack a parsed EDID into *compact */
+void libedid_compact_edid_info(struct edid_info *info, struct edid_compact *compact);
+
+/* A new edid_info, with the base block, colorimetry, HDR static metadata,
+ * HDMI VSDB, HF-VSDB, video capability and caps of a compact EDID, and
+ * nothing else. Free it with libedid_destroy_edid_info().
+ */
+struct edid_info *libedid_expand_compact_info(const struct edid_compact *compact);
+
+/* Raw EDID bytes of a payload view, or NULL if the view is empty */
+const u_int8_t *libedid_view_data(struct edid_info *info, const struct edid_view *view);
+
+/* Handle data blocks with this tag (and extended tag, for extended blocks)
+ * with handler, instead of the built-in parser. A NULL handler goes back
+ * to the built-in one. Handlers are process wide, register them before
+ * parsing anything. Returns -1 for an invalid tag.
+ */
+int libedid_register_db_handler(u_int8_t tag, u_int8_t ext_tag,
+                libedid_db_handler handler, void *data);
+
+/* Same as above, for vendor specific blocks (CEA_DATA_BLOCK_VENDOR, or
+ * the extended VSVDB and VSADB) carrying this OUI. db starts after the
+ * 3 OUI bytes, and len excludes them. Up to 32 OUI handlers, NULL
+ * unregisters.
+ */
+int libedid_register_oui_handler(u_int8_t tag, u_int8_t ext_tag, u_int32_t oui,
+                libedid_db_handler handler, void *data);
+
+/* Pass every diagnostic to handler as well, NULL unregisters. The parser
+ * does no I/O of its own (logs are for VERBOSE builds only). Process wide,
+ * and not synchronized with parsing: like the data block handlers, register
+ * it before parsing anything, never while another thread parses.
+ */
+void libedid_register_diag_handler(libedid_diag_handler handler, void *data);
+
+/* Disabled blocks are still indexed, but not parsed at all */
+int libedid_enable_db_handler(u_int8_t tag, u_int8_t ext_tag, bool enable);
+
+/* Timing of a CTA-861 VIC, or NULL for a reserved VIC */
+const struct edid_vic_timing *libedid_vic_timing(u_int8_t vic);
+
+/* VESA DMT timing by DMT ID, or NULL if there is no such ID */
+const struct edid_dmt_timing *libedid_dmt_timing(u_int8_t id);
+
+/* DMT timing with this resolution and nominal refresh rate, or NULL.
+ * Standard (CRT) blanking wins over reduced blanking when DMT has both.
+ */
+const struct edid_dmt_timing *libedid_find_dmt(u_int16_t hactive, u_int16_t vactive,
+                u_int8_t refresh_hz);
+
+/* Timing of established timing bit n, 0 is bit 7 of byte 0x23 and 16 is
+ * bit 7 of byte 0x25 (the manufacturer timing), NULL past that.
+ */
+const struct edid_dmt_timing *libedid_est_timing(unsigned int n);
+
+/* Timing of a request (struct edid_timing_req), computed with the VESA
+ * CVT or GTF formula, -1 if the request makes no sense. Results are
+ * memoized per thread, no lock is taken.
+ */
+int libedid_timing_mode(const struct edid_timing_req *req, struct detailed_mode *mode);
+
+/* Decode these groups (enum edid_decode_groups) if not done already */
+int libedid_decode_groups(struct edid_info *info, u_int32_t groups);
+
+/* Size of the raw EDID blob, base block plus its extension blocks (as many
+ * as the HF-EEODB says, if the first extension block has one). raw_edid must
+ * hold the first extension block if the base block counts one.
+ */
+size_t libedid_edid_size(u_int8_t *raw_edid);
+
+/* Bytes needed to parse this EDID in a single arena, including edid_info,
+ * or 0 if it doesn't validate.
+ */
+size_t libedid_edid_info_size(u_int8_t *raw_edid);
+
+/* Parse into a caller provided, 8 byte aligned buffer of at least
+ * libedid_edid_info_size() bytes. Nothing is allocated, and the buffer
+ * stays owned by the caller (libedid_destroy_edid_info() is a no-op).
+ */
+struct edid_info *libedid_process_edid_info_buf(u_int8_t *raw_edid, void *buf, size_t size);
+
 #endif
\ No newline at end of file
@@ -22,10 +22,33 @@
  */
 
 #include <stdio.h>
+#include <string.h>
+#include <math.h>
 #include <stdbool.h>
 #include "libedid-api.h"
 #define YESNO(a) (a ? "YES" : "NO")
 
+static int n_failed;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        n_failed++; \
+    } \
+} while (0)
+
+/* What the fixtures below decode to */
+#define LG_CAPS (LIBEDID_CAP_YCBCR444 | LIBEDID_CAP_DC_30 | LIBEDID_CAP_DC_36 | \
+    LIBEDID_CAP_DC_Y444 | LIBEDID_CAP_DC420_30 | LIBEDID_CAP_DC420_36 | \
+    LIBEDID_CAP_BT2020_RGB | LIBEDID_CAP_BT2020_YCC | LIBEDID_CAP_EOTF_SDR | \
+    LIBEDID_CAP_EOTF_ST2084 | LIBEDID_CAP_HDR_STATIC_MD1 | LIBEDID_CAP_AUDIO | \
+    LIBEDID_CAP_HDMI_AI | LIBEDID_CAP_SCDC | LIBEDID_CAP_RGB444)
+#define DELL_CAPS (LIBEDID_CAP_YCBCR444 | LIBEDID_CAP_AUDIO | LIBEDID_CAP_UNDERSCAN | \
+    LIBEDID_CAP_RGB444)
+/* 50 * 2 ^ (82 / 32), and that * (93 / 255) ^ 2 / 100 */
+#define LG_HDR_MAX_LUM 295.3652291879
+#define LG_HDR_MIN_LUM 0.3928664156
+
 static u_int8_t static_edid_lg[] = {
 
         /* Base block */
@@ -104,9 +127,161 @@ static u_int8_t static_edid_dell[] = {
 	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x72
 };
 
+/* The left tile of a 2x1 tiled display, with a DisplayID 1.3 block */
+static u_int8_t static_edid_tiled[] = {
+
+        /* Base block */
+	0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
+	0x10,0xAC,0xBC,0xA0,0x55,0x52,0x31,0x32,
+	0x1C,0x1D,0x01,0x03,0x80,0x34,0x20,0x78,
+	0xEA,0x04,0x95,0xA9,0x55,0x4D,0x9D,0x26,
+	0x10,0x50,0x54,0xA5,0x4B,0x00,0x71,0x4F,
+	0x81,0x80,0xA9,0x40,0xD1,0xC0,0xD1,0x00,
+	0x01,0x01,0x01,0x01,0x01,0x01,0x28,0x3C,
+	0x80,0xA0,0x70,0xB0,0x23,0x40,0x30,0x20,
+	0x36,0x00,0x06,0x44,0x21,0x00,0x00,0x1E,
+	0x00,0x00,0x00,0xFF,0x00,0x56,0x57,0x36,
+	0x31,0x31,0x39,0x37,0x38,0x32,0x31,0x52,
+	0x55,0x0A,0x00,0x00,0x00,0xFC,0x00,0x44,
+	0x45,0x4C,0x4C,0x20,0x55,0x32,0x34,0x31,
+	0x35,0x0A,0x20,0x20,0x00,0x00,0x00,0xFD,
+	0x00,0x31,0x3D,0x1E,0x53,0x11,0x00,0x0A,
+	0x20,0x20,0x20,0x20,0x20,0x20,0x01,0x9E,
+
+        /* DisplayID extension block */
+	0x70,0x13,0x4E,0x00,0x00,0x03,0x00,0x14,
+	0x4C,0x6C,0x00,0x80,0x7F,0x07,0x9F,0x00,
+	0x2F,0x80,0x1F,0x00,0x6F,0x08,0x3D,0x00,
+	0x02,0x00,0x04,0x00,0x12,0x00,0x16,0x80,
+	0x10,0x00,0x00,0x7F,0x07,0x6F,0x08,0x0A,
+	0x00,0x00,0x08,0x00,0x44,0x45,0x4C,0xBC,
+	0xA0,0x55,0x52,0x31,0x32,0x09,0x00,0x0F,
+	0xC3,0x09,0x00,0x5F,0xEA,0x00,0x1E,0x8C,
+	0x50,0x00,0x18,0x3C,0x3E,0x00,0x10,0x07,
+	0x00,0x02,0x08,0x01,0x81,0x00,0x04,0x43,
+	0x10,0x04,0x61,0x89,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x90
+};
+
+/* And its right tile */
+static u_int8_t static_edid_tiled_right[] = {
+
+        /* Base block */
+	0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
+	0x10,0xAC,0xBC,0xA0,0x55,0x52,0x31,0x32,
+	0x1C,0x1D,0x01,0x03,0x80,0x34,0x20,0x78,
+	0xEA,0x04,0x95,0xA9,0x55,0x4D,0x9D,0x26,
+	0x10,0x50,0x54,0xA5,0x4B,0x00,0x71,0x4F,
+	0x81,0x80,0xA9,0x40,0xD1,0xC0,0xD1,0x00,
+	0x01,0x01,0x01,0x01,0x01,0x01,0x28,0x3C,
+	0x80,0xA0,0x70,0xB0,0x23,0x40,0x30,0x20,
+	0x36,0x00,0x06,0x44,0x21,0x00,0x00,0x1E,
+	0x00,0x00,0x00,0xFF,0x00,0x56,0x57,0x36,
+	0x31,0x31,0x39,0x37,0x38,0x32,0x31,0x52,
+	0x55,0x0A,0x00,0x00,0x00,0xFC,0x00,0x44,
+	0x45,0x4C,0x4C,0x20,0x55,0x32,0x34,0x31,
+	0x35,0x0A,0x20,0x20,0x00,0x00,0x00,0xFD,
+	0x00,0x31,0x3D,0x1E,0x53,0x11,0x00,0x0A,
+	0x20,0x20,0x20,0x20,0x20,0x20,0x01,0x9E,
+
+        /* DisplayID extension block */
+	0x70,0x13,0x4E,0x00,0x00,0x03,0x00,0x14,
+	0x4C,0x6C,0x00,0x80,0x7F,0x07,0x9F,0x00,
+	0x2F,0x80,0x1F,0x00,0x6F,0x08,0x3D,0x00,
+	0x02,0x00,0x04,0x00,0x12,0x00,0x16,0x80,
+	0x10,0x10,0x00,0x7F,0x07,0x6F,0x08,0x0A,
+	0x00,0x00,0x00,0x08,0x44,0x45,0x4C,0xBC,
+	0xA0,0x55,0x52,0x31,0x32,0x09,0x00,0x0F,
+	0xC3,0x09,0x00,0x5F,0xEA,0x00,0x1E,0x8C,
+	0x50,0x00,0x18,0x3C,0x3E,0x00,0x10,0x07,
+	0x00,0x02,0x08,0x01,0x81,0x00,0x04,0x43,
+	0x10,0x04,0x61,0x79,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x90
+};
+
+/* The Dell EDID, with a HF-EEODB which counts one more block than there is */
+static u_int8_t static_edid_eeodb[] = {
+
+        /* Base block */
+	0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
+	0x10,0xAC,0xBC,0xA0,0x55,0x52,0x31,0x32,
+	0x1C,0x1D,0x01,0x03,0x80,0x34,0x20,0x78,
+	0xEA,0x04,0x95,0xA9,0x55,0x4D,0x9D,0x26,
+	0x10,0x50,0x54,0xA5,0x4B,0x00,0x71,0x4F,
+	0x81,0x80,0xA9,0x40,0xD1,0xC0,0xD1,0x00,
+	0x01,0x01,0x01,0x01,0x01,0x01,0x28,0x3C,
+	0x80,0xA0,0x70,0xB0,0x23,0x40,0x30,0x20,
+	0x36,0x00,0x06,0x44,0x21,0x00,0x00,0x1E,
+	0x00,0x00,0x00,0xFF,0x00,0x56,0x57,0x36,
+	0x31,0x31,0x39,0x37,0x38,0x32,0x31,0x52,
+	0x55,0x0A,0x00,0x00,0x00,0xFC,0x00,0x44,
+	0x45,0x4C,0x4C,0x20,0x55,0x32,0x34,0x31,
+	0x35,0x0A,0x20,0x20,0x00,0x00,0x00,0xFD,
+	0x00,0x31,0x3D,0x1E,0x53,0x11,0x00,0x0A,
+	0x20,0x20,0x20,0x20,0x20,0x20,0x01,0x9E,
+
+        /* CEA Extension block, starting with a HF-EEODB of 2 blocks */
+	0x02,0x03,0x25,0xF1,0xE2,0x78,0x02,0x4F,
+	0x90,0x05,0x04,0x03,0x02,0x07,0x16,0x01,
+	0x14,0x1F,0x12,0x13,0x20,0x21,0x22,0x23,
+	0x09,0x07,0x07,0x65,0x03,0x0C,0x00,0x20,
+	0x00,0x83,0x01,0x00,0x00,0x02,0x3A,0x80,
+	0x18,0x71,0x38,0x2D,0x40,0x58,0x2C,0x45,
+	0x00,0x06,0x44,0x21,0x00,0x00,0x1E,0x01,
+	0x1D,0x80,0x18,0x71,0x1C,0x16,0x20,0x58,
+	0x2C,0x25,0x00,0x06,0x44,0x21,0x00,0x00,
+	0x9E,0x01,0x1D,0x00,0x72,0x51,0xD0,0x1E,
+	0x20,0x6E,0x28,0x55,0x00,0x06,0x44,0x21,
+	0x00,0x00,0x1E,0x8C,0x0A,0xD0,0x8A,0x20,
+	0xE0,0x2D,0x10,0x10,0x3E,0x96,0x00,0x06,
+	0x44,0x21,0x00,0x00,0x18,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x13
+};
+
 static void print_edid_info(void *edid_info)
 {
     struct libedid_detailed_mode *pm;
+    struct libedid_detailed_mode modes[64];
+    const struct libedid_detailed_mode *std_modes;
+    const struct libedid_detailed_mode *did_modes;
+    struct libedid_timing_range range;
+    struct libedid_ext_blk ext;
+    const struct libedid_diag *diags;
+    unsigned int n_diags, n_dropped;
+    int did_preferred;
+    struct libedid_data_block db;
+    const struct libedid_vic_caps *caps;
+    unsigned char vics[] = { 16, 97 };
+    struct libedid_dp_link hbr2 = { 4, 5400 };
+    struct libedid_timing_req rb2 = {
+        .formula = LIBEDID_TIMING_CVT_RB2,
+        .hactive = 3840,
+        .vactive = 2160,
+        .refresh_mhz = 120000,
+    };
+    struct libedid_feasibility *fz;
+    enum libedid_pixel_format fmt;
+    enum libedid_bpc bpc;
+    const char *fmt_names[] = { "RGB", "YCbCr444", "YCbCr422", "YCbCr420" };
+    const struct libedid_indexed_mode *im;
+    const struct libedid_caps *profile;
+    struct libedid_compact compact;
+    struct libedid_chromaticity chroma;
+    void *expanded;
+    const unsigned long long hdr10 = LIBEDID_CAP_EOTF_ST2084 | LIBEDID_CAP_BT2020_YCC |
+        LIBEDID_CAP_DC_30 | LIBEDID_CAP_SCDC;
+    unsigned int first, n;
+    unsigned int iter = 0;
+    int n_modes, i;
     printf("\n==========\n");
     printf("EDID Info:\n");
     printf("===========\n");
@@ -117,6 +292,28 @@ static void print_edid_info(void *edid_info)
     pm = libedid_get_preferred_mode(edid_info);
     printf("Preferred mode: %dx%d(%dKHz)\n", pm->hactive, pm->vactive, pm->pixel_clock_khz);
 
+    n_modes = libedid_get_std_modes(edid_info, &std_modes);
+    printf("Established and standard timings: %d\n", n_modes);
+    for (i = 0; i < n_modes; i++)
+        printf("  %dx%d%s(%dKHz)\n", std_modes[i].hactive,
+                std_modes[i].interlaced ? std_modes[i].vactive * 2 : std_modes[i].vactive,
+                std_modes[i].interlaced ? "i" : "", std_modes[i].pixel_clock_khz);
+
+    n_modes = libedid_get_mode_list(edid_info, LIBEDID_MODES_ALL, modes, 64);
+    printf("CEA modes: %d\n", n_modes);
+    for (i = 0; i < n_modes && i < 64; i++)
+        printf("  %dx%d%s(%dKHz)\n", modes[i].hactive, modes[i].vactive,
+                modes[i].interlaced ? "i" : "", modes[i].pixel_clock_khz);
+
+    for (i = 0; i < 2; i++) {
+        caps = libedid_get_vic_caps(edid_info, vics[i]);
+        printf("VIC %d: supported:%s 420 only:%s 420 also:%s native:%s preference:%d\n",
+                vics[i], YESNO(caps->flags & LIBEDID_VIC_SUPPORTED),
+                YESNO(caps->flags & LIBEDID_VIC_420_ONLY),
+                YESNO(caps->flags & LIBEDID_VIC_420_ALSO),
+                YESNO(caps->flags & LIBEDID_VIC_NATIVE), caps->pref_rank);
+    }
+
     printf("YCBCR support:%s\n", YESNO(libedid_display_supports_ycbcr(edid_info)));
     printf("YCBCR support: 444:%s 422:%s 420:%s\n",
             YESNO(libedid_display_supports_ycbcr444(edid_info)),
@@ -130,10 +327,30 @@ static void print_edid_info(void *edid_info)
             YESNO(libedid_display_supports_dc_12bpc(edid_info)),
             YESNO(libedid_display_supports_dc_16bpc(edid_info)));
 
+    libedid_get_chromaticity(edid_info, &chroma);
+    printf("Chromaticity: R %.4f,%.4f G %.4f,%.4f B %.4f,%.4f W %.4f,%.4f\n",
+            chroma.red_x / 1024.0, chroma.red_y / 1024.0, chroma.green_x / 1024.0,
+            chroma.green_y / 1024.0, chroma.blue_x / 1024.0, chroma.blue_y / 1024.0,
+            chroma.white_x / 1024.0, chroma.white_y / 1024.0);
+
     printf("Colorspaces: DCIP3: %s, BT2020: %s\n",
             YESNO(libedid_display_supports_dcip3(edid_info)),
             YESNO(libedid_display_supports_bt2020(edid_info)));
 
+    profile = libedid_get_caps(edid_info);
+    printf("Caps 0x%llx, max TMDS %dMHz, FRL rate %d, max bpc %d, HDMI 2.0 4K HDR10 sink:%s\n",
+            profile->bits, profile->max_tmds_clk_mhz, profile->max_frl_rate, profile->max_bpc,
+            YESNO((profile->bits & hdr10) == hdr10 && profile->max_tmds_clk_mhz >= 594));
+
+    libedid_compact(edid_info, &compact);
+    expanded = libedid_expand_compact(&compact);
+    if (expanded) {
+        printf("Compact form: %d bytes, expands to caps 0x%llx, HDR max %f Nits, vendor %s\n",
+                (int)sizeof(compact), libedid_get_caps(expanded)->bits,
+                libedid_display_hdr_max_lum(expanded), libedid_get_display_vendor(expanded));
+        libedid_destroy(expanded);
+    }
+
     if (libedid_display_supports_hdr_output(edid_info)) {
         printf("HDR support: Yes\n");
         printf("HDR supported curves: ST2084:%s, HLG:%s, Traditional HDR:%s\n",
@@ -146,11 +363,259 @@ static void print_edid_info(void *edid_info)
                 libedid_display_hdr_min_lum(edid_info));
     }
 
+    i = libedid_find_nearest_mode(edid_info, 3840, 2160, 60000);
+    im = libedid_get_indexed_mode(edid_info, i);
+    if (im)
+        printf("Closest to 3840x2160@60: %dx%d@%d.%03d\n", im->hactive, im->vactive,
+                im->refresh_mhz / 1000, im->refresh_mhz % 1000);
+
+    n = libedid_find_modes(edid_info, 1920, 1080, 0, ~0U, &first);
+    printf("1920x1080 refresh rates:");
+    for (i = first; i < (int)(first + n); i++) {
+        im = libedid_get_indexed_mode(edid_info, i);
+        printf(" %d.%03d%s", im->refresh_mhz / 1000, im->refresh_mhz % 1000,
+                im->flags & LIBEDID_MODE_INTERLACED ? "i" : "");
+    }
+    printf("\n");
+
+    n = libedid_get_ranked_modes(edid_info, &im);
+    printf("Most preferred modes:");
+    for (i = 0; i < (int)n && i < 5; i++)
+        printf(" %dx%d@%d.%03d%s", im[i].hactive, im[i].vactive, im[i].refresh_mhz / 1000,
+                im[i].refresh_mhz % 1000, im[i].vic ? "(VIC)" : "");
+    printf(" (%d modes)\n", n);
+
+    fz = libedid_feasibility_create(edid_info, NULL);
+    if (fz) {
+        printf("Best configurations (deepest color / over DP HBR2 x4):\n");
+        for (i = 0; i < (int)libedid_feasibility_n_modes(fz); i++) {
+            const struct libedid_detailed_mode *m = libedid_feasibility_mode(fz, i, NULL);
+
+            printf("  %dx%d(%dKHz): ", m->hactive, m->vactive, m->pixel_clock_khz);
+            if (!libedid_best_config(fz, i, LIBEDID_POLICY_MAX_BPC, &fmt, &bpc))
+                printf("%s %d bpc", fmt_names[fmt], libedid_bpc_value(bpc));
+            else
+                printf("none");
+            printf("\n");
+        }
+        libedid_feasibility_destroy(fz);
+    }
+
+    fz = libedid_feasibility_create(edid_info, &hbr2);
+    if (fz) {
+        for (i = 0; i < (int)libedid_feasibility_n_modes(fz); i++) {
+            const struct libedid_detailed_mode *m = libedid_feasibility_mode(fz, i, NULL);
+
+            if (!libedid_best_config(fz, i, LIBEDID_POLICY_MAX_BPC, &fmt, &bpc))
+                printf("  DP %dx%d(%dKHz): %s %d bpc\n", m->hactive, m->vactive,
+                        m->pixel_clock_khz, fmt_names[fmt], libedid_bpc_value(bpc));
+        }
+        libedid_feasibility_destroy(fz);
+    }
+
+    if (!libedid_generate_timing(&rb2, &modes[0]))
+        printf("CVT-RBv2 %dx%d@120: %d %d %d %d, %d %d %d %d (%dKHz)\n", modes[0].hactive,
+                modes[0].vactive, modes[0].hfrontp, modes[0].hsync, modes[0].hblank,
+                modes[0].hactive + modes[0].hblank, modes[0].vfrontp, modes[0].vsync,
+                modes[0].vblank, modes[0].vactive + modes[0].vblank, modes[0].pixel_clock_khz);
+
+    n_modes = libedid_get_displayid_modes(edid_info, &did_modes, &did_preferred);
+    printf("DisplayID timings (%d):\n", n_modes);
+    for (i = 0; i < n_modes; i++)
+        printf("  %dx%d%s(%dKHz)%s\n", did_modes[i].hactive, did_modes[i].vactive,
+                did_modes[i].interlaced ? "i" : "", did_modes[i].pixel_clock_khz,
+                i == did_preferred ? " preferred" : "");
+
+    libedid_get_timing_range(edid_info, &range);
+    if (range.max_pixel_clock_khz)
+        printf("DisplayID range: %d - %dKHz, %d - %dHz, seamless %s\n",
+                range.min_pixel_clock_khz, range.max_pixel_clock_khz,
+                range.min_refresh_hz, range.max_refresh_hz, range.seamless ? "yes" : "no");
+
+    printf("CEA data blocks:\n");
+    while (libedid_next_data_block(edid_info, &iter, &db))
+        printf("  ext %d tag %d ext_tag %d len %d\n", db.ext_blk, db.tag, db.ext_tag, db.len);
+
+    for (i = 1; libedid_get_ext_blk(edid_info, i, &ext); i++)
+        printf("Extension block %d: tag 0x%x rev %d, %d DTDs, %d data blocks%s%s\n",
+                i, ext.tag, ext.revision, ext.n_dtds, ext.n_db,
+                ext.audio ? ", audio" : "", ext.underscan ? ", underscan" : "");
+
+    n_diags = libedid_get_diags(edid_info, &diags, &n_dropped);
+    printf("Diagnostics: %d (%d dropped)\n", n_diags, n_dropped);
+    for (i = 0; i < (int)n_diags; i++)
+        printf("  code %d severity %d block %d offset %d detail 0x%x\n", diags[i].code,
+                diags[i].severity, diags[i].blk, diags[i].offset, diags[i].detail);
+
     printf("\n");
 }
 
+/* The last checksum diagnostic print_diag() got */
+static struct libedid_diag checksum_diag;
+
+static void print_diag(const struct libedid_diag *diag, void *data)
+{
+    printf("%s: code %d block %d offset %d\n", (const char *)data, diag->code,
+            diag->blk, diag->offset);
+    if (diag->code == LIBEDID_DIAG_CHECKSUM)
+        checksum_diag = *diag;
+}
+
+/* Preference class of a ranked mode, see libedid_get_ranked_modes(). None
+ * of the fixtures has a video format preference block.
+ */
+static int mode_rank_class(void *edid_info, const struct libedid_indexed_mode *m)
+{
+    if (m->flags & LIBEDID_MODE_STD)
+        return 4;
+    if (m->flags & LIBEDID_MODE_DISPLAYID)
+        return 3;
+    if (!m->vic)
+        return 1;
+    if (!(m->flags & LIBEDID_MODE_FRACTIONAL) &&
+            (libedid_get_vic_caps(edid_info, m->vic)->flags & LIBEDID_VIC_NATIVE))
+        return 0;
+    return 2;
+}
+
+static bool same_timing(const struct libedid_detailed_mode *a,
+                        const struct libedid_detailed_mode *b)
+{
+    return a->pixel_clock_khz == b->pixel_clock_khz && a->hactive == b->hactive &&
+        a->hblank == b->hblank && a->hfrontp == b->hfrontp && a->hsync == b->hsync &&
+        a->vactive == b->vactive && a->vblank == b->vblank && a->vfrontp == b->vfrontp &&
+        a->vsync == b->vsync && a->interlaced == b->interlaced;
+}
+
+/* Sorted, each timing once, and the ranked modes are the same set in order */
+static void check_mode_index(void *edid_info)
+{
+    const struct libedid_indexed_mode *ranked, *a, *b;
+    struct libedid_detailed_mode ta, tb;
+    unsigned int n, n_ranked, i, j;
+
+    n = libedid_get_n_modes(edid_info);
+    n_ranked = libedid_get_ranked_modes(edid_info, &ranked);
+    CHECK(n > 0);
+    CHECK(n_ranked == n);
+
+    for (i = 1; i < n; i++) {
+        a = libedid_get_indexed_mode(edid_info, i - 1);
+        b = libedid_get_indexed_mode(edid_info, i);
+        CHECK(a->hactive < b->hactive || (a->hactive == b->hactive &&
+                (a->vactive < b->vactive || (a->vactive == b->vactive &&
+                (a->refresh_mhz < b->refresh_mhz || (a->refresh_mhz == b->refresh_mhz &&
+                a->pixel_clock_khz <= b->pixel_clock_khz))))));
+    }
+
+    for (i = 0; i < n; i++) {
+        CHECK(!libedid_get_indexed_mode_timing(edid_info, i, &ta));
+        for (j = i + 1; j < n; j++) {
+            CHECK(!libedid_get_indexed_mode_timing(edid_info, j, &tb));
+            CHECK(!same_timing(&ta, &tb));
+        }
+    }
+
+    for (i = 0; i < n_ranked; i++) {
+        CHECK(libedid_find_mode(edid_info, ranked[i].hactive, ranked[i].vactive,
+                ranked[i].refresh_mhz) >= 0);
+        if (i)
+            CHECK(mode_rank_class(edid_info, &ranked[i - 1]) <=
+                    mode_rank_class(edid_info, &ranked[i]));
+    }
+}
+
+static void check_caps(void *edid_info, unsigned long long bits)
+{
+    const struct libedid_caps *caps = libedid_get_caps(edid_info);
+    struct libedid_compact compact;
+    void *expanded;
+
+    CHECK(caps->bits == bits);
+    CHECK(libedid_display_supports_ycbcr444(edid_info) == !!(bits & LIBEDID_CAP_YCBCR444));
+    CHECK(libedid_display_supports_hdr_st2084(edid_info) ==
+            !!(bits & LIBEDID_CAP_EOTF_ST2084));
+
+    /* The compact form keeps everything the caps have */
+    libedid_compact(edid_info, &compact);
+    expanded = libedid_expand_compact(&compact);
+    CHECK(expanded != NULL);
+    if (!expanded)
+        return;
+
+    CHECK(libedid_get_caps(expanded)->bits == caps->bits);
+    CHECK(libedid_get_caps(expanded)->max_tmds_clk_mhz == caps->max_tmds_clk_mhz);
+    CHECK(libedid_get_caps(expanded)->max_bpc == caps->max_bpc);
+    CHECK(libedid_get_display_productid(expanded) == libedid_get_display_productid(edid_info));
+    CHECK(libedid_get_display_sno(expanded) == libedid_get_display_sno(edid_info));
+    CHECK(!strcmp(libedid_get_display_vendor(expanded), libedid_get_display_vendor(edid_info)));
+    CHECK(libedid_display_hdr_max_lum(expanded) == libedid_display_hdr_max_lum(edid_info));
+    CHECK(libedid_display_hdr_min_lum(expanded) == libedid_display_hdr_min_lum(edid_info));
+    libedid_destroy(expanded);
+}
+
+static void check_hdr_lum(void *edid_info, double max, double min)
+{
+    CHECK(fabs(libedid_display_hdr_max_lum(edid_info) - max) < 1e-6);
+    CHECK(fabs(libedid_display_hdr_min_lum(edid_info) - min) < 1e-6);
+}
+
+static void print_tile_groups(void **displays, unsigned int n)
+{
+    struct libedid_tile_group groups[4];
+    struct libedid_tile tiles[4];
+    unsigned int n_groups, g, i;
+
+    n_groups = libedid_group_tiles(displays, n, groups, tiles);
+    printf("Tiled displays: %d\n", n_groups);
+    for (g = 0; g < n_groups; g++) {
+        printf("  %s/%04x/%08x: %dx%d tiles, %s, %dx%d@%d.%03d\n", groups[g].vendor,
+                groups[g].product, groups[g].serial, groups[g].n_htiles, groups[g].n_vtiles,
+                groups[g].complete ? "complete" : "incomplete", groups[g].hactive,
+                groups[g].vactive, groups[g].refresh_mhz / 1000, groups[g].refresh_mhz % 1000);
+        for (i = groups[g].first_tile; i < groups[g].first_tile + groups[g].n_tiles; i++)
+            printf("    display %d: tile %d,%d at %d,%d, %dx%d, bezels %d %d %d %d, mode %d\n",
+                    tiles[i].handle, tiles[i].hloc, tiles[i].vloc, tiles[i].x, tiles[i].y,
+                    tiles[i].hsize, tiles[i].vsize, tiles[i].bezel_top, tiles[i].bezel_bottom,
+                    tiles[i].bezel_right, tiles[i].bezel_left, tiles[i].mode);
+    }
+}
+
+/* The entry points without a length parse the blocks the base block counts,
+ * through the parse cache too
+ */
+static void check_cache_eeodb(void)
+{
+    const unsigned int flags[] = { 0, LIBEDID_INIT_VALIDATED, LIBEDID_INIT_STRICT,
+        LIBEDID_INIT_LAZY };
+    struct libedid_cache_stats stats;
+    void *handle;
+    unsigned int i;
+
+    CHECK(!libedid_cache_enable(8));
+    for (i = 0; i < sizeof(flags) / sizeof(flags[0]); i++) {
+        handle = libedid_init_flags(static_edid_eeodb, flags[i]);
+        CHECK(handle != NULL);
+        if (!handle)
+            continue;
+
+        CHECK(libedid_get_caps(handle)->n_ext_blks == 1);
+        CHECK(libedid_get_n_modes(handle) > 0);
+        libedid_destroy(handle);
+    }
+
+    /* With a length, the HF-EEODB count says it is truncated */
+    CHECK(libedid_init_len(static_edid_eeodb, sizeof(static_edid_eeodb), 0) == NULL);
+
+    libedid_cache_get_stats(&stats);
+    printf("Cache: %llu hits, %llu misses\n", stats.hits, stats.misses);
+    CHECK(stats.misses == 1 && stats.hits == 3);
+    libedid_cache_disable();
+}
+
 int main(void)
 {
+    void *displays[4];
     void *display_1, *display_2;
 
     display_1 = libedid_init(static_edid_lg);
@@ -160,6 +625,9 @@ int main(void)
     }
 
     print_edid_info(display_1);
+    check_mode_index(display_1);
+    check_caps(display_1, LG_CAPS);
+    check_hdr_lum(display_1, LG_HDR_MAX_LUM, LG_HDR_MIN_LUM);
 
     display_2 = libedid_init(static_edid_dell);
     if (!display_2) {
@@ -169,7 +637,58 @@ int main(void)
     }
 
     print_edid_info(display_2);
+    check_mode_index(display_2);
+    check_caps(display_2, DELL_CAPS);
+    check_hdr_lum(display_2, 0, 0);
 
+    /* The two connectors of a tiled display, among other displays */
+    displays[0] = display_1;
+    displays[1] = libedid_init(static_edid_tiled_right);
+    displays[2] = display_2;
+    displays[3] = libedid_init(static_edid_tiled);
+    CHECK(displays[1] && displays[3]);
+    if (displays[3]) {
+        print_edid_info(displays[3]);
+        check_mode_index(displays[3]);
+        CHECK(libedid_get_caps(displays[3])->bits & LIBEDID_CAP_TILED);
+    }
+    print_tile_groups(displays, 4);
+    check_cache_eeodb();
+
+    libedid_destroy(displays[1]);
+    libedid_destroy(displays[3]);
     libedid_destroy(display_1);
     libedid_destroy(display_2);
-}
\ No newline at end of file
+
+    /* A bad checksum in the CEA block: parsed anyway, unless strict */
+    libedid_set_diag_callback(print_diag, "Corrupt EDID");
+    static_edid_lg[255]++;
+    display_1 = libedid_init(static_edid_lg);
+    printf("Corrupt EDID parsed: %s\n", display_1 ? "yes" : "no");
+    CHECK(display_1 != NULL);
+    CHECK(checksum_diag.code == LIBEDID_DIAG_CHECKSUM &&
+            checksum_diag.severity == LIBEDID_DIAG_WARN && checksum_diag.blk == 1 &&
+            checksum_diag.offset == 128);
+    if (display_1) {
+        const struct libedid_diag *diags;
+
+        /* Validation runs first */
+        CHECK(libedid_get_diags(display_1, &diags, NULL) >= 1);
+        CHECK(diags[0].code == LIBEDID_DIAG_CHECKSUM && diags[0].blk == 1);
+        libedid_destroy(display_1);
+    }
+
+    checksum_diag.code = LIBEDID_DIAG_NONE;
+    display_1 = libedid_init_flags(static_edid_lg, LIBEDID_INIT_STRICT);
+    printf("Corrupt EDID parsed (strict): %s\n", display_1 ? "yes" : "no");
+    CHECK(display_1 == NULL);
+    CHECK(checksum_diag.code == LIBEDID_DIAG_CHECKSUM &&
+            checksum_diag.severity == LIBEDID_DIAG_ERROR && checksum_diag.blk == 1);
+    if (display_1)
+        libedid_destroy(display_1);
+    static_edid_lg[255]--;
+    libedid_set_diag_callback(NULL, NULL);
+
+    printf("%d checks failed\n", n_failed);
+    return n_failed ? 1 : 0;
+}